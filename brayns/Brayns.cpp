@@ -31,7 +31,6 @@
 #include <brayns/common/volume/VolumeHandler.h>
 #include <brayns/common/light/DirectionalLight.h>
 #include <brayns/common/simulation/CircuitSimulationHandler.h>
-#include <brayns/common/simulation/SpikeSimulationHandler.h>
 #include <brayns/common/input/KeyboardHandler.h>
 
 #include <brayns/parameters/ParametersManager.h>
@@ -52,6 +51,16 @@
 #include <boost/filesystem.hpp>
 #include <servus/uri.h>
 
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+// Time the render loop waits for when a loader holds the scene data lock
+const std::chrono::milliseconds LOADING_WAIT_TIME( 10 );
+}
+
 namespace brayns
 {
 
@@ -59,6 +68,7 @@ struct Brayns::Impl
 {
     Impl( int argc, const char **argv )
     : _engine( nullptr )
+    , _cameraInitialized( false )
     {
         BRAYNS_INFO << "Parsing command line options" << std::endl;
         _parametersManager.reset( new ParametersManager( ));
@@ -82,26 +92,22 @@ struct Brayns::Impl
         _engine->getScene().addLight( sunLight );
 
         // Load data and build geometry
-        buildScene();
+        if( _parametersManager->getGeometryParameters().getAsynchronousLoading( ))
+            _startLoading();
+        else
+            buildScene();
+    }
+
+    ~Impl()
+    {
+        if( _loadingThread.joinable( ))
+            _loadingThread.join();
     }
 
     void buildScene()
     {
         _loadData();
-        Scene& scene = _engine->getScene();
-        scene.commitVolumeData();
-        scene.commitSimulationData();
-        scene.buildEnvironment();
-        scene.buildGeometry();
-
-        if( scene.empty() && !scene.getVolumeHandler( ))
-        {
-            BRAYNS_INFO << "Building default scene" << std::endl;
-            scene.buildDefault();
-            scene.buildGeometry();
-        }
-
-        scene.commit();
+        _buildGeometry();
 
         // Set default camera according to scene bounding box
         _setupCameraManipulator( CameraMode::inspect );
@@ -123,24 +129,25 @@ struct Brayns::Impl
         _engine->reshape( renderInput.windowSize );
         _engine->preRender();
 
-#if(BRAYNS_USE_DEFLECT || BRAYNS_USE_NETWORKING)
-        if( !_extensionPluginFactory )
-            _intializeExtensionPluginFactory( );
-        _extensionPluginFactory->execute( );
-        if( _engine->isDirty( ))
+        _executeExtensions();
+        camera.commit();
+
+        // Skip the geometry and the rendering if a background loader is
+        // modifying the scene
+        std::unique_lock< std::recursive_mutex > lock(
+            _engine->getScene().getDataMutex(), std::try_to_lock );
+        if( !lock.owns_lock( ))
         {
-            _engine->getScene().reset();
-            _engine->initializeMaterials();
-            buildScene();
+            _engine->postRender();
+            std::this_thread::sleep_for( LOADING_WAIT_TIME );
+            return;
         }
-#endif
+        _processLoadedData();
 
         auto& sceneParams = _parametersManager->getSceneParameters();
         if( sceneParams.getAnimationDelta() != 0 )
             _engine->commit();
 
-        camera.commit();
-
         Scene& scene = _engine->getScene();
         FrameBuffer& frameBuffer = _engine->getFrameBuffer();
         const Vector2i& frameSize = frameBuffer.getSize();
@@ -179,23 +186,27 @@ struct Brayns::Impl
     void render()
     {
         Scene& scene = _engine->getScene();
+
         Camera& camera = _engine->getCamera();
         const Vector2ui windowSize = _parametersManager->getApplicationParameters().getWindowSize();
         _engine->reshape( windowSize );
 
         _engine->preRender();
 
-#if(BRAYNS_USE_DEFLECT || BRAYNS_USE_NETWORKING)
-        if( !_extensionPluginFactory )
-            _intializeExtensionPluginFactory( );
-        _extensionPluginFactory->execute( );
-        if( _engine->isDirty( ))
+        _executeExtensions();
+        camera.commit();
+
+        // Skip the geometry and the rendering if a background loader is
+        // modifying the scene
+        std::unique_lock< std::recursive_mutex > lock(
+            scene.getDataMutex(), std::try_to_lock );
+        if( !lock.owns_lock( ))
         {
-            _engine->getScene().reset();
-            _engine->initializeMaterials();
-            buildScene();
+            _engine->postRender();
+            std::this_thread::sleep_for( LOADING_WAIT_TIME );
+            return;
         }
-#endif
+        _processLoadedData();
 
         auto& sceneParams = _parametersManager->getSceneParameters();
         if( sceneParams.getAnimationDelta() != 0 )
@@ -213,7 +224,6 @@ struct Brayns::Impl
             }
         }
 
-        camera.commit();
         _render( );
 
         _engine->postRender();
@@ -252,6 +262,229 @@ private:
     }
 #endif
 
+    /**
+        Applies the parameter changes the engine was made dirty for. Radius and
+        color scheme changes are applied to the loaded geometry, which is then
+        rebuilt. Any other change, or a change that cannot be applied to the
+        loaded geometry, reloads the whole scene.
+    */
+    void _updateScene()
+    {
+        auto& geometryParameters = _parametersManager->getGeometryParameters();
+        auto& sceneParameters = _parametersManager->getSceneParameters();
+        Scene& scene = _engine->getScene();
+        uint32_t changes = _engine->getChanges();
+
+        const float radiusMultiplier = geometryParameters.getRadiusMultiplier();
+        const float radiusCorrection = geometryParameters.getRadiusCorrection();
+        const bool morphologies =
+            !geometryParameters.getMorphologyFolder().empty() ||
+            !geometryParameters.getCircuitConfiguration().empty();
+
+        if( changes & ( SC_RADIUS | SC_COLOR_SCHEME ))
+        {
+            // Geometry mapped from a cache file cannot be modified in place
+            if( !geometryParameters.getLoadCacheFile().empty( ))
+                changes |= SC_DATA_SOURCES;
+        }
+
+        if( changes & SC_RADIUS )
+        {
+            // Radii defined by the radius correction cannot be scaled
+            if( _radiusMultiplier == 0.f || ( morphologies &&
+                ( radiusCorrection != 0.f || _radiusCorrection != 0.f )))
+                changes |= SC_DATA_SOURCES;
+        }
+
+        if( changes & SC_COLOR_SCHEME )
+        {
+            // Only morphologies keep track of the origin of their primitives
+            if( !geometryParameters.getSplashSceneFolder().empty() ||
+                !geometryParameters.getPDBFile().empty() ||
+                !geometryParameters.getPDBFolder().empty() ||
+                !geometryParameters.getMeshFolder().empty() ||
+                !geometryParameters.getMolecularSystemConfig().empty( ))
+                changes |= SC_DATA_SOURCES;
+        }
+
+        if( changes & SC_TRANSFER_FUNCTION )
+        {
+            // The range of the NEST transfer function depends on the circuit
+            if( !geometryParameters.getNESTCircuit().empty( ))
+                changes |= SC_DATA_SOURCES;
+        }
+
+        if( changes & SC_DATA_SOURCES )
+        {
+            BRAYNS_INFO << "Reloading scene" << std::endl;
+            scene.reset();
+            _engine->initializeMaterials();
+            if( geometryParameters.getAsynchronousLoading( ))
+                _startLoading();
+            else
+                buildScene();
+            return;
+        }
+
+        if( changes & SC_TRANSFER_FUNCTION )
+        {
+            const std::string& colorMapFilename =
+                sceneParameters.getColorMapFilename();
+            if( !colorMapFilename.empty( ))
+            {
+                TransferFunctionLoader transferFunctionLoader(
+                    DEFAULT_TRANSFER_FUNCTION_RANGE );
+                transferFunctionLoader.loadFromFile( colorMapFilename, scene );
+            }
+            scene.commitTransferFunctionData();
+        }
+
+        if( changes & ( SC_RADIUS | SC_COLOR_SCHEME ))
+        {
+            if( radiusMultiplier != _radiusMultiplier )
+            {
+                const float factor = radiusMultiplier / _radiusMultiplier;
+                BRAYNS_INFO << "Scaling radii by " << factor << std::endl;
+                scene.scaleRadii( factor );
+                _radiusMultiplier = radiusMultiplier;
+            }
+            _radiusCorrection = radiusCorrection;
+
+            if( changes & SC_COLOR_SCHEME )
+            {
+                BRAYNS_INFO << "Reassigning materials" << std::endl;
+                const MorphologyLoader morphologyLoader( geometryParameters );
+                scene.reassignMaterials(
+                    [&morphologyLoader]( const PrimitivesGroup& group )
+                    {
+                        return morphologyLoader.getMaterial(
+                            group.morphologyIndex, group.sectionType );
+                    });
+            }
+
+            scene.resetGeometry();
+            scene.buildGeometry();
+            scene.commit();
+        }
+
+        _engine->commit();
+    }
+
+    /**
+        Builds the geometry of the loaded data, and commits the scene to the
+        rendering engine
+    */
+    void _buildGeometry()
+    {
+        auto& geometryParameters = _parametersManager->getGeometryParameters();
+        _radiusMultiplier = geometryParameters.getRadiusMultiplier();
+        _radiusCorrection = geometryParameters.getRadiusCorrection();
+
+        Scene& scene = _engine->getScene();
+        scene.resetModified();
+        scene.resetGeometry();
+        scene.commitVolumeData();
+        scene.commitSimulationData();
+        scene.buildEnvironment();
+        scene.buildGeometry();
+
+        if( scene.empty() && !scene.getVolumeHandler( ))
+        {
+            BRAYNS_INFO << "Building default scene" << std::endl;
+            scene.buildDefault();
+            scene.buildGeometry();
+        }
+
+        scene.commit();
+    }
+
+    /**
+        Loads the data in a background thread. Frames keep being rendered in
+        the meantime, and the geometry is rebuilt every time the loader has
+        added a batch of data to the scene (see _processLoadedData).
+    */
+    void _startLoading()
+    {
+        // The previous loader may have finished without having been joined
+        // by the render loop yet
+        if( _loadingThread.joinable( ))
+            _loadingThread.join();
+
+        BRAYNS_INFO << "Loading data in the background" << std::endl;
+        Scene& scene = _engine->getScene();
+        if( !_cameraManipulator )
+            _setupCameraManipulator( CameraMode::inspect );
+        _cameraInitialized = false;
+
+        // Empty model, rendered until the first batch of data is available.
+        // The scene is flagged as loading first, so that the cache file is
+        // only loaded once the loader is done
+        scene.setLoading( true );
+        scene.resetModified();
+        scene.buildGeometry();
+        scene.commit();
+        _engine->commit();
+
+        _loadingThread = std::thread( [this]()
+        {
+            _loadData();
+            Scene& loadedScene = _engine->getScene();
+            std::lock_guard< std::recursive_mutex > lock(
+                loadedScene.getDataMutex( ));
+            loadedScene.setLoading( false );
+        });
+    }
+
+    /**
+        Builds the geometry of the data loaded in the background since the
+        last frame. Called by the render loop while holding the scene data lock.
+    */
+    void _processLoadedData()
+    {
+        Scene& scene = _engine->getScene();
+        if( _loadingThread.joinable() && !scene.isLoading( ))
+        {
+            _loadingThread.join();
+            BRAYNS_INFO << "Background loading done" << std::endl;
+            _buildGeometry();
+            if( !_cameraInitialized )
+                _engine->setDefaultCamera();
+            _engine->setDefaultEpsilon();
+            _engine->commit();
+            return;
+        }
+
+        if( !scene.isLoading() || !scene.resetModified( ))
+            return;
+
+        scene.resetGeometry();
+        scene.buildGeometry();
+        scene.commit();
+        if( !_cameraInitialized && !scene.empty( ))
+        {
+            _engine->setDefaultCamera();
+            _engine->setDefaultEpsilon();
+            _cameraInitialized = true;
+        }
+        _engine->commit();
+    }
+
+    /**
+        Lets the extension plugins process their requests, including while a
+        background loader holds the scene data lock. Scene changes are only
+        applied once no loader is running.
+    */
+    void _executeExtensions()
+    {
+#if(BRAYNS_USE_DEFLECT || BRAYNS_USE_NETWORKING)
+        if( !_extensionPluginFactory )
+            _intializeExtensionPluginFactory( );
+        _extensionPluginFactory->execute( );
+        if( _engine->isDirty( ) && !_loadingThread.joinable( ))
+            _updateScene();
+#endif
+    }
+
     void _render( )
     {
         _engine->setActiveRenderer( _parametersManager->getRenderingParameters().getRenderer( ));
@@ -265,15 +498,20 @@ private:
         auto& sceneParameters = _parametersManager->getSceneParameters();
         auto& scene = _engine->getScene();
 
+        // Loaders hold the scene data lock while they modify the scene. Folder
+        // and circuit loaders release it between files and batches so that
+        // frames can be rendered while data is loaded in the background. The
+        // scene is marked as modified before the lock is released, since the
+        // loaded data may have been reallocated under the geometry that the
+        // renderer shares with the scene
+        std::unique_lock< std::recursive_mutex > lock( scene.getDataMutex( ));
+
         // set environment map if applicable
         const std::string& environmentMap =
             _parametersManager->getSceneParameters().getEnvironmentMap();
         if( !environmentMap.empty() )
             scene.getMaterial(MATERIAL_SKYBOX)->setTexture(TT_DIFFUSE, environmentMap);
 
-        if(!geometryParameters.getSplashSceneFolder().empty())
-            _loadMeshFolder( geometryParameters.getSplashSceneFolder( ));
-
         const std::string& colorMapFilename = sceneParameters.getColorMapFilename();
         if( !colorMapFilename.empty() )
         {
@@ -281,15 +519,29 @@ private:
             transferFunctionLoader.loadFromFile( colorMapFilename, scene );
         }
         scene.commitTransferFunctionData();
+        lock.unlock();
+
+        if(!geometryParameters.getSplashSceneFolder().empty())
+            _loadMeshFolder( geometryParameters.getSplashSceneFolder( ));
 
         if(!geometryParameters.getMorphologyFolder().empty())
             _loadMorphologyFolder();
 
+        lock.lock();
         if(!geometryParameters.getNESTCircuit().empty())
+        {
             _loadNESTCircuit();
+            scene.markModified();
+        }
+        lock.unlock();
 
         if(!geometryParameters.getPDBFile().empty())
+        {
+            lock.lock();
             _loadPDBFile( geometryParameters.getPDBFile( ));
+            scene.markModified();
+            lock.unlock();
+        }
 
         if(!geometryParameters.getPDBFolder().empty())
             _loadPDBFolder();
@@ -297,13 +549,19 @@ private:
         if(!geometryParameters.getMeshFolder().empty())
             _loadMeshFolder( geometryParameters.getMeshFolder( ));
 
+        lock.lock();
         if(!geometryParameters.getReport().empty())
+        {
             _loadCompartmentReport();
+            scene.markModified();
+        }
+        lock.unlock();
 
         if(!geometryParameters.getCircuitConfiguration().empty() &&
             geometryParameters.getLoadCacheFile().empty())
             _loadCircuitConfiguration();
 
+        lock.lock();
         if(!geometryParameters.getXYZBFile().empty())
             _loadXYZBFile();
 
@@ -320,6 +578,7 @@ private:
             worldBounds.merge( Vector3f( 0.f, 0.f, 0.f ));
             worldBounds.merge( volumeOffset + Vector3f( volumeDimensions ) * volumeElementSpacing );
         }
+        scene.markModified();
     }
 
     strings _parseFolder( const std::string& folder, const strings& filters )
@@ -364,15 +623,24 @@ private:
 
         const strings filters = { ".swc", ".h5" };
         const strings files = _parseFolder( folder, filters );
-        size_t progress = 0;
-        for( const auto& file: files )
-        {
-            BRAYNS_PROGRESS( progress, files.size( ));
-            servus::URI uri( file );
-            if( !morphologyLoader.importMorphology( uri, progress, scene ))
-                BRAYNS_ERROR << "Failed to import " << file << std::endl;
-            ++progress;
-        }
+
+        // Batches are loaded without holding the scene data lock, and merged
+        // into the scene while holding it
+        morphologyLoader.importMorphologies( files, scene );
+    }
+
+    /**
+        Reports the progress of a folder loader, and notifies the render loop
+        that the geometry must be rebuilt. Called while holding the scene data
+        lock, after every file: the loaded file may have reallocated the
+        primitive arrays that the renderer shares with the scene.
+    */
+    void _loadingProgress( const std::string& operation, const size_t progress,
+                           const size_t total )
+    {
+        Scene& scene = _engine->getScene();
+        scene.setProgress( operation, float( progress ) / float( total ));
+        scene.markModified();
     }
 
     /**
@@ -391,15 +659,6 @@ private:
             loader.importCircuit( circuit, scene, nbMaterials );
             loader.importSpikeReport( geometryParameters.getNESTReport(), scene );
 
-            const std::string& cacheFile( geometryParameters.getNESTCacheFile( ));
-            if( !cacheFile.empty( ))
-            {
-                SpikeSimulationHandlerPtr simulationHandler(
-                    new SpikeSimulationHandler( _parametersManager->getGeometryParameters( )));
-                simulationHandler->attachSimulationToCacheFile( cacheFile );
-                scene.setSimulationHandler( simulationHandler );
-            }
-
             auto& sceneParameters = _parametersManager->getSceneParameters();
             const std::string& colorMapFilename =
                 sceneParameters.getColorMapFilename();
@@ -425,11 +684,14 @@ private:
         const strings filters = { ".pdb", ".pdb1" };
         const strings files = _parseFolder( folder, filters );
         size_t progress = 0;
+        auto& scene = _engine->getScene();
         for( const auto& file: files )
         {
             BRAYNS_PROGRESS( progress, files.size( ));
+            std::lock_guard< std::recursive_mutex > lock( scene.getDataMutex( ));
             _loadPDBFile( file );
             ++progress;
+            _loadingProgress( "Loading PDB files", progress, files.size( ));
         }
     }
 
@@ -491,6 +753,7 @@ private:
         for( const auto& file: files )
         {
             BRAYNS_PROGRESS( progress, files.size( ));
+            std::lock_guard< std::recursive_mutex > lock( scene.getDataMutex( ));
             MeshContainer MeshContainer =
             {
                 scene.getTriangleMeshes(),
@@ -521,6 +784,7 @@ private:
                 file, MeshContainer, quality, Vector3f(), Vector3f(1,1,1), material ))
                 BRAYNS_ERROR << "Failed to import " << file << std::endl;
             ++progress;
+            _loadingProgress( "Loading meshes", progress, files.size( ));
         }
     #else
         BRAYNS_ERROR << "Assimp library is required to load meshes from " << folder << std::endl;
@@ -835,6 +1099,14 @@ private:
     KeyboardHandlerPtr _keyboardHandler;
     AbstractManipulatorPtr _cameraManipulator;
 
+    // Radius parameters the loaded geometry was built with
+    float _radiusMultiplier;
+    float _radiusCorrection;
+
+    // Background loading
+    std::thread _loadingThread;
+    bool _cameraInitialized;
+
 #if(BRAYNS_USE_DEFLECT || BRAYNS_USE_NETWORKING)
     ExtensionPluginFactoryPtr _extensionPluginFactory;
     ExtensionParameters _extensionParameters;
@@ -33,7 +33,7 @@ namespace brayns
 
 Engine::Engine( ParametersManager& parametersManager )
     : _parametersManager( parametersManager )
-    , _dirty( true )
+    , _changes( SC_ALL )
 {
 }
 
@@ -57,10 +57,11 @@ void Engine::reshape( const Vector2ui& frameSize )
 void Engine::commit()
 {
     auto& sceneParams = _parametersManager.getSceneParameters();
-    sceneParams.setTimestamp( sceneParams.getTimestamp() + sceneParams.getAnimationDelta( ));
+    sceneParams.setTimestamp( sceneParams.getTimestamp() +
+        float( sceneParams.getAnimationDelta( )) / sceneParams.getAnimationSubframes( ));
 
     _frameBuffer->clear();
-    _dirty = false;
+    _changes = SC_NONE;
 }
 
 void Engine::_render(
@@ -112,17 +112,26 @@ public:
     void setDefaultEpsilon();
 
     /**
-       @brief Makes the engine. This means that all attributes, including geometry, material,
-       camera, framebuffer, etc, have to be reset according to the engine parameters stored in the
-       _parametersManager class member.
+       @brief Makes the engine dirty. The parts of the scene identified by
+       changes have to be updated according to the engine parameters stored in
+       the _parametersManager class member. SC_DATA_SOURCES means that all
+       attributes, including geometry, material, camera, framebuffer, etc, have
+       to be reset.
+       @param changes Bitwise combination of SceneChange values
     */
-    void makeDirty() { _dirty = true; }
+    void makeDirty( const uint32_t changes = SC_ALL ) { _changes |= changes; }
 
     /**
      * @brief isDirty returns the engine state
      * @return True if the engine is dirty and needs to be updated. False otherwise.
      */
-    bool isDirty() { return _dirty; }
+    bool isDirty() { return _changes != SC_NONE; }
+
+    /**
+     * @return the parts of the scene that need to be updated, as a bitwise
+     *         combination of SceneChange values
+     */
+    uint32_t getChanges() const { return _changes; }
 
     /**
        Initializes materials for the current scene
@@ -151,7 +160,7 @@ protected:
     RendererMap _renderers;
     Vector2i _frameSize;
     FrameBufferPtr _frameBuffer;
-    bool _dirty;
+    uint32_t _changes;
 
 };
 
@@ -0,0 +1,133 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "InstancedGeometry.h"
+
+namespace
+{
+brayns::Vector3f transformPoint(
+    const brayns::Matrix4f& transform,
+    const brayns::Vector3f& point )
+{
+    const brayns::Vector4f result =
+        transform * brayns::Vector4f( point.x(), point.y(), point.z(), 1.f );
+    return brayns::Vector3f( result.x(), result.y(), result.z( ));
+}
+
+brayns::Vector3f transformVector(
+    const brayns::Matrix4f& transform,
+    const brayns::Vector3f& vector )
+{
+    const brayns::Vector4f result =
+        transform * brayns::Vector4f( vector.x(), vector.y(), vector.z(), 0.f );
+    return brayns::Vector3f( result.x(), result.y(), result.z( ));
+}
+}
+
+namespace brayns
+{
+
+void InstancedGeometry::addInstance( const Matrix4f& transform )
+{
+    _transforms.push_back( transform );
+}
+
+Boxf InstancedGeometry::getInstancesBounds() const
+{
+    Boxf bounds;
+    if( _bounds.isEmpty( ))
+        return bounds;
+
+    const Vector3f& min = _bounds.getMin();
+    const Vector3f& max = _bounds.getMax();
+    for( const auto& transform: _transforms )
+        for( size_t corner = 0; corner < 8; ++corner )
+            bounds.merge( transformPoint( transform, Vector3f(
+                corner & 1 ? max.x() : min.x(),
+                corner & 2 ? max.y() : min.y(),
+                corner & 4 ? max.z() : min.z( ))));
+    return bounds;
+}
+
+void InstancedGeometry::flatten(
+    PrimitivesMap& primitives,
+    TrianglesMeshMap& trianglesMeshes )
+{
+    for( const auto& transform: _transforms )
+    {
+        // Radii are scaled by the scaling of the first axis
+        const float scale =
+            transformVector( transform, Vector3f( 1.f, 0.f, 0.f )).length();
+
+        for( const auto& source: _primitives )
+        {
+            Primitives& destination = primitives[source.first];
+            for( const Sphere& sphere: source.second.getSpheres( ))
+                destination.addSphere(
+                    transformPoint( transform, sphere.center ),
+                    sphere.radius * scale, sphere.timestamp, sphere.value );
+            for( const Cylinder& cylinder: source.second.getCylinders( ))
+                destination.addCylinder(
+                    transformPoint( transform, cylinder.center ),
+                    transformPoint( transform, cylinder.up ),
+                    cylinder.radius * scale, cylinder.timestamp,
+                    cylinder.value );
+            for( const Cone& cone: source.second.getCones( ))
+                destination.addCone(
+                    transformPoint( transform, cone.center ),
+                    transformPoint( transform, cone.up ),
+                    cone.centerRadius * scale, cone.upRadius * scale,
+                    cone.timestamp, cone.value );
+            for( const RoundedCone& cone: source.second.getRoundedCones( ))
+                destination.addRoundedCone(
+                    transformPoint( transform, cone.center ),
+                    transformPoint( transform, cone.up ),
+                    cone.centerRadius * scale, cone.upRadius * scale,
+                    cone.timestamp, cone.value );
+        }
+
+        for( auto& source: _trianglesMeshes )
+        {
+            TrianglesMesh& destination = trianglesMeshes[source.first];
+            const uint32_t firstVertex = destination.getVertices().size();
+            for( const auto& vertex: source.second.getVertices( ))
+                destination.getVertices().push_back(
+                    transformPoint( transform, vertex ));
+            for( const auto& normal: source.second.getNormals( ))
+            {
+                Vector3f transformedNormal = transformVector( transform, normal );
+                transformedNormal.normalize();
+                destination.getNormals().push_back( transformedNormal );
+            }
+            for( const auto& index: source.second.getIndices( ))
+                destination.getIndices().push_back(
+                    index + Vector3ui( firstVertex, firstVertex, firstVertex ));
+            destination.getColors().insert( destination.getColors().end(),
+                source.second.getColors().begin(),
+                source.second.getColors().end( ));
+            destination.getTextureCoordinates().insert(
+                destination.getTextureCoordinates().end(),
+                source.second.getTextureCoordinates().begin(),
+                source.second.getTextureCoordinates().end( ));
+        }
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INSTANCEDGEOMETRY_H
+#define INSTANCEDGEOMETRY_H
+
+#include <brayns/api.h>
+#include <brayns/common/types.h>
+#include <brayns/common/geometry/Primitives.h>
+#include <brayns/common/geometry/TrianglesMesh.h>
+
+namespace brayns
+{
+
+/**
+ * Geometry defined once, in its own space, and placed several times in the
+ * scene. Engines supporting instancing share the geometry between all its
+ * instances, others can expand it with flatten().
+ */
+class InstancedGeometry
+{
+public:
+    /** Primitives of the geometry, per material, in the geometry space */
+    BRAYNS_API PrimitivesMap& getPrimitives() { return _primitives; }
+    BRAYNS_API const PrimitivesMap& getPrimitives() const { return _primitives; }
+
+    /** Triangle meshes of the geometry, per material, in the geometry space */
+    BRAYNS_API TrianglesMeshMap& getTrianglesMeshes() { return _trianglesMeshes; }
+
+    /** Bounds of the geometry, in the geometry space */
+    BRAYNS_API Boxf& getBounds() { return _bounds; }
+    BRAYNS_API const Boxf& getBounds() const { return _bounds; }
+
+    /** Transformations from the geometry space to the scene, per instance */
+    BRAYNS_API const Matrix4fs& getTransforms() const { return _transforms; }
+
+    /**
+     * Places a new instance of the geometry in the scene
+     * @param transform Transformation from the geometry space to the scene
+     */
+    BRAYNS_API void addInstance( const Matrix4f& transform );
+
+    /** @return the bounds of all instances, in the scene space */
+    BRAYNS_API Boxf getInstancesBounds() const;
+
+    /**
+     * Appends a transformed copy of the geometry for every instance
+     * @param primitives Primitives of the scene
+     * @param trianglesMeshes Triangle meshes of the scene
+     */
+    BRAYNS_API void flatten( PrimitivesMap& primitives,
+                             TrianglesMeshMap& trianglesMeshes );
+
+private:
+    PrimitivesMap _primitives;
+    TrianglesMeshMap _trianglesMeshes;
+    Boxf _bounds;
+    Matrix4fs _transforms;
+};
+
+}
+#endif // INSTANCEDGEOMETRY_H
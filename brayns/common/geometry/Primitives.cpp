@@ -0,0 +1,100 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Primitives.h"
+
+namespace
+{
+template< typename T >
+void appendVector( std::vector< T >& dst, const std::vector< T >& src )
+{
+    dst.insert( dst.end(), src.begin(), src.end( ));
+}
+}
+
+namespace brayns
+{
+
+void Primitives::addSphere(
+    const Vector3f& center,
+    const float radius,
+    const float timestamp,
+    const float value )
+{
+    _spheres.push_back( { center, radius, timestamp, value } );
+}
+
+void Primitives::addCylinder(
+    const Vector3f& center,
+    const Vector3f& up,
+    const float radius,
+    const float timestamp,
+    const float value )
+{
+    _cylinders.push_back( { center, up, radius, timestamp, value } );
+}
+
+void Primitives::addCone(
+    const Vector3f& center,
+    const Vector3f& up,
+    const float centerRadius,
+    const float upRadius,
+    const float timestamp,
+    const float value )
+{
+    _cones.push_back(
+        { center, up, centerRadius, upRadius, timestamp, value } );
+}
+
+void Primitives::addRoundedCone(
+    const Vector3f& center,
+    const Vector3f& up,
+    const float centerRadius,
+    const float upRadius,
+    const float timestamp,
+    const float value )
+{
+    _roundedCones.push_back(
+        { center, up, centerRadius, upRadius, timestamp, value } );
+}
+
+void Primitives::append( const Primitives& other )
+{
+    appendVector( _spheres, other._spheres );
+    appendVector( _cylinders, other._cylinders );
+    appendVector( _cones, other._cones );
+    appendVector( _roundedCones, other._roundedCones );
+}
+
+void Primitives::clear()
+{
+    Spheres().swap( _spheres );
+    Cylinders().swap( _cylinders );
+    Cones().swap( _cones );
+    RoundedCones().swap( _roundedCones );
+}
+
+bool Primitives::empty() const
+{
+    return _spheres.empty() && _cylinders.empty() && _cones.empty() &&
+           _roundedCones.empty();
+}
+
+}
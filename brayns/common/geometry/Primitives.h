@@ -0,0 +1,179 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include <brayns/api.h>
+#include <brayns/common/types.h>
+
+namespace brayns
+{
+
+/**
+ * The primitive records below have the exact memory layout expected by the
+ * engine geometries (e.g. the OSPRay extended spheres, cylinders and cones),
+ * so that the arrays holding them can be shared with the engines without any
+ * further serialization.
+ */
+
+/** Sphere: center, radius, timestamp, value */
+struct Sphere
+{
+    Vector3f center;
+    float radius;
+    float timestamp;
+    float value;
+};
+typedef std::vector< Sphere > Spheres;
+
+/** Cylinder: center, up, radius, timestamp, value */
+struct Cylinder
+{
+    Vector3f center;
+    Vector3f up;
+    float radius;
+    float timestamp;
+    float value;
+};
+typedef std::vector< Cylinder > Cylinders;
+
+/** Cone: center, up, center radius, up radius, timestamp, value */
+struct Cone
+{
+    Vector3f center;
+    Vector3f up;
+    float centerRadius;
+    float upRadius;
+    float timestamp;
+    float value;
+};
+typedef std::vector< Cone > Cones;
+
+/**
+ * Rounded cone: center, up, center radius, up radius, timestamp, value. Convex
+ * hull of the spheres of the given radii located at both ends, used for the
+ * segments of the morphologies, which do not need extra spheres at the joints.
+ */
+struct RoundedCone
+{
+    Vector3f center;
+    Vector3f up;
+    float centerRadius;
+    float upRadius;
+    float timestamp;
+    float value;
+};
+typedef std::vector< RoundedCone > RoundedCones;
+
+static_assert( sizeof( Sphere ) == 6 * sizeof( float ),
+               "Unexpected sphere memory layout" );
+static_assert( sizeof( Cylinder ) == 9 * sizeof( float ),
+               "Unexpected cylinder memory layout" );
+static_assert( sizeof( Cone ) == 10 * sizeof( float ),
+               "Unexpected cone memory layout" );
+static_assert( sizeof( RoundedCone ) == 10 * sizeof( float ),
+               "Unexpected rounded cone memory layout" );
+
+/**
+ * Contiguous storage for the parametric primitives (spheres, cylinders, cones
+ * and rounded cones) of a given material. Loaders append primitives directly
+ * to the arrays, and engines use them in place when building their own
+ * geometry.
+ */
+class Primitives
+{
+public:
+    BRAYNS_API void addSphere(
+        const Vector3f& center,
+        float radius,
+        float timestamp,
+        float value );
+
+    BRAYNS_API void addCylinder(
+        const Vector3f& center,
+        const Vector3f& up,
+        float radius,
+        float timestamp,
+        float value );
+
+    BRAYNS_API void addCone(
+        const Vector3f& center,
+        const Vector3f& up,
+        float centerRadius,
+        float upRadius,
+        float timestamp,
+        float value );
+
+    BRAYNS_API void addRoundedCone(
+        const Vector3f& center,
+        const Vector3f& up,
+        float centerRadius,
+        float upRadius,
+        float timestamp,
+        float value );
+
+    /** Appends all primitives from another store */
+    BRAYNS_API void append( const Primitives& other );
+
+    BRAYNS_API void clear();
+    BRAYNS_API bool empty() const;
+
+    BRAYNS_API Spheres& getSpheres() { return _spheres; }
+    BRAYNS_API const Spheres& getSpheres() const { return _spheres; }
+    BRAYNS_API Cylinders& getCylinders() { return _cylinders; }
+    BRAYNS_API const Cylinders& getCylinders() const { return _cylinders; }
+    BRAYNS_API Cones& getCones() { return _cones; }
+    BRAYNS_API const Cones& getCones() const { return _cones; }
+    BRAYNS_API RoundedCones& getRoundedCones() { return _roundedCones; }
+    BRAYNS_API const RoundedCones& getRoundedCones() const
+        { return _roundedCones; }
+
+private:
+    Spheres _spheres;
+    Cylinders _cylinders;
+    Cones _cones;
+    RoundedCones _roundedCones;
+};
+
+/**
+ * Range of primitives created for a given section type of a given morphology.
+ * Offsets are indices in the arrays of primitives of the
+ * material the primitives are currently assigned to. Groups are tracked by the
+ * scene so that the color scheme can be changed without reloading the
+ * morphologies.
+ */
+struct PrimitivesGroup
+{
+    size_t morphologyIndex;
+    size_t sectionType;
+    size_t material;
+    size_t firstSphere;
+    size_t nbSpheres;
+    size_t firstCylinder;
+    size_t nbCylinders;
+    size_t firstCone;
+    size_t nbCones;
+    size_t firstRoundedCone;
+    size_t nbRoundedCones;
+};
+
+}
+#endif // PRIMITIVES_H
@@ -62,6 +62,7 @@ public:
     BRAYNS_API void setHeight( size_t value ) { _height = value; }
 
     BRAYNS_API unsigned char* getRawData() { return _rawData.data(); }
+    BRAYNS_API size_t getRawDataSize() const { return _rawData.size(); }
     BRAYNS_API void setRawData(unsigned char* data, size_t size);
 
 private:
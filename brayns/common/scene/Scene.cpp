@@ -31,6 +31,58 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+
+namespace
+{
+template< typename T >
+void appendRange( std::vector< T >& dst, const std::vector< T >& src,
+                  const size_t first, const size_t count )
+{
+    dst.insert( dst.end(), src.begin() + first, src.begin() + first + count );
+}
+
+/**
+ * Moves the primitives of an array to the material of the group they belong
+ * to, primitives of no group stay in the given material. Every type of
+ * primitive may be sorted differently, groups are visited in the order of
+ * their primitives in this array, and groups without primitives of this type
+ * are skipped.
+ */
+template< typename T, typename GetArray >
+void reassignPrimitives(
+    const std::vector< T >& src,
+    const size_t material,
+    std::vector< brayns::PrimitivesGroup* > groups,
+    size_t brayns::PrimitivesGroup::* first,
+    size_t brayns::PrimitivesGroup::* count,
+    brayns::PrimitivesMap& primitives,
+    GetArray getArray )
+{
+    groups.erase( std::remove_if( groups.begin(), groups.end(),
+        [count]( const brayns::PrimitivesGroup* group )
+            { return group->*count == 0; }), groups.end( ));
+    std::sort( groups.begin(), groups.end(),
+        [first]( const brayns::PrimitivesGroup* a,
+                 const brayns::PrimitivesGroup* b )
+            { return a->*first < b->*first; });
+
+    std::vector< T >& untracked = getArray( primitives[material] );
+    size_t next = 0;
+    for( brayns::PrimitivesGroup* group: groups )
+    {
+        appendRange( untracked, src, next, group->*first - next );
+        next = group->*first + group->*count;
+
+        std::vector< T >& dst = getArray( primitives[group->material] );
+        const size_t newFirst = dst.size();
+        appendRange( dst, src, group->*first, group->*count );
+        group->*first = newFirst;
+    }
+    appendRange( untracked, src, next, src.size() - next );
+}
+}
+
 namespace brayns
 {
 
@@ -41,6 +93,9 @@ Scene::Scene(
     , _renderers( renderers )
     , _volumeHandler( 0 )
     , _simulationHandler( 0 )
+    , _modified( false )
+    , _loading( false )
+    , _progressAmount( 0.f )
 {
 }
 
@@ -52,6 +107,8 @@ void Scene::reset( )
 {
     _primitives.clear( );
     _trianglesMeshes.clear( );
+    _instancedGeometries.clear( );
+    _primitivesGroups.clear( );
     _bounds.reset();
 }
 
@@ -220,8 +277,8 @@ void Scene::buildDefault( )
     size_t material = 7;
 
     // Sphere
-    _primitives[material].push_back( SpherePtr(
-        new Sphere( material, Vector3f( 0.25f, 0.26f, 0.30f ), 0.25f, 0, 0 )));
+    _primitives[material].addSphere(
+        Vector3f( 0.25f, 0.26f, 0.30f ), 0.25f, 0, 0 );
     _materials[material]->setOpacity( 0.3f );
     _materials[material]->setRefractionIndex( 1.1f );
     _materials[material]->setSpecularColor( WHITE );
@@ -229,20 +286,18 @@ void Scene::buildDefault( )
 
     // Cylinder
     ++material;
-    _primitives[material].push_back( CylinderPtr(
-        new Cylinder( material,
-            Vector3f( 0.25f, 0.126f, 0.75f ), Vector3f( 0.75f, 0.126f, 0.75f ),
-            0.125f, 0, 0 )));
+    _primitives[material].addCylinder(
+        Vector3f( 0.25f, 0.126f, 0.75f ), Vector3f( 0.75f, 0.126f, 0.75f ),
+        0.125f, 0, 0 );
     _materials[material]->setColor( Vector3f( 0.1f, 0.1f, 0.8f ));
     _materials[material]->setSpecularColor( WHITE );
     _materials[material]->setSpecularExponent( 10.f );
 
     // Cone
     ++material;
-    _primitives[material].push_back( ConePtr(
-        new Cone( material,
-            Vector3f( 0.75f, 0.01f, 0.25f ), Vector3f( 0.75f, 0.5f, 0.25f ),
-            0.15f, 0.f, 0, 0 )));
+    _primitives[material].addCone(
+        Vector3f( 0.75f, 0.01f, 0.25f ), Vector3f( 0.75f, 0.5f, 0.25f ),
+        0.15f, 0.f, 0, 0 );
     _materials[material]->setReflectionIndex(0.8f);
     _materials[material]->setSpecularColor( WHITE );
     _materials[material]->setSpecularExponent( 10.f );
@@ -445,35 +500,22 @@ void Scene::buildEnvironment( )
         };
 
         for( size_t i = 0; i < 8; ++i)
-            _primitives[material].push_back( SpherePtr(
-                new Sphere( material, positions[i], radius, 0, 0)));
-
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[0], positions[1], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[2], positions[3], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[4], positions[5], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[6], positions[7], radius, 0, 0)));
-
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[0], positions[2], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[1], positions[3], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[4], positions[6], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[5], positions[7], radius, 0, 0)));
-
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[0], positions[4], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[1], positions[5], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[2], positions[6], radius, 0, 0)));
-        _primitives[material].push_back( CylinderPtr(
-            new Cylinder( material, positions[3], positions[7], radius, 0, 0)));
+            _primitives[material].addSphere( positions[i], radius, 0, 0 );
+
+        _primitives[material].addCylinder( positions[0], positions[1], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[2], positions[3], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[4], positions[5], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[6], positions[7], radius, 0, 0 );
+
+        _primitives[material].addCylinder( positions[0], positions[2], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[1], positions[3], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[4], positions[6], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[5], positions[7], radius, 0, 0 );
+
+        _primitives[material].addCylinder( positions[0], positions[4], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[1], positions[5], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[2], positions[6], radius, 0, 0 );
+        _primitives[material].addCylinder( positions[3], positions[7], radius, 0, 0 );
 
         break;
     }
@@ -567,7 +609,111 @@ VolumeHandlerPtr Scene::getVolumeHandler()
 
 bool Scene::empty() const
 {
-    return _primitives.empty() && _trianglesMeshes.empty();
+    for( const auto& primitives: _primitives )
+        if( !primitives.second.empty( ))
+            return false;
+    return _trianglesMeshes.empty() && _instancedGeometries.empty();
+}
+
+void Scene::scaleRadii( const float factor )
+{
+    // System materials hold environment geometry, which does not depend on
+    // the radius parameters
+    std::vector< Primitives* > stores;
+    for( auto& primitives: _primitives )
+        if( primitives.first < MATERIAL_SYSTEM )
+            stores.push_back( &primitives.second );
+    for( auto& instancedGeometry: _instancedGeometries )
+        for( auto& primitives: instancedGeometry.getPrimitives( ))
+            stores.push_back( &primitives.second );
+
+    for( Primitives* primitives: stores )
+    {
+        Spheres& spheres = primitives->getSpheres();
+        #pragma omp parallel for
+        for( size_t i = 0; i < spheres.size(); ++i )
+            spheres[i].radius *= factor;
+
+        Cylinders& cylinders = primitives->getCylinders();
+        #pragma omp parallel for
+        for( size_t i = 0; i < cylinders.size(); ++i )
+            cylinders[i].radius *= factor;
+
+        Cones& cones = primitives->getCones();
+        #pragma omp parallel for
+        for( size_t i = 0; i < cones.size(); ++i )
+        {
+            cones[i].centerRadius *= factor;
+            cones[i].upRadius *= factor;
+        }
+
+        RoundedCones& roundedCones = primitives->getRoundedCones();
+        #pragma omp parallel for
+        for( size_t i = 0; i < roundedCones.size(); ++i )
+        {
+            roundedCones[i].centerRadius *= factor;
+            roundedCones[i].upRadius *= factor;
+        }
+    }
+}
+
+void Scene::reassignMaterials(
+    const std::function< size_t( const PrimitivesGroup& )>& getMaterial )
+{
+    if( _primitivesGroups.empty( ))
+        return;
+
+    // Groups are moved from the material they currently belong to
+    std::map< size_t, std::vector< PrimitivesGroup* >> groupsPerMaterial;
+    for( auto& group: _primitivesGroups )
+        groupsPerMaterial[group.material].push_back( &group );
+    for( auto& group: _primitivesGroups )
+        group.material = getMaterial( group );
+
+    PrimitivesMap primitives;
+    for( const auto& source: _primitives )
+    {
+        const Primitives& src = source.second;
+        const auto& groups = groupsPerMaterial[source.first];
+        reassignPrimitives( src.getSpheres(), source.first, groups,
+            &PrimitivesGroup::firstSphere, &PrimitivesGroup::nbSpheres,
+            primitives,
+            []( Primitives& p ) -> Spheres& { return p.getSpheres(); });
+        reassignPrimitives( src.getCylinders(), source.first, groups,
+            &PrimitivesGroup::firstCylinder, &PrimitivesGroup::nbCylinders,
+            primitives,
+            []( Primitives& p ) -> Cylinders& { return p.getCylinders(); });
+        reassignPrimitives( src.getCones(), source.first, groups,
+            &PrimitivesGroup::firstCone, &PrimitivesGroup::nbCones,
+            primitives,
+            []( Primitives& p ) -> Cones& { return p.getCones(); });
+        reassignPrimitives( src.getRoundedCones(), source.first, groups,
+            &PrimitivesGroup::firstRoundedCone,
+            &PrimitivesGroup::nbRoundedCones, primitives,
+            []( Primitives& p ) -> RoundedCones& { return p.getRoundedCones(); });
+    }
+    _primitives.swap( primitives );
+}
+
+void Scene::setProgress( const std::string& operation, const float amount )
+{
+    std::lock_guard< std::mutex > lock( _progressMutex );
+    _progressOperation = operation;
+    _progressAmount = amount;
+}
+
+void Scene::getProgress( std::string& operation, float& amount ) const
+{
+    std::lock_guard< std::mutex > lock( _progressMutex );
+    operation = _progressOperation;
+    amount = _progressAmount;
+}
+
+void Scene::_flattenInstancedGeometries()
+{
+    for( auto& instancedGeometry: _instancedGeometries )
+        instancedGeometry.flatten( _primitives, _trianglesMeshes );
+    _instancedGeometries.clear();
 }
 
 }
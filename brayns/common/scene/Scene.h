@@ -25,13 +25,16 @@
 #include <brayns/common/types.h>
 #include <brayns/common/material/Texture2D.h>
 #include <brayns/common/material/Material.h>
-#include <brayns/common/geometry/Sphere.h>
-#include <brayns/common/geometry/Cylinder.h>
-#include <brayns/common/geometry/Cone.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/common/geometry/TrianglesMesh.h>
+#include <brayns/common/geometry/InstancedGeometry.h>
 #include <brayns/common/transferFunction/TransferFunction.h>
 #include <brayns/common/simulation/AbstractSimulationHandler.h>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+
 namespace brayns
 {
 
@@ -102,6 +105,13 @@ public:
     */
     BRAYNS_API virtual void buildGeometry() = 0;
 
+    /**
+        Releases the engine specific geometry created by buildGeometry. The
+        primitives, meshes and materials of the scene are preserved, so that
+        geometry modified in place can be rebuilt without reloading it.
+    */
+    BRAYNS_API virtual void resetGeometry() = 0;
+
     /**
         Attach simulation data to renderer
     */
@@ -161,12 +171,13 @@ public:
     /**
         Return true if the scene does not contain any geometry. False otherwise
     */
-    BRAYNS_API bool empty() const;
+    BRAYNS_API virtual bool empty() const;
 
     BRAYNS_API ParametersManager& getParametersManager() { return _parametersManager; }
 
     /**
-        Returns geometric primitives handled by the scene
+        Returns geometric primitives handled by the scene, stored per
+        material in contiguous arrays
     */
     BRAYNS_API PrimitivesMap& getPrimitives() { return _primitives; }
 
@@ -185,6 +196,37 @@ public:
     */
     BRAYNS_API TrianglesMeshMap& getTriangleMeshes() { return _trianglesMeshes; }
 
+    /**
+        Returns geometries that are placed several times in the scene
+    */
+    BRAYNS_API InstancedGeometries& getInstancedGeometries()
+    {
+        return _instancedGeometries;
+    }
+
+    /**
+        Returns the groups of primitives created per morphology and section
+        type, used to reassign materials without reloading the morphologies
+    */
+    BRAYNS_API PrimitivesGroups& getPrimitivesGroups()
+    {
+        return _primitivesGroups;
+    }
+
+    /**
+        Multiplies the radius of the spheres, cylinders and cones loaded in
+        the scene by a given factor
+    */
+    BRAYNS_API void scaleRadii( float factor );
+
+    /**
+        Moves the primitives of every group to the material returned by
+        getMaterial. Primitives that do not belong to any group keep their
+        material.
+    */
+    BRAYNS_API void reassignMaterials(
+        const std::function< size_t( const PrimitivesGroup& )>& getMaterial );
+
     /**
         Returns the simulutation handler
     */
@@ -210,6 +252,45 @@ public:
     */
     BRAYNS_API virtual void reset();
 
+    /**
+        Returns the mutex protecting the data of the scene. Loaders hold it
+        while they add data to the scene, and the render loop while it builds
+        and renders the geometry, so that the scene can be loaded in the
+        background. The mutex is recursive since the render loop reloads the
+        scene synchronously when asynchronous loading is disabled.
+    */
+    BRAYNS_API std::recursive_mutex& getDataMutex() { return _dataMutex; }
+
+    /**
+        Notifies that data was added to the scene, and that the geometry has to
+        be built again before it is rendered. Called by loaders after every
+        batch of data.
+    */
+    BRAYNS_API void markModified() { _modified = true; }
+
+    /**
+        @return True if data was added to the scene since the last call
+    */
+    BRAYNS_API bool resetModified() { return _modified.exchange( false ); }
+
+    /**
+        Defines if data is currently being loaded in the background
+    */
+    BRAYNS_API void setLoading( const bool value ) { _loading = value; }
+    BRAYNS_API bool isLoading() const { return _loading; }
+
+    /**
+        Sets the progress of the current loading operation
+        @param operation Description of the operation
+        @param amount Progress of the operation, between 0 and 1
+    */
+    BRAYNS_API void setProgress( const std::string& operation, float amount );
+
+    /**
+        Gets the progress of the current loading operation
+    */
+    BRAYNS_API void getProgress( std::string& operation, float& amount ) const;
+
     /**
         Saves geometry a binary cache file defined by the --save-cache-file command line parameter
     */
@@ -217,6 +298,12 @@ public:
 
 protected:
 
+    /**
+        Expands instanced geometries into the primitives and meshes of the
+        scene, for engines that do not support instancing
+    */
+    void _flattenInstancedGeometries();
+
     // Parameters
     ParametersManager& _parametersManager;
     Renderers _renderers;
@@ -224,6 +311,8 @@ protected:
     // Model
     PrimitivesMap _primitives;
     TrianglesMeshMap _trianglesMeshes;
+    InstancedGeometries _instancedGeometries;
+    PrimitivesGroups _primitivesGroups;
     Materials _materials;
     TexturesMap _textures;
     Lights _lights;
@@ -238,6 +327,14 @@ protected:
     // Scene
     Boxf _bounds;
 
+    // Loading
+    std::recursive_mutex _dataMutex;
+    std::atomic< bool > _modified;
+    std::atomic< bool > _loading;
+    mutable std::mutex _progressMutex;
+    std::string _progressOperation;
+    float _progressAmount;
+
 };
 
 }
@@ -23,10 +23,108 @@
 #include <brayns/common/log.h>
 #include <brayns/parameters/GeometryParameters.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+const char SIMULATION_CACHE_MAGIC[8] = { 'B','R','A','Y','N','S','S','M' };
+const uint64_t SIMULATION_CACHE_VERSION = 1;
+const uint64_t NO_FRAME = std::numeric_limits< uint64_t >::max();
+
+size_t getValueSize( const brayns::SimulationEncoding encoding )
+{
+    switch( encoding )
+    {
+    case brayns::SimulationEncoding::float16:
+        return sizeof( uint16_t );
+    case brayns::SimulationEncoding::uint8:
+        return sizeof( uint8_t );
+    default:
+        return sizeof( float );
+    }
+}
+
+uint16_t floatToHalf( const float value )
+{
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof( bits ));
+    const uint16_t sign = ( bits >> 16 ) & 0x8000;
+    const int32_t exponent = int32_t(( bits >> 23 ) & 0xff ) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if( (( bits >> 23 ) & 0xff ) == 0xff ) // Infinity and NaN
+        return sign | 0x7c00 | ( mantissa ? 0x200 : 0 );
+    if( exponent >= 0x1f ) // Overflow
+        return sign | 0x7c00;
+    if( exponent <= 0 ) // Subnormal or zero
+    {
+        if( exponent < -10 )
+            return sign;
+        mantissa |= 0x800000;
+        const uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if(( mantissa >> ( shift - 1 )) & 1 ) // Round to nearest
+            ++half;
+        return sign | half;
+    }
+    uint32_t half = ( uint32_t( exponent ) << 10 ) | ( mantissa >> 13 );
+    if( mantissa & 0x1000 ) // Round to nearest, may carry into the exponent
+        ++half;
+    return sign | uint16_t( std::min( half, uint32_t( 0x7c00 )));
+}
+
+float halfToFloat( const uint16_t half )
+{
+    const uint32_t sign = uint32_t( half & 0x8000 ) << 16;
+    const uint32_t exponent = ( half >> 10 ) & 0x1f;
+    const uint32_t mantissa = half & 0x3ff;
+    if( exponent == 0 ) // Subnormal or zero
+    {
+        const float value = std::ldexp( float( mantissa ), -24 );
+        return sign ? -value : value;
+    }
+    uint32_t bits;
+    if( exponent == 0x1f ) // Infinity and NaN
+        bits = sign | 0x7f800000 | ( mantissa << 13 );
+    else
+        bits = sign | (( exponent + 127 - 15 ) << 23 ) | ( mantissa << 13 );
+    float value;
+    memcpy( &value, &bits, sizeof( value ));
+    return value;
+}
+
+void decodeFrame(
+    const brayns::SimulationEncoding encoding,
+    const brayns::SimulationFrameIndex& index,
+    const void* data,
+    const uint64_t frameSize,
+    float* values )
+{
+    if( encoding == brayns::SimulationEncoding::float16 )
+    {
+        const uint16_t* halves = static_cast< const uint16_t* >( data );
+        for( uint64_t i = 0; i < frameSize; ++i )
+            values[i] = halfToFloat( halves[i] );
+    }
+    else if( encoding == brayns::SimulationEncoding::uint8 )
+    {
+        const uint8_t* bytes = static_cast< const uint8_t* >( data );
+        const float scale = ( index.maxValue - index.minValue ) / 255.f;
+        for( uint64_t i = 0; i < frameSize; ++i )
+            values[i] = index.minValue + bytes[i] * scale;
+    }
+    else
+        memcpy( values, data, frameSize * sizeof( float ));
+}
+}
 
 namespace brayns
 {
@@ -40,33 +138,43 @@ AbstractSimulationHandler::AbstractSimulationHandler(
     , _frameSize( 0 )
     , _headerSize( 0 )
     , _memoryMapPtr( 0 )
+    , _memoryMapSize( 0 )
     , _cacheFileDescriptor( -1 )
+    , _encoding( geometryParameters.getSimulationCacheEncoding( ))
+    , _decodedFrame( NO_FRAME )
 {
-    _histogram.timestamp = _timestamp;
 }
 
 AbstractSimulationHandler::~AbstractSimulationHandler()
+{
+    _detachCacheFile();
+}
+
+void AbstractSimulationHandler::_detachCacheFile()
 {
     if( _memoryMapPtr )
-    {
-        const uint64_t size =
-            _headerSize +
-            _frameSize * _nbFrames * sizeof(float);
-        ::munmap( (void *)_memoryMapPtr, size );
-    }
+        ::munmap( (void *)_memoryMapPtr, _memoryMapSize );
+    _memoryMapPtr = 0;
+    _memoryMapSize = 0;
     if( _cacheFileDescriptor != -1 )
         ::close( _cacheFileDescriptor );
+    _cacheFileDescriptor = -1;
+    _nbFrames = 0;
+    _frameIndex.clear();
 }
 
 void AbstractSimulationHandler::setTimestamp( const float timestamp )
 {
-    _timestamp = size_t( timestamp ) % _nbFrames;
+    // The fractional part is kept for handlers interpolating between frames
+    _timestamp = ( _nbFrames == 0 ? 0.f :
+                   std::fmod( std::max( timestamp, 0.f ), float( _nbFrames )));
 }
 
 bool AbstractSimulationHandler::attachSimulationToCacheFile(
     const std::string& cacheFile )
 {
     BRAYNS_INFO << "Attaching " << cacheFile << " to current scene" << std::endl;
+    _detachCacheFile();
     _cacheFileDescriptor = open( cacheFile.c_str(), O_RDONLY );
     if( _cacheFileDescriptor == -1 )
     {
@@ -78,6 +186,7 @@ bool AbstractSimulationHandler::attachSimulationToCacheFile(
     if( ::fstat( _cacheFileDescriptor, &sb ) == -1 )
     {
         BRAYNS_ERROR << "Failed to get stats from " << cacheFile << std::endl;
+        _detachCacheFile();
         return false;
     }
 
@@ -87,17 +196,62 @@ bool AbstractSimulationHandler::attachSimulationToCacheFile(
     {
         _memoryMapPtr = 0;
         BRAYNS_ERROR << "Failed to attach " << cacheFile << std::endl;
-        ::close( _cacheFileDescriptor );
+        _detachCacheFile();
         return false;
     }
+    _memoryMapSize = sb.st_size;
 
-    _headerSize = 2 * sizeof( uint64_t );
+    const SimulationCacheHeader* header =
+        static_cast< const SimulationCacheHeader* >( _memoryMapPtr );
+    if( _memoryMapSize >= sizeof( SimulationCacheHeader ) &&
+        memcmp( header->magic, SIMULATION_CACHE_MAGIC, sizeof( header->magic )) == 0 )
+    {
+        if( header->version != SIMULATION_CACHE_VERSION ||
+            header->encoding > uint64_t( SimulationEncoding::uint8 ))
+        {
+            BRAYNS_ERROR << "Unsupported simulation cache file " << cacheFile << std::endl;
+            _detachCacheFile();
+            return false;
+        }
+        const uint64_t maxFrames = ( _memoryMapSize - sizeof( SimulationCacheHeader )) /
+                                   sizeof( SimulationFrameIndex );
+        if( header->nbFrames > maxFrames )
+        {
+            BRAYNS_ERROR << "Truncated simulation cache file " << cacheFile << std::endl;
+            _detachCacheFile();
+            return false;
+        }
+        _encoding = static_cast< SimulationEncoding >( header->encoding );
+        _nbFrames = header->nbFrames;
+        _frameSize = header->frameSize;
+        _headerSize =
+            sizeof( SimulationCacheHeader ) + _nbFrames * sizeof( SimulationFrameIndex );
+        const SimulationFrameIndex* index = reinterpret_cast< const SimulationFrameIndex* >(
+            static_cast< const char* >( _memoryMapPtr ) + sizeof( SimulationCacheHeader ));
+        _frameIndex.assign( index, index + _nbFrames );
+    }
+    else
+    {
+        if( _memoryMapSize < 2 * sizeof( uint64_t ))
+        {
+            BRAYNS_ERROR << "Truncated simulation cache file " << cacheFile << std::endl;
+            _detachCacheFile();
+            return false;
+        }
+        _encoding = SimulationEncoding::float32;
+        _headerSize = 2 * sizeof( uint64_t );
 
-    strncpy((char *)&_nbFrames, (char *)_memoryMapPtr, sizeof( uint64_t ));
-    strncpy((char *)&_frameSize, ((char *)_memoryMapPtr + sizeof( uint64_t )), sizeof( uint64_t ));
+        memcpy( &_nbFrames, _memoryMapPtr, sizeof( uint64_t ));
+        memcpy( &_frameSize, (char *)_memoryMapPtr + sizeof( uint64_t ), sizeof( uint64_t ));
+        _frameIndex.clear();
+    }
+    _decodedFrame = NO_FRAME;
+    _histograms.clear();
 
     BRAYNS_INFO << "Nb Frames: " << _nbFrames << std::endl;
     BRAYNS_INFO << "Frame size: " << _frameSize << std::endl;
+    BRAYNS_INFO << "Encoding: " <<
+        _geometryParameters.getSimulationEncodingAsString( _encoding ) << std::endl;
 
     BRAYNS_INFO << "Successfully attached to " << cacheFile << std::endl;
     return true;
@@ -105,50 +259,248 @@ bool AbstractSimulationHandler::attachSimulationToCacheFile(
 
 void AbstractSimulationHandler::writeHeader( std::ofstream& stream )
 {
-    stream.write( ( char* )&_nbFrames, sizeof( uint64_t ));
-    stream.write( ( char* )&_frameSize, sizeof( uint64_t ));
+    if( _encoding == SimulationEncoding::float32 )
+    {
+        stream.write( ( char* )&_nbFrames, sizeof( uint64_t ));
+        stream.write( ( char* )&_frameSize, sizeof( uint64_t ));
+        return;
+    }
+
+    SimulationCacheHeader header;
+    memcpy( header.magic, SIMULATION_CACHE_MAGIC, sizeof( header.magic ));
+    header.version = SIMULATION_CACHE_VERSION;
+    header.encoding = uint64_t( _encoding );
+    header.nbFrames = _nbFrames;
+    header.frameSize = _frameSize;
+    stream.write( ( char* )&header, sizeof( header ));
+
+    // The index is written once all frames are known
+    _frameIndex.clear();
+    _frameIndex.reserve( _nbFrames );
+    const std::vector< SimulationFrameIndex > index( _nbFrames, SimulationFrameIndex( ));
+    stream.write( ( char* )index.data(), index.size() * sizeof( SimulationFrameIndex ));
 }
 
 void AbstractSimulationHandler::writeFrame(
     std::ofstream& stream,
     const floats& values )
 {
-    stream.write( ( char* )values.data(), values.size() * sizeof(float) );
+    if( _encoding == SimulationEncoding::float32 )
+    {
+        stream.write( ( char* )values.data(), values.size() * sizeof(float) );
+        return;
+    }
+
+    if( _frameIndex.size() >= _nbFrames )
+    {
+        BRAYNS_WARN << "Ignoring simulation frame beyond the announced number of frames"
+                    << std::endl;
+        return;
+    }
+
+    SimulationFrameIndex index;
+    index.offset = stream.tellp();
+    index.minValue = std::numeric_limits< float >::max();
+    index.maxValue = -std::numeric_limits< float >::max();
+    for( const float value: values )
+    {
+        index.minValue = std::min( index.minValue, value );
+        index.maxValue = std::max( index.maxValue, value );
+    }
+    if( values.empty( ))
+        index.minValue = index.maxValue = 0.f;
+    _frameIndex.push_back( index );
+
+    if( _encoding == SimulationEncoding::float16 )
+    {
+        std::vector< uint16_t > halves( values.size( ));
+        for( size_t i = 0; i < values.size(); ++i )
+            halves[i] = floatToHalf( values[i] );
+        stream.write( ( char* )halves.data(), halves.size() * sizeof( uint16_t ));
+    }
+    else
+    {
+        const float range = index.maxValue - index.minValue;
+        const float scale = ( range > 0.f ? 255.f / range : 0.f );
+        std::vector< uint8_t > bytes( values.size( ));
+        for( size_t i = 0; i < values.size(); ++i )
+            bytes[i] = uint8_t( std::lround(( values[i] - index.minValue ) * scale ));
+        stream.write( ( char* )bytes.data(), bytes.size( ));
+    }
+}
+
+void AbstractSimulationHandler::writeIndex( std::ofstream& stream )
+{
+    if( _encoding == SimulationEncoding::float32 )
+        return;
+
+    const std::streampos end = stream.tellp();
+    stream.seekp( sizeof( SimulationCacheHeader ));
+    stream.write( ( char* )_frameIndex.data(),
+                  _frameIndex.size() * sizeof( SimulationFrameIndex ));
+    stream.seekp( end );
+}
+
+void* AbstractSimulationHandler::_getMappedFrameData( const uint64_t frame )
+{
+    if( !_memoryMapPtr || frame >= _nbFrames )
+        return 0;
+
+    char* data = static_cast< char* >( _memoryMapPtr );
+    if( _encoding == SimulationEncoding::float32 )
+        return data + _headerSize + frame * _frameSize * sizeof(float);
+
+    if( frame != _decodedFrame )
+    {
+        const SimulationFrameIndex& index = _frameIndex[frame];
+        if( index.offset + _frameSize * getValueSize( _encoding ) > _memoryMapSize )
+            return 0;
+        _decodedValues.resize( _frameSize );
+        decodeFrame( _encoding, index, data + index.offset, _frameSize,
+                     _decodedValues.data( ));
+        _decodedFrame = frame;
+    }
+    return _decodedValues.data();
+}
+
+void* AbstractSimulationHandler::_getInterpolatedFrameData(
+    const uint64_t frame,
+    const float alpha )
+{
+    const float* first = static_cast< const float* >( _getMappedFrameData( frame ));
+    if( !first )
+        return 0;
+
+    // Decoded frames share the same buffer, the first one has to be copied first
+    _interpolatedValues.assign( first, first + _frameSize );
+    const float* second = static_cast< const float* >( _getMappedFrameData( frame + 1 ));
+    if( !second )
+        return _interpolatedValues.data();
+    return _interpolateFrames( _interpolatedValues.data(), second, alpha );
+}
+
+void* AbstractSimulationHandler::_interpolateFrames(
+    const float* first,
+    const float* second,
+    const float alpha )
+{
+    _interpolatedValues.resize( _frameSize );
+    float* values = _interpolatedValues.data();
+    const int64_t frameSize = _frameSize;
+    #pragma omp parallel for
+    for( int64_t i = 0; i < frameSize; ++i )
+        values[i] = first[i] + ( second[i] - first[i] ) * alpha;
+    return values;
+}
+
+bool AbstractSimulationHandler::_readFrame( const uint64_t frame, floats& values ) const
+{
+    if( _cacheFileDescriptor == -1 || frame >= _nbFrames )
+        return false;
+
+    const size_t valueSize = getValueSize( _encoding );
+    const size_t size = _frameSize * valueSize;
+    const uint64_t offset = ( _encoding == SimulationEncoding::float32 ?
+        _headerSize + frame * size : _frameIndex[frame].offset );
+
+    values.resize( _frameSize );
+    std::vector< char > encoded;
+    char* data = reinterpret_cast< char* >( values.data( ));
+    if( _encoding != SimulationEncoding::float32 )
+    {
+        encoded.resize( size );
+        data = encoded.data();
+    }
+
+    size_t read = 0;
+    while( read < size )
+    {
+        const ssize_t result =
+            ::pread( _cacheFileDescriptor, data + read, size - read, offset + read );
+        if( result < 0 && errno == EINTR )
+            continue;
+        if( result <= 0 )
+            return false;
+        read += result;
+    }
+
+    if( _encoding != SimulationEncoding::float32 )
+        decodeFrame( _encoding, _frameIndex[frame], data, _frameSize, values.data( ));
+    return true;
 }
 
 const Histogram& AbstractSimulationHandler::getHistogram()
 {
-    if( _timestamp == _histogram.timestamp )
-        return _histogram;
+    static const Histogram emptyHistogram = Histogram();
+    if( _nbFrames == 0 )
+        return emptyHistogram;
 
-    float* data = (float*)getFrameData();
+    const uint64_t frame = ( _timestamp < 0.f ? 0 : uint64_t( _timestamp ) % _nbFrames );
 
-    // Determine range
-    Vector2f range( std::numeric_limits< float >::max(), -std::numeric_limits< float >::max( ));
-    for( size_t i = 0; i < _frameSize; ++i )
+    // Timestamps in between two frames blend these frames. The histogram of the blended values
+    // has its own range, and is not cached
+    const float alpha = ( _timestamp < 0.f ? 0.f : _timestamp - std::floor( _timestamp ));
+    const bool interpolated = ( alpha > 0.f && frame + 1 < _nbFrames );
+    if( !interpolated )
     {
-        const uint64_t index = i * sizeof(float);
-        float value = data[index];
-        if( value < range.x() ) range.x() = value;
-        if( value > range.y() ) range.y() = value;
+        auto cached = _histograms.find( frame );
+        if( cached != _histograms.end( ))
+            return cached->second;
     }
 
-    // Normalize values
-    const auto histogramSize = _geometryParameters.getSimulationHistogramSize();
-    _histogram.values.clear();
-    const float normalizationValue = ( range.y() - range.x() ) / float( histogramSize );
-    for( size_t i = 0; i < _frameSize; ++i )
+    const float* data = static_cast< const float* >( getFrameData( ));
+    if( !data )
+        return emptyHistogram;
+
+    // Determine range. Quantized frames already know it from the frame index
+    Vector2f range;
+    if( !_frameIndex.empty() && !interpolated )
+        range = Vector2f( _frameIndex[frame].minValue, _frameIndex[frame].maxValue );
+    else
     {
-        const uint64_t index = i * sizeof(float);
-        _histogram.values.resize( histogramSize, 0 );
-        const size_t idx = ( data[index] - range.x( )) * normalizationValue;
-        ++_histogram.values[ idx ];
+        float minValue = std::numeric_limits< float >::max();
+        float maxValue = -std::numeric_limits< float >::max();
+        const int64_t frameSize = _frameSize;
+        #pragma omp parallel for reduction( min:minValue ) reduction( max:maxValue )
+        for( int64_t i = 0; i < frameSize; ++i )
+        {
+            minValue = std::min( minValue, data[i] );
+            maxValue = std::max( maxValue, data[i] );
+        }
+        range = Vector2f( minValue, maxValue );
     }
 
-    // Build histogram
-    _histogram.range = range;
-    _histogram.timestamp = _timestamp;
-    return _histogram;
+    // Count values, one set of bins per thread
+    const size_t histogramSize = _geometryParameters.getSimulationHistogramSize();
+    Histogram histogram;
+    histogram.values.resize( histogramSize, 0 );
+    histogram.range = range;
+    histogram.timestamp = _timestamp;
+    const float normalizationValue =
+        ( range.y() > range.x() ? float( histogramSize ) / ( range.y() - range.x( )) : 0.f );
+    const int64_t lastBin = histogramSize - 1;
+    const int64_t frameSize = _frameSize;
+    #pragma omp parallel
+    {
+        uint64_ts bins( histogramSize, 0 );
+        #pragma omp for nowait
+        for( int64_t i = 0; i < frameSize; ++i )
+        {
+            const int64_t bin = ( data[i] - range.x( )) * normalizationValue;
+            ++bins[ std::max( int64_t( 0 ), std::min( bin, lastBin ))];
+        }
+        #pragma omp critical( simulationHistogram )
+        for( size_t i = 0; i < histogramSize; ++i )
+            histogram.values[i] += bins[i];
+    }
+
+    // Frames that are still being loaded are not cached
+    if( interpolated || !isReady( ))
+    {
+        _histogram = histogram;
+        return _histogram;
+    }
+    return _histograms[frame] = histogram;
 }
 
 }
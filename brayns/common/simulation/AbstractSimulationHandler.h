@@ -24,11 +24,38 @@
 #include <brayns/api.h>
 #include <brayns/common/types.h>
 
+#include <map>
+#include <vector>
+
 namespace brayns
 {
 
+/** Header of the quantized simulation cache files */
+struct SimulationCacheHeader
+{
+    char magic[8];
+    uint64_t version;
+    uint64_t encoding;
+    uint64_t nbFrames;
+    uint64_t frameSize;
+};
+
+/** Position and range of the values of a quantized frame */
+struct SimulationFrameIndex
+{
+    uint64_t offset;
+    float minValue;
+    float maxValue;
+};
+
 /**
- * @brief The AbstractSimulationHandler class handles simulation frames for the current circuit
+ * @brief The AbstractSimulationHandler class handles simulation frames for the current circuit.
+ *
+ * Simulation cache files either contain raw float32 frames, preceded by the number of frames
+ * and the frame size, or quantized frames (--simulation-cache-encoding). Quantized files start
+ * with a SimulationCacheHeader, followed by one SimulationFrameIndex per frame, and the frames
+ * themselves. Values are stored as float16, or as 8-bit integers spanning the minimum and
+ * maximum values of their frame. Frames are decoded when they are accessed.
  */
 class AbstractSimulationHandler
 {
@@ -57,18 +84,26 @@ public:
 
     /**
     * @brief Writes the header to a stream. The header contains the number of frames and the frame
-    *        size.
+    *        size. For quantized encodings, space is also reserved for the frame index.
     * @param stream Stream where the header should be written
     */
     BRAYNS_API void writeHeader( std::ofstream& stream );
 
     /**
-    * @brief Writes a frame to a stream. A frame is a set of float values.
+    * @brief Writes a frame to a stream. A frame is a set of float values, encoded according to
+    *        the --simulation-cache-encoding parameter.
     * @param stream Stream where the header should be written
     * @param values Frame values
     */
     BRAYNS_API void writeFrame( std::ofstream& stream, const floats& values );
 
+    /**
+    * @brief Writes the frame index of quantized encodings. Must be called once all frames have
+    *        been written.
+    * @param stream Stream where the index should be written
+    */
+    BRAYNS_API void writeIndex( std::ofstream& stream );
+
     /**
      * @brief setTimestamp sets the current timestamp for the simulation
      * @param timestamp Timestamp to set
@@ -80,6 +115,14 @@ public:
      */
     virtual void* getFrameData() = 0;
 
+    /**
+     * @brief isReady returns true if the data returned by the last call to getFrameData
+     *        belongs to the current timestamp and is up to date, false if the handler returned
+     *        the data of a previous frame while the current one is being loaded, or if newer
+     *        values are waiting to be written to the frame
+     */
+    virtual bool isReady() const { return true; }
+
     /**
      * @brief getFrameSize return the size of the current simulation frame
      */
@@ -116,12 +159,47 @@ public:
      *        parameter (128 by default). To build the histogram, occurrences of the same value are
      *        counted and spread along the histogram according to the calculated range. The
      *        range is defined by the minimum and maximum value of the current frame. The Histogram
-     *        is specific to the current frame, not to the whole simulation.
+     *        is specific to the current frame, not to the whole simulation. Histograms are
+     *        computed in parallel and kept per frame, so that going back to a frame does not
+     *        compute its histogram again. Timestamps in between two frames get the histogram
+     *        of the blended values, which is not kept.
      */
     const Histogram& getHistogram();
 
 protected:
 
+    /**
+     * @brief Returns the given frame, from the memory mapped file. Quantized frames are decoded
+     *        to a buffer that remains valid until the next call.
+     */
+    void* _getMappedFrameData( uint64_t frame );
+
+    /**
+     * @brief Returns the given frame blended with the next one, from the memory mapped file
+     * @param frame First frame
+     * @param alpha Weight of the next frame, between 0 and 1
+     */
+    void* _getInterpolatedFrameData( uint64_t frame, float alpha );
+
+    /**
+     * @brief Blends two frames into the interpolation buffer. The first frame can be the
+     *        interpolation buffer itself.
+     * @return Pointer to the interpolated values, that remain valid until the next call
+     */
+    void* _interpolateFrames( const float* first, const float* second, float alpha );
+
+    /**
+     * @brief Reads and decodes the given frame from the cache file, without using the memory
+     *        mapping. Can be called from any thread.
+     * @return True if the frame was successfully read, false otherwise
+     */
+    bool _readFrame( uint64_t frame, floats& values ) const;
+
+    /**
+     * @brief Unmaps and closes the attached cache file, if any
+     */
+    void _detachCacheFile();
+
     const GeometryParameters& _geometryParameters;
     float _timestamp;
     uint64_t _currentFrame;
@@ -130,8 +208,16 @@ protected:
 
     uint64_t _headerSize;
     void* _memoryMapPtr;
+    uint64_t _memoryMapSize;
     int _cacheFileDescriptor;
     Histogram _histogram;
+    std::map< uint64_t, Histogram > _histograms;
+
+    SimulationEncoding _encoding;
+    std::vector< SimulationFrameIndex > _frameIndex;
+    floats _decodedValues;
+    uint64_t _decodedFrame;
+    floats _interpolatedValues;
 
 };
 
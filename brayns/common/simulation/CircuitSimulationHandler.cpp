@@ -21,16 +21,42 @@
 #include "CircuitSimulationHandler.h"
 
 #include <brayns/common/log.h>
+#include <brayns/parameters/GeometryParameters.h>
 
+#include <cmath>
+#include <fcntl.h>
 #include <fstream>
+#include <limits>
 #include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+const uint64_t NO_FRAME = std::numeric_limits< uint64_t >::max();
+const size_t NO_BUFFER = std::numeric_limits< size_t >::max();
+}
 
 namespace brayns
 {
 
 CircuitSimulationHandler::CircuitSimulationHandler( const GeometryParameters& geometryParameters )
     : AbstractSimulationHandler( geometryParameters )
+    , _currentBuffer( NO_BUFFER )
+    , _requestedFrame( 0 )
+    , _stopStreaming( false )
+    , _ready( true )
+{
+}
+
+CircuitSimulationHandler::~CircuitSimulationHandler()
 {
+    {
+        std::lock_guard< std::mutex > lock( _streamingMutex );
+        _stopStreaming = true;
+    }
+    _streamingCondition.notify_one();
+    if( _streamingThread.joinable( ))
+        _streamingThread.join();
 }
 
 void* CircuitSimulationHandler::getFrameData()
@@ -38,10 +64,131 @@ void* CircuitSimulationHandler::getFrameData()
     if( _nbFrames ==  0 )
         return 0;
 
-    const uint64_t frame = _timestamp;
-    const uint64_t moduloFrame = frame % _nbFrames;
-    const uint64_t index = std::min( _frameSize, std::max( uint64_t(0), moduloFrame ));
-    return (unsigned char*)_memoryMapPtr + _headerSize + index * _frameSize * sizeof(float);
+    // Timestamps in between two frames blend these frames, except after the last one
+    const uint64_t frame = uint64_t( _timestamp ) % _nbFrames;
+    const float alpha = _timestamp - std::floor( _timestamp );
+    const bool interpolate = ( alpha > 0.f && frame + 1 < _nbFrames );
+
+    const size_t nbPrefetchFrames = _geometryParameters.getSimulationPrefetchFrames();
+    if( nbPrefetchFrames == 0 || _cacheFileDescriptor == -1 )
+    {
+        _ready = true;
+        return interpolate ? _getInterpolatedFrameData( frame, alpha )
+                           : _getMappedFrameData( frame );
+    }
+
+    std::unique_lock< std::mutex > lock( _streamingMutex );
+    if( !_streamingThread.joinable( ))
+        _startStreaming( frame, nbPrefetchFrames );
+
+    _requestedFrame = frame;
+    const size_t buffer = _findBuffer( frame );
+    if( buffer != NO_BUFFER )
+        _currentBuffer = buffer;
+
+    // The next frame is in the read ahead window, its buffer cannot be reused while blending
+    const size_t nextBuffer = ( interpolate ? _findBuffer( frame + 1 ) : NO_BUFFER );
+    _ready = ( buffer != NO_BUFFER && ( !interpolate || nextBuffer != NO_BUFFER ));
+    void* data = _frames[_currentBuffer].values.data();
+    const float* nextData =
+        ( nextBuffer == NO_BUFFER ? nullptr : _frames[nextBuffer].values.data( ));
+    lock.unlock();
+
+    _streamingCondition.notify_one();
+    if( _ready && interpolate )
+        return _interpolateFrames( static_cast< const float* >( data ), nextData, alpha );
+    return data;
+}
+
+void CircuitSimulationHandler::_startStreaming(
+    const uint64_t frame,
+    const size_t nbPrefetchFrames )
+{
+    BRAYNS_INFO << "Streaming simulation frames, " << nbPrefetchFrames
+                << " frames read ahead" << std::endl;
+    _frames.resize( nbPrefetchFrames + 1 );
+    for( auto& buffer: _frames )
+    {
+        buffer.frame = NO_FRAME;
+        buffer.loading = false;
+        buffer.values.resize( _frameSize, 0.f );
+    }
+
+    // Nothing can be displayed until the first frame is loaded
+    if( _readFrame( frame, _frames[0].values ))
+        _frames[0].frame = frame;
+    _currentBuffer = 0;
+
+    ::posix_fadvise( _cacheFileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL );
+    _streamingThread = std::thread( &CircuitSimulationHandler::_stream, this );
+}
+
+void CircuitSimulationHandler::_stream()
+{
+    std::unique_lock< std::mutex > lock( _streamingMutex );
+    while( !_stopStreaming )
+    {
+        // First frame of the read ahead window that is not loaded yet
+        uint64_t frame = NO_FRAME;
+        for( size_t i = 0; i < _frames.size() && frame == NO_FRAME; ++i )
+        {
+            const uint64_t candidate = ( _requestedFrame + i ) % _nbFrames;
+            if( _findBuffer( candidate ) == NO_BUFFER )
+                frame = candidate;
+        }
+
+        const size_t buffer =
+            ( frame == NO_FRAME ? NO_BUFFER : _findFreeBuffer( ));
+        if( buffer == NO_BUFFER )
+        {
+            _streamingCondition.wait( lock );
+            continue;
+        }
+
+        StreamedFrame& streamedFrame = _frames[buffer];
+        streamedFrame.frame = NO_FRAME;
+        streamedFrame.loading = true;
+        lock.unlock();
+
+        const bool loaded = _readFrame( frame, streamedFrame.values );
+
+        lock.lock();
+        streamedFrame.loading = false;
+        if( loaded )
+            streamedFrame.frame = frame;
+        else
+        {
+            BRAYNS_ERROR << "Failed to read simulation frame " << frame << std::endl;
+            _streamingCondition.wait( lock );
+        }
+    }
+}
+
+size_t CircuitSimulationHandler::_findBuffer( const uint64_t frame ) const
+{
+    for( size_t i = 0; i < _frames.size(); ++i )
+        if( _frames[i].frame == frame && !_frames[i].loading )
+            return i;
+    return NO_BUFFER;
+}
+
+size_t CircuitSimulationHandler::_findFreeBuffer() const
+{
+    // Buffers that are neither displayed, nor being loaded, nor holding a
+    // frame of the read ahead window can be reused
+    for( size_t i = 0; i < _frames.size(); ++i )
+    {
+        const StreamedFrame& buffer = _frames[i];
+        if( i == _currentBuffer || buffer.loading )
+            continue;
+        if( buffer.frame == NO_FRAME )
+            return i;
+        const uint64_t distance =
+            ( buffer.frame + _nbFrames - _requestedFrame ) % _nbFrames;
+        if( distance >= _frames.size( ))
+            return i;
+    }
+    return NO_BUFFER;
 }
 
 }
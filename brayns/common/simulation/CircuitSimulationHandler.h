@@ -26,14 +26,21 @@
 #include <brayns/common/scene/Scene.h>
 #include <brayns/common/simulation/AbstractSimulationHandler.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace brayns
 {
 
 /**
  * @brief The CircuitSimulationHandler class handles simulation frames for the current circuit.
- *        Frames are stored in a memory mapped file that is accessed according to a specified
- *        timestamp. The CircuitSimulationHandler class is in charge of keeping the handle to the
- *        memory mapped file.
+ *        Frames are stored in a cache file that is accessed according to a specified
+ *        timestamp. The frames following the current one are read ahead by a background thread
+ *        into a ring of buffers (--simulation-prefetch-frames), so that playing the simulation
+ *        does not wait for the storage. The file is memory mapped instead if prefetching is
+ *        disabled. The CircuitSimulationHandler class is in charge of keeping the handle to the
+ *        cache file.
  */
 class CircuitSimulationHandler: public AbstractSimulationHandler
 {
@@ -46,12 +53,44 @@ public:
      */
     CircuitSimulationHandler( const GeometryParameters& geometryParameters );
 
+    ~CircuitSimulationHandler();
+
     /**
-     * @brief Returns a pointer to the current frame in the memory mapped file.
+     * @brief Returns a pointer to the current frame. The call never waits for the storage,
+     *        except for the very first frame: if the current frame was not read ahead, the
+     *        previously returned frame is returned until the current one is loaded. Timestamps
+     *        in between two frames return the linear interpolation of these frames, once both
+     *        are loaded. The returned data remains valid until the next call.
      * @return Pointer to given frame
      */
     void* getFrameData() final;
 
+    /** @copydoc AbstractSimulationHandler::isReady */
+    bool isReady() const final { return _ready; }
+
+private:
+
+    /** Buffer of the ring of frames read ahead */
+    struct StreamedFrame
+    {
+        uint64_t frame;
+        bool loading;
+        floats values;
+    };
+
+    void _startStreaming( uint64_t frame, size_t nbPrefetchFrames );
+    void _stream();
+    size_t _findBuffer( uint64_t frame ) const;
+    size_t _findFreeBuffer() const;
+
+    std::vector< StreamedFrame > _frames;
+    size_t _currentBuffer;
+    uint64_t _requestedFrame;
+    bool _stopStreaming;
+    bool _ready;
+    std::mutex _streamingMutex;
+    std::condition_variable _streamingCondition;
+    std::thread _streamingThread;
 };
 
 }
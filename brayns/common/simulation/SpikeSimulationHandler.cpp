@@ -22,25 +22,144 @@
 
 #include <brayns/common/log.h>
 
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+const float NO_SPIKE = -1.f;
+const uint64_t NO_FRAME = std::numeric_limits< uint64_t >::max();
+
+bool isEarlier( const brayns::SpikeEvent& a, const brayns::SpikeEvent& b )
+{
+    return a.time < b.time;
+}
+}
+
 namespace brayns
 {
 
 SpikeSimulationHandler::SpikeSimulationHandler( const GeometryParameters& geometryParameters )
     : AbstractSimulationHandler( geometryParameters )
+    , _startTime( 0.f )
+    , _timestep( 1.f )
+    , _nextSpike( 0 )
+    , _sparseFrame( NO_FRAME )
+    , _live( false )
+    , _spikesPending( false )
+{
+}
+
+void SpikeSimulationHandler::setSpikes(
+    SpikeEvents&& spikes,
+    const uint64_t nbCells,
+    const float timestep )
+{
+    _spikes = std::move( spikes );
+    if( !std::is_sorted( _spikes.begin(), _spikes.end(), isEarlier ))
+        std::stable_sort( _spikes.begin(), _spikes.end(), isEarlier );
+
+    _timestep = timestep;
+    _startTime = _spikes.empty() ? 0.f : _spikes.front().time;
+    const float endTime = _spikes.empty() ? 0.f : _spikes.back().time;
+    _nbFrames = uint64_t(( endTime - _startTime ) / _timestep ) + 1;
+    _frameSize = nbCells;
+    _spikingTimes.assign( _frameSize, NO_SPIKE );
+    _nextSpike = 0;
+    _sparseFrame = NO_FRAME;
+
+    BRAYNS_INFO << "Sparse spikes: " << _spikes.size() << " events, " << _nbFrames
+                << " frames of " << _frameSize << " cells" << std::endl;
+}
+
+void SpikeSimulationHandler::setLive( const uint64_t nbCells )
 {
+    SpikeEvents().swap( _spikes );
+    _live = true;
+    _nbFrames = 1;
+    _frameSize = nbCells;
+    _spikingTimes.assign( _frameSize, NO_SPIKE );
+
+    std::lock_guard< std::mutex > lock( _pendingSpikesMutex );
+    _pendingSpikingTimes.assign( _frameSize, NO_SPIKE );
+    _spikesPending = false;
+
+    BRAYNS_INFO << "Waiting for spikes of " << _frameSize << " cells" << std::endl;
+}
+
+void SpikeSimulationHandler::addSpikes( const float time, const uint64_ts& gids )
+{
+    std::lock_guard< std::mutex > lock( _pendingSpikesMutex );
+    for( const auto gid: gids )
+    {
+        if( gid >= _pendingSpikingTimes.size( ))
+            continue;
+        float& pendingTime = _pendingSpikingTimes[ gid ];
+        pendingTime = std::max( pendingTime, time );
+        _spikesPending = true;
+    }
 }
 
 void* SpikeSimulationHandler::getFrameData()
 {
+    if( _live )
+    {
+        std::lock_guard< std::mutex > lock( _pendingSpikesMutex );
+        if( !_spikesPending )
+            return _spikingTimes.data();
+
+        // The frame changes in place, so does its histogram
+        _histograms.clear();
+        for( size_t i = 0; i < _pendingSpikingTimes.size(); ++i )
+        {
+            if( _pendingSpikingTimes[i] == NO_SPIKE )
+                continue;
+            _spikingTimes[i] = _pendingSpikingTimes[i];
+            _pendingSpikingTimes[i] = NO_SPIKE;
+        }
+        _spikesPending = false;
+        return _spikingTimes.data();
+    }
+
+    if( !_spikingTimes.empty( ))
+    {
+        const uint64_t frame = ( _timestamp < 0.f ? 0 : uint64_t( _timestamp ) % _nbFrames );
+        if( frame == _sparseFrame )
+            return _spikingTimes.data();
+
+        // Spikes up to the end of the frame
+        const SpikeEvent end = { _startTime + ( frame + 1 ) * _timestep, 0 };
+        const size_t lastSpike = std::lower_bound(
+            _spikes.begin() + ( frame > _sparseFrame ? _nextSpike : 0 ),
+            _spikes.end(), end, isEarlier ) - _spikes.begin();
+
+        if( lastSpike < _nextSpike )
+        {
+            // Going back in time, the last spike times have to be computed again
+            std::fill( _spikingTimes.begin(), _spikingTimes.end(), NO_SPIKE );
+            _nextSpike = 0;
+        }
+        for( size_t i = _nextSpike; i < lastSpike; ++i )
+            if( _spikes[i].gid < _frameSize )
+                _spikingTimes[ _spikes[i].gid ] = _spikes[i].time;
+        _nextSpike = lastSpike;
+        _sparseFrame = frame;
+        return _spikingTimes.data();
+    }
+
     if( _nbFrames == 0 || _memoryMapPtr == 0 )
         return 0;
 
-    const uint64_t frame = _timestamp;
-    const uint64_t moduloFrame = frame % _nbFrames;
-    const uint64_t index = std::min( _frameSize, std::max( uint64_t(0), moduloFrame ));
-
-    return (unsigned char*)_memoryMapPtr + _headerSize + index * _frameSize * sizeof(float);
+    const uint64_t frame = ( _timestamp < 0.f ? 0 : uint64_t( _timestamp ));
+    return _getMappedFrameData( std::min( frame, _nbFrames - 1 ));
 }
 
+bool SpikeSimulationHandler::isReady() const
+{
+    if( !_live )
+        return true;
+    std::lock_guard< std::mutex > lock( _pendingSpikesMutex );
+    return !_spikesPending;
+}
 
 }
@@ -26,14 +26,36 @@
 #include <brayns/common/scene/Scene.h>
 #include <brayns/common/simulation/AbstractSimulationHandler.h>
 
+#include <mutex>
+
 namespace brayns
 {
 
+/** Spike event: time of the spike, and index of the cell that spiked */
+struct SpikeEvent
+{
+    float time;
+    uint32_t gid;
+};
+typedef std::vector< SpikeEvent > SpikeEvents;
+
 /**
  * @brief The SpikeSimulationHandler class handles simulation frames for the current circuit.
  *        Frames are stored in a memory mapped file that is accessed according to a specified
  *        timestamp. The SpikeSimulationHandler class is in charge of keeping the handle to the
  *        memory mapped file.
+ *
+ *        In sparse mode (see setSpikes), no cache file is used: spikes are kept as a list of
+ *        events sorted by time, and the frame holding the last spike time of every cell is
+ *        updated incrementally when the simulation plays forward. Seeking locates the events of
+ *        the requested frame by binary search, and going back in time replays the events from
+ *        the beginning of the simulation.
+ *
+ *        In live mode (see setLive), spikes are received from a running simulation (see
+ *        addSpikes) and written into a single frame, updated in place. As in sparse mode, the
+ *        frame holds the last spike time of every cell, which is kept until the cell spikes
+ *        again, so that the renderer can fade cells according to the time since their last
+ *        spike.
  */
 class SpikeSimulationHandler : public AbstractSimulationHandler
 {
@@ -47,11 +69,61 @@ public:
     SpikeSimulationHandler( const GeometryParameters& geometryParameters );
 
     /**
-     * @brief Returns a pointer to the current frame in the memory mapped file.
+     * @brief Switches the handler to sparse mode, using the given spikes instead of a cache file
+     * @param spikes Spike events, sorted by time if they are not already
+     * @param nbCells Number of cells, which is the size of the frames
+     * @param timestep Duration of a frame
+     */
+    BRAYNS_API void setSpikes( SpikeEvents&& spikes, uint64_t nbCells, float timestep );
+
+    /**
+     * @brief Switches the handler to live mode, where the single frame is only made of the
+     *        spikes received with addSpikes
+     * @param nbCells Number of cells, which is the size of the frame
+     */
+    BRAYNS_API void setLive( uint64_t nbCells );
+
+    /**
+     * @brief isLive returns true if the handler is in live mode
+     */
+    bool isLive() const { return _live; }
+
+    /**
+     * @brief Queues spikes received from a running simulation. Spikes are batched and written
+     *        to the frame by the next call to getFrameData. Only the last spike of every cell
+     *        is queued, so that the queue does not grow while no frame is rendered. Can be
+     *        called from any thread.
+     * @param time Time of the spikes
+     * @param gids Cells that spiked
+     */
+    BRAYNS_API void addSpikes( float time, const uint64_ts& gids );
+
+    /**
+     * @brief Returns a pointer to the current frame in the memory mapped file, or to the frame
+     *        built from the spike events in sparse and live modes.
      * @return Pointer to given frame
      */
     void* getFrameData() final;
 
+    /**
+     * @brief In live mode, returns false while received spikes are waiting to be written to
+     *        the frame
+     */
+    bool isReady() const final;
+
+private:
+
+    SpikeEvents _spikes;
+    floats _spikingTimes;
+    float _startTime;
+    float _timestep;
+    size_t _nextSpike;
+    uint64_t _sparseFrame;
+
+    bool _live;
+    floats _pendingSpikingTimes;
+    bool _spikesPending;
+    mutable std::mutex _pendingSpikesMutex;
 };
 
 }
@@ -100,29 +100,17 @@ typedef std::shared_ptr<ExtensionController> ExtensionControllerPtr;
 class Geometry;
 typedef std::vector< Geometry* > Geometries;
 
-class Primitive;
-typedef std::shared_ptr<Primitive> PrimitivePtr;
-typedef std::vector<PrimitivePtr> Primitives;
+class Primitives;
 typedef std::map<size_t, Primitives> PrimitivesMap;
-
-class Sphere;
-typedef std::shared_ptr<Sphere> SpherePtr;
-typedef std::vector<SpherePtr> Spheres;
-typedef std::map<size_t, Spheres> SpheresMap;
-
-class Cylinder;
-typedef std::shared_ptr<Cylinder> CylinderPtr;
-typedef std::vector<CylinderPtr> Cylinders;
-typedef std::map<size_t, Cylinders> CylindersMap;
-
-class Cone;
-typedef std::shared_ptr<Cone> ConePtr;
-typedef std::vector<ConePtr> Cones;
-typedef std::map<size_t, Cones> ConesMap;
+struct PrimitivesGroup;
+typedef std::vector<PrimitivesGroup> PrimitivesGroups;
 
 class TrianglesMesh;
 typedef std::map<size_t, TrianglesMesh> TrianglesMeshMap;
 
+class InstancedGeometry;
+typedef std::vector<InstancedGeometry> InstancedGeometries;
+
 class Material;
 typedef std::shared_ptr<Material> MaterialPtr;
 typedef std::vector<MaterialPtr> Materials;
@@ -156,6 +144,9 @@ typedef std::shared_ptr< SpikeSimulationHandler > SpikeSimulationHandlerPtr;
 class VolumeHandler;
 typedef std::shared_ptr< VolumeHandler > VolumeHandlerPtr;
 
+class BrickedVolume;
+typedef std::shared_ptr< BrickedVolume > BrickedVolumePtr;
+
 typedef std::vector< std::string > strings;
 typedef std::vector< float > floats;
 typedef std::vector< int > ints;
@@ -242,6 +233,14 @@ enum class GeometryQuality
     high
 };
 
+/** Encoding of the values of the simulation cache files */
+enum class SimulationEncoding
+{
+    float32,
+    float16,
+    uint8
+};
+
 /** Morphology element types */
 enum MorphologySectionType
 {
@@ -308,6 +307,17 @@ enum MaterialType
     MT_PASTEL_COLORS,  // Random pastel colors
 };
 
+/** Parts of the scene that have to be updated after parameters changed */
+enum SceneChange
+{
+    SC_NONE = 0x00,
+    SC_RADIUS = 0x01,            // Radius multiplier or correction
+    SC_COLOR_SCHEME = 0x02,      // Assignment of materials to the geometry
+    SC_TRANSFER_FUNCTION = 0x04, // Color map file
+    SC_DATA_SOURCES = 0x08,      // Anything else, requires a full reload
+    SC_ALL = 0xFF
+};
+
 enum class ShadingType
 {
     none,
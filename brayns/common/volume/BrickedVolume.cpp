@@ -0,0 +1,380 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "BrickedVolume.h"
+
+#include <brayns/common/log.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+const char BRICKED_VOLUME_MAGIC[8] = { 'B','R','A','Y','N','S','B','V' };
+const uint64_t BRICKED_VOLUME_VERSION = 1;
+
+brayns::Vector3ui getNbBricks( const brayns::Vector3ui& dimensions, const size_t brickSize )
+{
+    return brayns::Vector3ui(
+        ( dimensions.x() + brickSize - 1 ) / brickSize,
+        ( dimensions.y() + brickSize - 1 ) / brickSize,
+        ( dimensions.z() + brickSize - 1 ) / brickSize );
+}
+
+/** Reorganizes a volume stored linearly into bricks */
+void brick(
+    const uint8_t* src,
+    const brayns::Vector3ui& dimensions,
+    const size_t brickSize,
+    uint8_t* dst )
+{
+    const brayns::Vector3ui nbBricks = getNbBricks( dimensions, brickSize );
+    const int64_t totalBricks = int64_t( nbBricks.x( )) * nbBricks.y() * nbBricks.z();
+    const size_t brickVolume = brickSize * brickSize * brickSize;
+
+    #pragma omp parallel for schedule( dynamic )
+    for( int64_t i = 0; i < totalBricks; ++i )
+    {
+        const size_t bx = i % nbBricks.x();
+        const size_t by = ( i / nbBricks.x( )) % nbBricks.y();
+        const size_t bz = i / ( size_t( nbBricks.x( )) * nbBricks.y( ));
+        uint8_t* voxels = dst + i * brickVolume;
+        for( size_t z = 0; z < brickSize; ++z )
+        {
+            const size_t sz = std::min( bz * brickSize + z, size_t( dimensions.z() - 1 ));
+            for( size_t y = 0; y < brickSize; ++y )
+            {
+                const size_t sy = std::min( by * brickSize + y, size_t( dimensions.y() - 1 ));
+                const uint8_t* row = src + ( sz * dimensions.y() + sy ) * dimensions.x();
+                for( size_t x = 0; x < brickSize; ++x )
+                    *voxels++ = row[ std::min( bx * brickSize + x, size_t( dimensions.x() - 1 ))];
+            }
+        }
+    }
+}
+
+/** Halves the resolution of a volume stored linearly */
+void downsample(
+    const uint8_t* src,
+    const brayns::Vector3ui& dimensions,
+    uint8_t* dst,
+    const brayns::Vector3ui& halfDimensions )
+{
+    const int64_t depth = halfDimensions.z();
+
+    #pragma omp parallel for
+    for( int64_t z = 0; z < depth; ++z )
+        for( size_t y = 0; y < halfDimensions.y(); ++y )
+            for( size_t x = 0; x < halfDimensions.x(); ++x )
+            {
+                size_t sum = 0;
+                for( size_t i = 0; i < 8; ++i )
+                {
+                    const size_t sx = std::min( 2 * x + ( i & 1 ), size_t( dimensions.x() - 1 ));
+                    const size_t sy =
+                        std::min( 2 * y + (( i >> 1 ) & 1 ), size_t( dimensions.y() - 1 ));
+                    const size_t sz =
+                        std::min( 2 * z + (( i >> 2 ) & 1 ), size_t( dimensions.z() - 1 ));
+                    sum += src[( sz * dimensions.y() + sy ) * dimensions.x() + sx ];
+                }
+                dst[( z * halfDimensions.y() + y ) * halfDimensions.x() + x ] = ( sum + 4 ) / 8;
+            }
+}
+}
+
+namespace brayns
+{
+
+BrickedVolume::BrickedVolume(
+    const std::string& filename,
+    const Vector3ui& dimensions,
+    const size_t brickSize,
+    const std::string& cacheFolder )
+    : _filename( filename )
+    , _dimensions( dimensions )
+    , _brickSize( brickSize )
+    , _cacheFolder( cacheFolder )
+    , _data( nullptr )
+    , _memoryMapPtr( nullptr )
+    , _memoryMapSize( 0 )
+{
+    std::string cacheFilename;
+    if( !_cacheFolder.empty( ))
+    {
+        boost::system::error_code error;
+        boost::filesystem::create_directories( _cacheFolder, error );
+        cacheFilename = _getCacheFilename();
+        if( _map( cacheFilename ))
+            return;
+    }
+
+    if( !_convert( ) || cacheFilename.empty( ))
+        return;
+
+    // Once written, the cache file is mapped so that the OS can page the volume out
+    _write( cacheFilename );
+    if( _map( cacheFilename ))
+        std::vector< uint8_t >().swap( _storage );
+}
+
+BrickedVolume::~BrickedVolume()
+{
+    if( _memoryMapPtr )
+        ::munmap( _memoryMapPtr, _memoryMapSize );
+}
+
+const uint8_t* BrickedVolume::getData( const size_t level ) const
+{
+    return _data ? _data + _levels[level].offset : nullptr;
+}
+
+uint64_t BrickedVolume::getSize( const size_t level ) const
+{
+    return _levels[level].size;
+}
+
+Vector3ui BrickedVolume::getDimensions( const size_t level ) const
+{
+    const auto& dimensions = _levels[level].dimensions;
+    return Vector3ui( dimensions[0], dimensions[1], dimensions[2] );
+}
+
+std::string BrickedVolume::_getCacheFilename() const
+{
+    std::stringstream name;
+    name << std::hex << std::hash< std::string >()( _filename ) << std::dec
+         << "_" << _brickSize << ".bbv";
+    return ( boost::filesystem::path( _cacheFolder ) / name.str( )).string();
+}
+
+bool BrickedVolume::_map( const std::string& cacheFilename )
+{
+    // The cache file is ignored if the volume was modified since then
+    boost::system::error_code error;
+    const std::time_t cacheTime = boost::filesystem::last_write_time( cacheFilename, error );
+    if( error )
+        return false;
+    const std::time_t volumeTime = boost::filesystem::last_write_time( _filename, error );
+    if( !error && volumeTime > cacheTime )
+        return false;
+
+    const int fd = ::open( cacheFilename.c_str(), O_RDONLY );
+    if( fd == -1 )
+        return false;
+    struct stat sb;
+    if( ::fstat( fd, &sb ) == -1 )
+    {
+        ::close( fd );
+        return false;
+    }
+    const uint64_t size = sb.st_size;
+    void* ptr = ::mmap( 0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if( ptr == MAP_FAILED )
+        return false;
+
+    const char* bytes = static_cast< const char* >( ptr );
+    const BrickedVolumeHeader* header = static_cast< const BrickedVolumeHeader* >( ptr );
+    uint64_t offset = sizeof( BrickedVolumeHeader ) + sizeof( uint64_t );
+    bool valid = size >= offset &&
+        memcmp( header->magic, BRICKED_VOLUME_MAGIC, sizeof( header->magic )) == 0 &&
+        header->version == BRICKED_VOLUME_VERSION && header->brickSize == _brickSize &&
+        header->dimensions[0] == _dimensions.x() && header->dimensions[1] == _dimensions.y() &&
+        header->dimensions[2] == _dimensions.z();
+
+    // Different volumes can share the same cache file name
+    if( valid )
+    {
+        uint64_t nameLength;
+        memcpy( &nameLength, bytes + sizeof( BrickedVolumeHeader ), sizeof( nameLength ));
+        valid = size >= offset + nameLength &&
+                std::string( bytes + offset, nameLength ) == _filename;
+        offset += nameLength;
+    }
+
+    std::vector< BrickedVolumeLevel > levels;
+    if( valid )
+    {
+        valid = size >= offset + header->nbLevels * sizeof( BrickedVolumeLevel );
+        if( valid )
+        {
+            levels.resize( header->nbLevels );
+            memcpy( levels.data(), bytes + offset, levels.size() * sizeof( BrickedVolumeLevel ));
+            offset += levels.size() * sizeof( BrickedVolumeLevel );
+        }
+        for( const auto& level: levels )
+            valid = valid && size >= offset + level.offset + level.size;
+    }
+
+    if( !valid || levels.empty( ))
+    {
+        BRAYNS_WARN << "Ignoring invalid bricked volume " << cacheFilename << std::endl;
+        ::munmap( ptr, size );
+        return false;
+    }
+
+    if( _memoryMapPtr )
+        ::munmap( _memoryMapPtr, _memoryMapSize );
+    _memoryMapPtr = ptr;
+    _memoryMapSize = size;
+    _levels = levels;
+    _data = reinterpret_cast< const uint8_t* >( bytes + offset );
+    BRAYNS_INFO << "Bricked volume mapped from " << cacheFilename << std::endl;
+    return true;
+}
+
+bool BrickedVolume::_convert()
+{
+    const uint64_t volumeSize = uint64_t( _dimensions.x( )) * _dimensions.y() * _dimensions.z();
+    if( volumeSize == 0 || _brickSize == 0 )
+        return false;
+
+    const int fd = ::open( _filename.c_str(), O_RDONLY );
+    if( fd == -1 )
+    {
+        BRAYNS_ERROR << "Failed to open " << _filename << std::endl;
+        return false;
+    }
+    struct stat sb;
+    if( ::fstat( fd, &sb ) == -1 || uint64_t( sb.st_size ) < volumeSize )
+    {
+        BRAYNS_ERROR << _filename << " does not match the volume dimensions" << std::endl;
+        ::close( fd );
+        return false;
+    }
+    void* ptr = ::mmap( 0, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if( ptr == MAP_FAILED )
+    {
+        BRAYNS_ERROR << "Failed to attach " << _filename << std::endl;
+        return false;
+    }
+
+    // Levels down to the one fitting in a single brick
+    _levels.clear();
+    Vector3ui dimensions = _dimensions;
+    uint64_t offset = 0;
+    while( true )
+    {
+        const Vector3ui nbBricks = getNbBricks( dimensions, _brickSize );
+        BrickedVolumeLevel level;
+        level.offset = offset;
+        level.size = uint64_t( nbBricks.x( )) * nbBricks.y() * nbBricks.z() *
+                     _brickSize * _brickSize * _brickSize;
+        level.dimensions[0] = dimensions.x();
+        level.dimensions[1] = dimensions.y();
+        level.dimensions[2] = dimensions.z();
+        _levels.push_back( level );
+        offset += level.size;
+
+        if( dimensions.find_max() <= _brickSize )
+            break;
+        dimensions = Vector3ui( std::max( 1u, ( dimensions.x() + 1 ) / 2 ),
+                                std::max( 1u, ( dimensions.y() + 1 ) / 2 ),
+                                std::max( 1u, ( dimensions.z() + 1 ) / 2 ));
+    }
+
+    BRAYNS_INFO << "Converting " << _filename << " to " << _brickSize << "^3 bricks, "
+                << _levels.size() << " levels" << std::endl;
+    _storage.resize( offset );
+
+    std::vector< uint8_t > linear;
+    const uint8_t* source = static_cast< const uint8_t* >( ptr );
+    for( size_t i = 0; i < _levels.size(); ++i )
+    {
+        const Vector3ui levelDimensions = getDimensions( i );
+        if( i > 0 )
+        {
+            // Each level is computed from the previous one
+            const Vector3ui previousDimensions = getDimensions( i - 1 );
+            std::vector< uint8_t > half(
+                size_t( levelDimensions.x( )) * levelDimensions.y() * levelDimensions.z( ));
+            downsample( source, previousDimensions, half.data(), levelDimensions );
+            linear.swap( half );
+            source = linear.data();
+        }
+        brick( source, levelDimensions, _brickSize, _storage.data() + _levels[i].offset );
+    }
+
+    ::munmap( ptr, sb.st_size );
+    _data = _storage.data();
+    return true;
+}
+
+void BrickedVolume::_write( const std::string& cacheFilename ) const
+{
+    // Written to a temporary file first, so that other processes never read
+    // a partially written cache file
+    const std::string temporaryFilename = cacheFilename + "." +
+        boost::filesystem::unique_path().string();
+    {
+        std::ofstream file( temporaryFilename, std::ios::out | std::ios::binary );
+        if( !file.good( ))
+        {
+            BRAYNS_WARN << "Failed to create bricked volume " << cacheFilename << std::endl;
+            return;
+        }
+
+        BrickedVolumeHeader header;
+        memcpy( header.magic, BRICKED_VOLUME_MAGIC, sizeof( header.magic ));
+        header.version = BRICKED_VOLUME_VERSION;
+        header.brickSize = _brickSize;
+        header.nbLevels = _levels.size();
+        header.dimensions[0] = _dimensions.x();
+        header.dimensions[1] = _dimensions.y();
+        header.dimensions[2] = _dimensions.z();
+        const uint64_t nameLength = _filename.size();
+
+        file.write( reinterpret_cast< const char* >( &header ), sizeof( header ));
+        file.write( reinterpret_cast< const char* >( &nameLength ), sizeof( nameLength ));
+        file.write( _filename.data(), nameLength );
+        file.write( reinterpret_cast< const char* >( _levels.data( )),
+                    _levels.size() * sizeof( BrickedVolumeLevel ));
+        file.write( reinterpret_cast< const char* >( _storage.data( )), _storage.size( ));
+        if( !file.good( ))
+        {
+            BRAYNS_WARN << "Failed to write bricked volume " << cacheFilename << std::endl;
+            file.close();
+            boost::system::error_code error;
+            boost::filesystem::remove( temporaryFilename, error );
+            return;
+        }
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::rename( temporaryFilename, cacheFilename, error );
+    if( error )
+    {
+        BRAYNS_WARN << "Failed to write bricked volume " << cacheFilename
+                    << ": " << error.message() << std::endl;
+        boost::filesystem::remove( temporaryFilename, error );
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef BRICKEDVOLUME_H
+#define BRICKEDVOLUME_H
+
+#include <brayns/common/types.h>
+
+namespace brayns
+{
+
+/** Header of the bricked volume cache files */
+struct BrickedVolumeHeader
+{
+    char magic[8];
+    uint64_t version;
+    uint64_t brickSize;
+    uint64_t nbLevels;
+    uint64_t dimensions[3];
+};
+
+/** Resolution level of a bricked volume. The offset is in bytes, from the start of the data */
+struct BrickedVolumeLevel
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t dimensions[3];
+};
+
+/**
+   BrickedVolume object
+
+   Copy of a raw 8bit volume where voxels are grouped in cubic bricks of brickSize^3 voxels, so
+   that neighbouring voxels are close in memory whatever the direction of the rays. Bricks are
+   ordered along x, then y, then z, and so are voxels within a brick. Voxels of the bricks that
+   exceed the volume repeat the voxels on its border.
+
+   The volume is stored at several resolution levels, each level being half the size of the
+   previous one, until the volume fits in a single brick. Voxels of a level are the average of
+   the 2x2x2 voxels of the previous level.
+
+   The conversion is done once: if a cache folder is specified, bricked volumes are stored there
+   (header, volume filename, levels, then data) and memory mapped by the next runs, as long as the raw volume is
+   not modified.
+ */
+class BrickedVolume
+{
+public:
+
+    /**
+     * @brief Creates the bricked copy of a volume, or maps it from the cache folder
+     * @param filename File containing the raw 8bit volume
+     * @param dimensions Dimensions of the volume
+     * @param brickSize Size of the bricks, a power of two
+     * @param cacheFolder Folder where bricked volumes are cached. Bricked volumes are only
+     *        kept in memory if empty.
+     */
+    BrickedVolume(
+        const std::string& filename,
+        const Vector3ui& dimensions,
+        size_t brickSize,
+        const std::string& cacheFolder );
+
+    ~BrickedVolume();
+
+    /** @return True if the bricked volume is available */
+    bool isValid() const { return _data != nullptr; }
+
+    size_t getBrickSize() const { return _brickSize; }
+    size_t getNbLevels() const { return _levels.size(); }
+
+    /** @return the bricks of the given level */
+    const uint8_t* getData( size_t level ) const;
+
+    /** @return the size of the given level in bytes, padding of the bricks included */
+    uint64_t getSize( size_t level ) const;
+
+    /** @return the dimensions of the given level in voxels */
+    Vector3ui getDimensions( size_t level ) const;
+
+private:
+
+    std::string _getCacheFilename() const;
+    bool _map( const std::string& cacheFilename );
+    bool _convert();
+    void _write( const std::string& cacheFilename ) const;
+
+    std::string _filename;
+    Vector3ui _dimensions;
+    size_t _brickSize;
+    std::string _cacheFolder;
+
+    std::vector< BrickedVolumeLevel > _levels;
+    const uint8_t* _data;
+    std::vector< uint8_t > _storage;
+    void* _memoryMapPtr;
+    uint64_t _memoryMapSize;
+};
+
+}
+
+#endif // BRICKEDVOLUME_H
@@ -21,6 +21,7 @@
 #include "VolumeHandler.h"
 
 #include <brayns/common/log.h>
+#include <brayns/common/volume/BrickedVolume.h>
 #include <brayns/parameters/VolumeParameters.h>
 
 #include <fstream>
@@ -31,6 +32,7 @@
 namespace
 {
 const int NO_DESCRIPTOR = -1;
+const size_t DEFAULT_MACRO_CELL_SIZE = 16;
 }
 
 namespace brayns
@@ -58,7 +60,9 @@ void VolumeHandler::attachVolumeToFile( const float timestamp, const std::string
         volumeFile,
         _volumeParameters->getDimensions(),
         _volumeParameters->getElementSpacing(),
-        _volumeParameters->getOffset()));
+        _volumeParameters->getOffset(),
+        _volumeParameters->getBrickSize(),
+        _volumeParameters->getCacheFolder()));
 
     // Update timestamp range
     for( const auto& volumeDescriptor: _volumeDescriptors )
@@ -80,14 +84,150 @@ void VolumeHandler::setTimestamp( const float timestamp )
             _volumeDescriptors[ _timestamp ]->unmap();
         _timestamp = ts;
         _volumeDescriptors[ _timestamp ]->map();
+        _macroCells.clear();
+        _macroCellsData = nullptr;
     }
 }
 
 void* VolumeHandler::getData() const
 {
-    if( _volumeDescriptors.find( _timestamp ) != _volumeDescriptors.end( ))
-        return _volumeDescriptors.at( _timestamp )->getMemoryMapPtr();
-    return nullptr;
+    if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
+        return nullptr;
+    const auto& volumeDescriptor = _volumeDescriptors.at( _timestamp );
+    const BrickedVolumePtr brickedVolume = volumeDescriptor->getBrickedVolume();
+    if( brickedVolume )
+        return const_cast< uint8_t* >( brickedVolume->getData( getLevel( )));
+    return volumeDescriptor->getMemoryMapPtr();
+}
+
+size_t VolumeHandler::getBrickSize() const
+{
+    if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
+        return 0;
+    const BrickedVolumePtr brickedVolume =
+        _volumeDescriptors.at( _timestamp )->getBrickedVolume();
+    return brickedVolume ? brickedVolume->getBrickSize() : 0;
+}
+
+size_t VolumeHandler::getLevel() const
+{
+    if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
+        return 0;
+    const BrickedVolumePtr brickedVolume =
+        _volumeDescriptors.at( _timestamp )->getBrickedVolume();
+    if( !brickedVolume )
+        return 0;
+    return std::min( _volumeParameters->getLevel(), brickedVolume->getNbLevels() - 1 );
+}
+
+const Vector3ui VolumeHandler::getLevelDimensions() const
+{
+    if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
+        return Vector3ui();
+    const auto& volumeDescriptor = _volumeDescriptors.at( _timestamp );
+    const BrickedVolumePtr brickedVolume = volumeDescriptor->getBrickedVolume();
+    if( brickedVolume )
+        return brickedVolume->getDimensions( getLevel( ));
+    return volumeDescriptor->getDimensions();
+}
+
+size_t VolumeHandler::getMacroCellSize() const
+{
+    const size_t brickSize = getBrickSize();
+    return brickSize > 0 ? brickSize : DEFAULT_MACRO_CELL_SIZE;
+}
+
+const Vector3ui VolumeHandler::getNbMacroCells() const
+{
+    const Vector3ui dimensions = getLevelDimensions();
+    const size_t cellSize = getMacroCellSize();
+    return Vector3ui(
+        ( dimensions.x() + cellSize - 1 ) / cellSize,
+        ( dimensions.y() + cellSize - 1 ) / cellSize,
+        ( dimensions.z() + cellSize - 1 ) / cellSize );
+}
+
+size_t VolumeHandler::getMacroCellMargin() const
+{
+    return _volumeParameters->getGradientShading() ? 2 : 1;
+}
+
+const uint8_ts& VolumeHandler::getMacroCells()
+{
+    const uint8_t* data = static_cast< const uint8_t* >( getData( ));
+    const size_t margin = getMacroCellMargin();
+    if( data == _macroCellsData && margin == _macroCellsMargin )
+        return _macroCells;
+
+    _macroCells.clear();
+    _macroCellsData = data;
+    _macroCellsMargin = margin;
+    if( !data )
+        return _macroCells;
+
+    const Vector3ui dimensions = getLevelDimensions();
+    const uint64_t volumeSize = uint64_t( dimensions.x( )) * dimensions.y() * dimensions.z();
+    const size_t brickSize = getBrickSize();
+    if( brickSize == 0 && getSize() < volumeSize )
+        return _macroCells;
+
+    const size_t cellSize = getMacroCellSize();
+    const Vector3ui nbCells = getNbMacroCells();
+    const int64_t totalCells = int64_t( nbCells.x( )) * nbCells.y() * nbCells.z();
+    _macroCells.resize( 2 * totalCells );
+
+    // Bricked volumes store the voxels of each brick contiguously, the macro cells being the
+    // bricks. A row of voxels of a cell, margin included, may then span several bricks
+    const uint64_t brickVoxels = uint64_t( cellSize ) * cellSize * cellSize;
+    const auto getVoxelIndex = [&]( const size_t x, const size_t y, const size_t z ) -> uint64_t
+    {
+        if( brickSize == 0 )
+            return ( uint64_t( z ) * dimensions.y() + y ) * dimensions.x() + x;
+        const uint64_t brick = x / brickSize + ( y / brickSize ) * nbCells.x() +
+            uint64_t( z / brickSize ) * nbCells.x() * nbCells.y();
+        return brick * brickVoxels +
+            (( z % brickSize ) * brickSize + y % brickSize ) * brickSize + x % brickSize;
+    };
+
+    #pragma omp parallel for schedule( dynamic )
+    for( int64_t i = 0; i < totalCells; ++i )
+    {
+        const size_t cellX = ( i % nbCells.x( )) * cellSize;
+        const size_t cellY = (( i / nbCells.x( )) % nbCells.y( )) * cellSize;
+        const size_t cellZ = ( i / ( size_t( nbCells.x( )) * nbCells.y( ))) * cellSize;
+        const size_t x0 = cellX > margin ? cellX - margin : 0;
+        const size_t y0 = cellY > margin ? cellY - margin : 0;
+        const size_t z0 = cellZ > margin ? cellZ - margin : 0;
+        const size_t x1 = std::min( cellX + cellSize + margin, size_t( dimensions.x( )));
+        const size_t y1 = std::min( cellY + cellSize + margin, size_t( dimensions.y( )));
+        const size_t z1 = std::min( cellZ + cellSize + margin, size_t( dimensions.z( )));
+
+        uint8_t minValue = std::numeric_limits< uint8_t >::max();
+        uint8_t maxValue = 0;
+        for( size_t z = z0; z < z1; ++z )
+            for( size_t y = y0; y < y1; ++y )
+            {
+                if( brickSize == 0 )
+                {
+                    const uint8_t* row = data + getVoxelIndex( 0, y, z );
+                    for( size_t x = x0; x < x1; ++x )
+                    {
+                        minValue = std::min( minValue, row[x] );
+                        maxValue = std::max( maxValue, row[x] );
+                    }
+                    continue;
+                }
+                for( size_t x = x0; x < x1; ++x )
+                {
+                    const uint8_t value = data[ getVoxelIndex( x, y, z )];
+                    minValue = std::min( minValue, value );
+                    maxValue = std::max( maxValue, value );
+                }
+            }
+        _macroCells[ 2 * i ] = minValue;
+        _macroCells[ 2 * i + 1 ] = maxValue;
+    }
+    return _macroCells;
 }
 
 float VolumeHandler::getEpsilon(
@@ -97,7 +237,8 @@ float VolumeHandler::getEpsilon(
     if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
         return 0.f;
     const Vector3f diag = _volumeDescriptors.at( _timestamp )->getDimensions( ) * elementSpacing;
-    return diag.find_max() / float( samplesPerRay );
+    // Coarser levels need proportionally fewer samples
+    return diag.find_max() * float( 1 << getLevel( )) / float( samplesPerRay );
 }
 
 const Vector3ui VolumeHandler::getDimensions() const
@@ -123,9 +264,13 @@ const Vector3f VolumeHandler::getOffset() const
 
 uint64_t VolumeHandler::getSize() const
 {
-    if( _volumeDescriptors.find( _timestamp ) != _volumeDescriptors.end( ))
-        return _volumeDescriptors.at( _timestamp )->getSize();
-    return 0;
+    if( _volumeDescriptors.find( _timestamp ) == _volumeDescriptors.end( ))
+        return 0;
+    const auto& volumeDescriptor = _volumeDescriptors.at( _timestamp );
+    const BrickedVolumePtr brickedVolume = volumeDescriptor->getBrickedVolume();
+    if( brickedVolume )
+        return brickedVolume->getSize( getLevel( ));
+    return volumeDescriptor->getSize();
 }
 
 float VolumeHandler::_getBoundedTimestamp( const float timestamp ) const
@@ -150,13 +295,18 @@ VolumeHandler::VolumeDescriptor::VolumeDescriptor(
     const std::string& filename,
     const Vector3ui& dimensions,
     const Vector3f& elementSpacing,
-    const Vector3f& offset )
+    const Vector3f& offset,
+    const size_t brickSize,
+    const std::string& cacheFolder )
     : _filename( filename )
     , _memoryMapPtr( 0 )
     , _cacheFileDescriptor( NO_DESCRIPTOR )
+    , _size( 0 )
     , _dimensions( dimensions )
     , _elementSpacing( elementSpacing )
     , _offset( offset )
+    , _brickSize( brickSize )
+    , _cacheFolder( cacheFolder )
 {
 }
 
@@ -167,6 +317,16 @@ VolumeHandler::VolumeDescriptor::~VolumeDescriptor()
 
 void VolumeHandler::VolumeDescriptor::map()
 {
+    if( _brickSize > 0 )
+    {
+        _brickedVolume.reset( new BrickedVolume(
+            _filename, _dimensions, _brickSize, _cacheFolder ));
+        if( _brickedVolume->isValid( ))
+            return;
+        BRAYNS_WARN << "Using the raw layout of " << _filename << std::endl;
+        _brickedVolume.reset();
+    }
+
     _cacheFileDescriptor = open( _filename.c_str(), O_RDONLY );
     if( _cacheFileDescriptor == NO_DESCRIPTOR )
     {
@@ -195,6 +355,7 @@ void VolumeHandler::VolumeDescriptor::map()
 
 void VolumeHandler::VolumeDescriptor::unmap()
 {
+    _brickedVolume.reset();
     if( _memoryMapPtr )
     {
         ::munmap( (void*)_memoryMapPtr, _size );
@@ -74,16 +74,66 @@ public:
 
     /**
      * @brief Returns the size of the 8bit volume in bytes
-     * @return Size of the volume for the specified timestamp
+     * @return Size of the volume for the specified timestamp, at the current resolution level
      */
     uint64_t getSize() const;
 
     /**
      * @brief Returns a pointer to a given frame in the memory mapped file.
-     * @return Pointer to volume
+     * @return Pointer to volume, at the current resolution level
      */
     void* getData() const;
 
+    /**
+     * @brief Returns the size of the bricks of the current volume
+     * @return Size of the bricks, or 0 if the volume is stored in its raw layout
+     */
+    size_t getBrickSize() const;
+
+    /**
+     * @brief Returns the resolution level of the current volume, as requested by the volume
+     *        parameters and bounded by the number of levels of the volume
+     * @return Resolution level, 0 being the full resolution
+     */
+    size_t getLevel() const;
+
+    /**
+     * @brief Returns the dimensions of the current volume at the current resolution level
+     * @return Dimensions of the volume level
+     */
+    const Vector3ui getLevelDimensions() const;
+
+    /**
+     * @brief Returns the size of the macro cells of the current volume. Macro cells match the
+     *        bricks of bricked volumes
+     * @return Size of the macro cells in voxels, a power of two
+     */
+    size_t getMacroCellSize() const;
+
+    /**
+     * @brief Returns the number of macro cells of the current volume, at the current resolution
+     *        level
+     * @return Number of macro cells along each axis
+     */
+    const Vector3ui getNbMacroCells() const;
+
+    /**
+     * @brief Returns the number of voxels by which the macro cells are widened on every side.
+     *        Samples are interpolated from the neighbouring voxels, and gradients from the
+     *        neighbours of these.
+     * @return 2 if gradient shading is enabled, 1 otherwise
+     */
+    size_t getMacroCellMargin() const;
+
+    /**
+     * @brief Returns the minimum and maximum voxel values of each macro cell of the current
+     *        volume, at the current resolution level, including the voxels of the margin of
+     *        the cell. Macro cells are ordered along x, then y, then z. The values are computed
+     *        the first time they are requested for a given volume, level and margin.
+     * @return Minimum and maximum values, two per macro cell
+     */
+    const uint8_ts& getMacroCells();
+
     /**
      * @brief Returns the epsilon that defines the step used to walk along the ray when traversing
      *        the volume. The value is defined according to the dimensions and scaling of the
@@ -152,11 +202,14 @@ public:
             const std::string& filename,
             const Vector3ui& dimensions,
             const Vector3f& elementSpacing,
-            const Vector3f& offset );
+            const Vector3f& offset,
+            size_t brickSize,
+            const std::string& cacheFolder );
         ~VolumeDescriptor();
 
         /**
-         * @brief Maps the volume to the corresponding _filename
+         * @brief Maps the volume to the corresponding _filename. If a brick size is specified,
+         *        the bricked copy of the volume is mapped instead, and created if needed
          */
         void map();
 
@@ -207,6 +260,12 @@ public:
          */
         const std::string& getFilename() const { return _filename; }
 
+        /**
+         * @brief Returns the bricked copy of the volume
+         * @return Bricked volume, or nullptr if the volume is used in its raw layout
+         */
+        BrickedVolumePtr getBrickedVolume() const { return _brickedVolume; }
+
     private:
 
         std::string _filename;
@@ -216,6 +275,9 @@ public:
         Vector3ui _dimensions;
         Vector3f _elementSpacing;
         Vector3f _offset;
+        size_t _brickSize;
+        std::string _cacheFolder;
+        BrickedVolumePtr _brickedVolume;
 
     };
     typedef std::shared_ptr< VolumeDescriptor > VolumeDescriptorPtr;
@@ -231,6 +293,9 @@ private:
     TimestampMode _timestampMode;
     Histogram _histogram;
     uint64_t _nbFrames = 0;
+    uint8_ts _macroCells;
+    const void* _macroCellsData = nullptr;
+    size_t _macroCellsMargin = 0;
 };
 
 }
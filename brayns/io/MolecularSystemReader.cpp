@@ -67,50 +67,67 @@ bool MolecularSystemReader::_createScene( Scene& scene )
         break;
     }
 
+    // Every protein is loaded once, and placed at all its positions by
+    // instancing
     MeshLoader meshLoader;
-    uint64_t proteinCount = 0;
+    const size_t nbMaterials = scene.getMaterials().size();
+    uint64_t proteinIndex = 0;
     for( const auto& proteinPosition: _proteinPositions )
     {
-        BRAYNS_PROGRESS( proteinCount, _nbProteins );
+        BRAYNS_PROGRESS( proteinIndex, _proteinPositions.size( ));
 
         const auto& protein = _proteins.find( proteinPosition.first );
+        InstancedGeometry instancedGeometry;
         if( !_proteinFolder.empty( ))
-            // Load PDB files
-            for( const auto& position: proteinPosition.second )
-            {
-                const auto pdbFilename = _proteinFolder + '/' + protein->second + ".pdb";
-                ProteinLoader loader( _geometryParameters );
-                loader.importPDBFile( pdbFilename, position, proteinCount, scene );
-                ++proteinCount;
-            }
+        {
+            // Load PDB file
+            const auto pdbFilename = _proteinFolder + '/' + protein->second + ".pdb";
+            ProteinLoader loader( _geometryParameters );
+            loader.importPDBFile( pdbFilename, proteinIndex, nbMaterials,
+                instancedGeometry.getPrimitives(), instancedGeometry.getBounds( ));
+        }
 
         if( !_meshFolder.empty( ))
-            // Load meshes
-            for( const auto& position: proteinPosition.second )
+        {
+            // Load mesh
+            const auto objFilename = _meshFolder + '/' + protein->second + ".obj";
+            MeshContainer MeshContainer =
             {
-                const auto objFilename = _meshFolder + '/' + protein->second + ".obj";
-                MeshContainer MeshContainer =
-                {
-                    scene.getTriangleMeshes(),
-                    scene.getMaterials(),
-                    scene.getWorldBounds()
-                };
-
-                const size_t material =
-                    _geometryParameters.getColorScheme() == ColorScheme::protein_by_id ?
-                    proteinCount % (NB_MAX_MATERIALS - NB_SYSTEM_MATERIALS) :
-                    NO_MATERIAL;
-
-                // Scale mesh to match PDB units. PDB are in angstrom, and positions are
-                // in micrometers
-                const float scale = 0.0001f;
-                meshLoader.importMeshFromFile(
-                    objFilename, MeshContainer, quality,
-                    position, Vector3f( scale, scale, scale ), material );
-
-                if( _proteinFolder.empty( ))
-                    ++proteinCount;
-            }
+                instancedGeometry.getTrianglesMeshes(),
+                scene.getMaterials(),
+                instancedGeometry.getBounds()
+            };
+
+            const size_t material =
+                _geometryParameters.getColorScheme() == ColorScheme::protein_by_id ?
+                proteinIndex % (NB_MAX_MATERIALS - NB_SYSTEM_MATERIALS) :
+                NO_MATERIAL;
+
+            // Scale mesh to match PDB units. PDB are in angstrom, and positions are
+            // in micrometers
+            const float scale = 0.0001f;
+            meshLoader.importMeshFromFile(
+                objFilename, MeshContainer, quality,
+                Vector3f( 0.f, 0.f, 0.f ), Vector3f( scale, scale, scale ),
+                material );
+        }
+
+        for( const auto& position: proteinPosition.second )
+        {
+            Matrix4f transform;
+            transform.setColumn( 3, Vector4f(
+                position.x(), position.y(), position.z(), 1.f ));
+            instancedGeometry.addInstance( transform );
+        }
+
+        const Boxf bounds = instancedGeometry.getInstancesBounds();
+        if( !bounds.isEmpty( ))
+        {
+            scene.getWorldBounds().merge( bounds );
+            scene.getInstancedGeometries().push_back(
+                std::move( instancedGeometry ));
+        }
+        ++proteinIndex;
     }
 
     // Update materials
@@ -0,0 +1,269 @@
+/* Copyright (c) 2015-2016, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MorphologyCache.h"
+
+#include <brayns/common/log.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+const char MORPHOLOGY_CACHE_MAGIC[8] = { 'B','R','A','Y','N','S','M','C' };
+const uint64_t MORPHOLOGY_CACHE_VERSION = 1;
+
+template< typename T >
+void writeValue( std::ofstream& file, const T& value )
+{
+    file.write( reinterpret_cast< const char* >( &value ), sizeof( T ));
+}
+
+template< typename T >
+void writeVector( std::ofstream& file, const std::vector< T >& values )
+{
+    writeValue( file, uint64_t( values.size( )));
+    file.write( reinterpret_cast< const char* >( values.data( )),
+                values.size() * sizeof( T ));
+}
+
+template< typename T >
+bool readValue( std::ifstream& file, T& value )
+{
+    file.read( reinterpret_cast< char* >( &value ), sizeof( T ));
+    return file.good();
+}
+
+template< typename T >
+bool readVector( std::ifstream& file, std::vector< T >& values )
+{
+    uint64_t size;
+    if( !readValue( file, size ))
+        return false;
+    values.resize( size );
+    file.read( reinterpret_cast< char* >( values.data( )), size * sizeof( T ));
+    return file.good();
+}
+}
+
+namespace brayns
+{
+
+MorphologyCache::MorphologyCache( const std::string& folder )
+    : _folder( folder )
+{
+    if( _folder.empty( ))
+        return;
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories( _folder, error );
+    if( error )
+        BRAYNS_WARN << "Failed to create morphology cache folder " << _folder
+                    << ": " << error.message() << std::endl;
+}
+
+CachedMorphologyPtr MorphologyCache::get(
+    const std::string& filename,
+    const LoadFunc& load )
+{
+    std::promise< CachedMorphologyPtr > promise;
+    std::shared_future< CachedMorphologyPtr > morphology;
+    bool loading = false;
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        const auto it = _morphologies.find( filename );
+        if( it == _morphologies.end( ))
+        {
+            morphology = promise.get_future().share();
+            _morphologies[filename] = morphology;
+            loading = true;
+        }
+        else
+            morphology = it->second;
+    }
+
+    if( loading )
+    {
+        try
+        {
+            promise.set_value( _load( filename, load ));
+        }
+        catch( ... )
+        {
+            promise.set_exception( std::current_exception( ));
+        }
+    }
+    return morphology.get();
+}
+
+CachedMorphologyPtr MorphologyCache::_load(
+    const std::string& filename,
+    const LoadFunc& load )
+{
+    if( _folder.empty( ))
+        return load();
+
+    CachedMorphologyPtr morphology = _read( filename );
+    if( !morphology )
+    {
+        morphology = load();
+        _write( filename, *morphology );
+    }
+    return morphology;
+}
+
+std::string MorphologyCache::_getCacheFilename(
+    const std::string& filename ) const
+{
+    std::stringstream name;
+    name << std::hex << std::hash< std::string >()( filename ) << ".bmc";
+    return ( boost::filesystem::path( _folder ) / name.str( )).string();
+}
+
+CachedMorphologyPtr MorphologyCache::_read( const std::string& filename ) const
+{
+    const std::string cacheFilename = _getCacheFilename( filename );
+
+    // The cache file is ignored if the morphology was modified since then
+    boost::system::error_code error;
+    const std::time_t cacheTime =
+        boost::filesystem::last_write_time( cacheFilename, error );
+    if( error )
+        return CachedMorphologyPtr();
+    const std::time_t morphologyTime =
+        boost::filesystem::last_write_time( filename, error );
+    if( !error && morphologyTime > cacheTime )
+        return CachedMorphologyPtr();
+
+    std::ifstream file( cacheFilename, std::ios::in | std::ios::binary );
+    if( !file.good( ))
+        return CachedMorphologyPtr();
+
+    char magic[8];
+    uint64_t version;
+    std::string source;
+    file.read( magic, sizeof( magic ));
+    if( !file.good() ||
+        memcmp( magic, MORPHOLOGY_CACHE_MAGIC, sizeof( magic )) != 0 ||
+        !readValue( file, version ) || version != MORPHOLOGY_CACHE_VERSION )
+    {
+        BRAYNS_WARN << "Ignoring invalid morphology cache file "
+                    << cacheFilename << std::endl;
+        return CachedMorphologyPtr();
+    }
+
+    // Different morphologies can share the same cache file name
+    std::vector< char > sourceChars;
+    if( !readVector( file, sourceChars ) ||
+        std::string( sourceChars.begin(), sourceChars.end( )) != filename )
+    {
+        return CachedMorphologyPtr();
+    }
+
+    std::shared_ptr< CachedMorphology > morphology( new CachedMorphology );
+    uint64_t nbSections;
+    if( !readValue( file, morphology->somaCentroid ) ||
+        !readValue( file, morphology->somaMeanRadius ) ||
+        !readVector( file, morphology->somaPoints ) ||
+        !readValue( file, nbSections ))
+    {
+        BRAYNS_WARN << "Ignoring truncated morphology cache file "
+                    << cacheFilename << std::endl;
+        return CachedMorphologyPtr();
+    }
+
+    morphology->sections.resize( nbSections );
+    for( auto& section: morphology->sections )
+    {
+        uint64_t type;
+        if( !readValue( file, type ) ||
+            !readValue( file, section.distanceToSoma ) ||
+            !readVector( file, section.samples ) ||
+            !readVector( file, section.sampleDistancesToSoma ))
+        {
+            BRAYNS_WARN << "Ignoring truncated morphology cache file "
+                        << cacheFilename << std::endl;
+            return CachedMorphologyPtr();
+        }
+        section.type = type;
+    }
+    return morphology;
+}
+
+void MorphologyCache::_write(
+    const std::string& filename,
+    const CachedMorphology& morphology ) const
+{
+    // Written to a temporary file first, so that other processes never read
+    // a partially written cache file
+    const std::string cacheFilename = _getCacheFilename( filename );
+    const std::string temporaryFilename = cacheFilename + "." +
+        boost::filesystem::unique_path().string();
+    {
+        std::ofstream file( temporaryFilename,
+                            std::ios::out | std::ios::binary );
+        if( !file.good( ))
+        {
+            BRAYNS_WARN << "Failed to create morphology cache file "
+                        << cacheFilename << std::endl;
+            return;
+        }
+
+        file.write( MORPHOLOGY_CACHE_MAGIC, sizeof( MORPHOLOGY_CACHE_MAGIC ));
+        writeValue( file, MORPHOLOGY_CACHE_VERSION );
+        writeVector( file, std::vector< char >( filename.begin(),
+                                                filename.end( )));
+        writeValue( file, morphology.somaCentroid );
+        writeValue( file, morphology.somaMeanRadius );
+        writeVector( file, morphology.somaPoints );
+        writeValue( file, uint64_t( morphology.sections.size( )));
+        for( const auto& section: morphology.sections )
+        {
+            writeValue( file, uint64_t( section.type ));
+            writeValue( file, section.distanceToSoma );
+            writeVector( file, section.samples );
+            writeVector( file, section.sampleDistancesToSoma );
+        }
+        if( !file.good( ))
+        {
+            BRAYNS_WARN << "Failed to write morphology cache file "
+                        << cacheFilename << std::endl;
+            file.close();
+            boost::system::error_code error;
+            boost::filesystem::remove( temporaryFilename, error );
+            return;
+        }
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::rename( temporaryFilename, cacheFilename, error );
+    if( error )
+    {
+        BRAYNS_WARN << "Failed to write morphology cache file "
+                    << cacheFilename << ": " << error.message() << std::endl;
+        boost::filesystem::remove( temporaryFilename, error );
+    }
+}
+
+}
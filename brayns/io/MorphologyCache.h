@@ -0,0 +1,101 @@
+/* Copyright (c) 2015-2016, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MORPHOLOGY_CACHE_H
+#define MORPHOLOGY_CACHE_H
+
+#include <brayns/common/types.h>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace brayns
+{
+
+/** Neurite section of a morphology, in the space of the morphology */
+struct MorphologySection
+{
+    size_t type;
+    float distanceToSoma;
+    Vector4fs samples;
+    floats sampleDistancesToSoma;
+};
+
+/**
+ * Data needed to build the geometry of a morphology, in the space of the
+ * morphology. Cells sharing a morphology are built from the same data, which
+ * is only transformed to the position of every cell.
+ */
+struct CachedMorphology
+{
+    Vector3f somaCentroid;
+    float somaMeanRadius;
+    Vector3fs somaPoints;
+    std::vector< MorphologySection > sections;
+};
+typedef std::shared_ptr< const CachedMorphology > CachedMorphologyPtr;
+
+/**
+ * Keeps morphologies in memory, by file name, so that every morphology of a circuit
+ * is read only once, whatever the number of cells using it. Morphologies can
+ * also be persisted in a folder, and reused by the next runs as long as the
+ * original file is not modified. The cache can be used from several threads:
+ * a morphology requested by several threads at once is loaded by the first
+ * one, while the others wait for it.
+ */
+class MorphologyCache
+{
+public:
+    typedef std::function< CachedMorphologyPtr() > LoadFunc;
+
+    /**
+     * @param folder Folder where morphologies are persisted. Morphologies are
+     *        only kept in memory if empty.
+     */
+    explicit MorphologyCache( const std::string& folder );
+
+    /**
+     * @param filename File of the morphology
+     * @param load Function loading the morphology if it is neither in memory
+     *        nor in the cache folder
+     * @return The morphology
+     * @throw std::runtime_error if the morphology cannot be loaded
+     */
+    CachedMorphologyPtr get( const std::string& filename, const LoadFunc& load );
+
+private:
+    CachedMorphologyPtr _load( const std::string& filename, const LoadFunc& load );
+    std::string _getCacheFilename( const std::string& filename ) const;
+    CachedMorphologyPtr _read( const std::string& filename ) const;
+    void _write( const std::string& filename,
+                 const CachedMorphology& morphology ) const;
+
+    const std::string _folder;
+    std::mutex _mutex;
+    std::map< std::string, std::shared_future< CachedMorphologyPtr >>
+        _morphologies;
+};
+
+}
+
+#endif // MORPHOLOGY_CACHE_H
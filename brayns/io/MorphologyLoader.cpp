@@ -21,18 +21,220 @@
 #include "MorphologyLoader.h"
 
 #include <brayns/common/log.h>
-#include <brayns/common/geometry/Sphere.h>
-#include <brayns/common/geometry/Cylinder.h>
-#include <brayns/common/geometry/Cone.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/common/scene/Scene.h>
 #include <brayns/common/simulation/CircuitSimulationHandler.h>
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
 
 #ifdef BRAYNS_USE_BRION
 #  include <brain/brain.h>
 #  include <brion/brion.h>
+
+namespace
+{
+/** Reads a morphology, in the space of the morphology */
+brayns::CachedMorphologyPtr readMorphology( const servus::URI& source )
+{
+    const brain::neuron::Morphology morphology( source );
+    std::shared_ptr< brayns::CachedMorphology > cachedMorphology(
+        new brayns::CachedMorphology );
+
+    const brain::neuron::Soma& soma = morphology.getSoma();
+    cachedMorphology->somaCentroid = soma.getCentroid();
+    cachedMorphology->somaMeanRadius = soma.getMeanRadius();
+    for( const auto& point: soma.getProfilePoints( ))
+        cachedMorphology->somaPoints.push_back(
+            brayns::Vector3f( point.x(), point.y(), point.z( )));
+
+    const brain::neuron::SectionTypes sectionTypes = {
+        brain::neuron::SectionType::axon,
+        brain::neuron::SectionType::dendrite,
+        brain::neuron::SectionType::apicalDendrite };
+    for( const auto& section: morphology.getSections( sectionTypes ))
+        cachedMorphology->sections.push_back( {
+            size_t( section.getType( )),
+            section.getDistanceToSoma(),
+            section.getSamples(),
+            section.getSampleDistancesToSoma() });
+    return cachedMorphology;
+}
+
+/** @return the morphology section type flag of a brain section type */
+size_t getSectionTypeMask( const size_t sectionType )
+{
+    switch( brain::neuron::SectionType( sectionType ))
+    {
+    case brain::neuron::SectionType::soma:
+        return brayns::MST_SOMA;
+    case brain::neuron::SectionType::axon:
+        return brayns::MST_AXON;
+    case brain::neuron::SectionType::dendrite:
+        return brayns::MST_DENDRITE;
+    case brain::neuron::SectionType::apicalDendrite:
+        return brayns::MST_APICAL_DENDRITE;
+    default:
+        return brayns::MST_UNDEFINED;
+    }
+}
+
+typedef std::function< bool( size_t, brayns::PrimitivesMap&,
+                             brayns::PrimitivesGroups&, brayns::Boxf& )>
+    ImportMorphologyFunc;
+
+/** Geometry of a morphology, imported in its own storage */
+struct MorphologyGeometry
+{
+    brayns::PrimitivesMap primitives;
+    brayns::PrimitivesGroups groups;
+    brayns::Boxf bounds;
+};
+typedef std::vector< MorphologyGeometry > MorphologyGeometries;
+
+/** Position of the primitives of a morphology in the arrays of a material */
+struct PrimitivesOffsets
+{
+    size_t spheres;
+    size_t cylinders;
+    size_t cones;
+    size_t roundedCones;
+};
+typedef std::map< size_t, PrimitivesOffsets > PrimitivesOffsetsMap;
+
+template< typename T >
+void copyAt( const std::vector< T >& src, std::vector< T >& dst,
+             const size_t offset )
+{
+    std::copy( src.begin(), src.end(), dst.begin() + offset );
+}
+
+/**
+ * Moves the geometry of a batch of morphologies to the destination storage.
+ * A first pass counts the primitives of every morphology, computes where they
+ * go, and grows the destination arrays once per material. The morphologies
+ * are then copied in parallel, each of them to its own ranges of the arrays,
+ * which requires no synchronization and keeps the order of the morphologies.
+ */
+void mergeMorphologies(
+    const MorphologyGeometries& morphologies,
+    brayns::PrimitivesMap& dstPrimitives,
+    brayns::PrimitivesGroups& dstGroups,
+    brayns::Boxf& dstBounds )
+{
+    const size_t nbMorphologies = morphologies.size();
+    std::vector< PrimitivesOffsetsMap > offsets( nbMorphologies );
+    std::vector< size_t > groupOffsets( nbMorphologies );
+
+    PrimitivesOffsetsMap sizes;
+    size_t nbGroups = dstGroups.size();
+    for( size_t i = 0; i < nbMorphologies; ++i )
+    {
+        const MorphologyGeometry& morphology = morphologies[i];
+        for( const auto& p: morphology.primitives )
+        {
+            auto size = sizes.find( p.first );
+            if( size == sizes.end( ))
+            {
+                const brayns::Primitives& dst = dstPrimitives[p.first];
+                size = sizes.insert( { p.first, {
+                    dst.getSpheres().size(),
+                    dst.getCylinders().size(),
+                    dst.getCones().size(),
+                    dst.getRoundedCones().size() } } ).first;
+            }
+            offsets[i][p.first] = size->second;
+            size->second.spheres += p.second.getSpheres().size();
+            size->second.cylinders += p.second.getCylinders().size();
+            size->second.cones += p.second.getCones().size();
+            size->second.roundedCones += p.second.getRoundedCones().size();
+        }
+        groupOffsets[i] = nbGroups;
+        nbGroups += morphology.groups.size();
+        dstBounds.merge( morphology.bounds );
+    }
+
+    for( const auto& size: sizes )
+    {
+        brayns::Primitives& dst = dstPrimitives[size.first];
+        dst.getSpheres().resize( size.second.spheres );
+        dst.getCylinders().resize( size.second.cylinders );
+        dst.getCones().resize( size.second.cones );
+        dst.getRoundedCones().resize( size.second.roundedCones );
+    }
+    dstGroups.resize( nbGroups );
+
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t i = 0; i < nbMorphologies; ++i )
+    {
+        const MorphologyGeometry& morphology = morphologies[i];
+        const PrimitivesOffsetsMap& morphologyOffsets = offsets[i];
+        for( const auto& p: morphology.primitives )
+        {
+            const PrimitivesOffsets& offset = morphologyOffsets.at( p.first );
+            brayns::Primitives& dst = dstPrimitives.at( p.first );
+            copyAt( p.second.getSpheres(), dst.getSpheres(), offset.spheres );
+            copyAt( p.second.getCylinders(), dst.getCylinders(),
+                    offset.cylinders );
+            copyAt( p.second.getCones(), dst.getCones(), offset.cones );
+            copyAt( p.second.getRoundedCones(), dst.getRoundedCones(),
+                    offset.roundedCones );
+        }
+
+        size_t index = groupOffsets[i];
+        for( brayns::PrimitivesGroup group: morphology.groups )
+        {
+            const PrimitivesOffsets& offset =
+                morphologyOffsets.at( group.material );
+            group.firstSphere += offset.spheres;
+            group.firstCylinder += offset.cylinders;
+            group.firstCone += offset.cones;
+            group.firstRoundedCone += offset.roundedCones;
+            dstGroups[index++] = group;
+        }
+    }
+}
+
+/**
+ * Imports morphologies in parallel, by batches of batchSize morphologies. The
+ * geometry of a batch is added to the scene as soon as it is loaded, so that
+ * it can be rendered while the next batches are being loaded.
+ */
+void importInBatches(
+    const size_t nbMorphologies,
+    const size_t batchSize,
+    brayns::Scene& scene,
+    const ImportMorphologyFunc& importMorphology )
+{
+    size_t progress = 0;
+    for( size_t first = 0; first < nbMorphologies; first += batchSize )
+    {
+        const size_t last = std::min( first + batchSize, nbMorphologies );
+        MorphologyGeometries morphologies( last - first );
+
+        #pragma omp parallel for schedule( dynamic )
+        for( size_t i = first; i < last; ++i )
+        {
+            MorphologyGeometry& morphology = morphologies[i - first];
+            importMorphology( i, morphology.primitives, morphology.groups,
+                              morphology.bounds );
+
+            BRAYNS_PROGRESS( progress, nbMorphologies );
+            #pragma omp atomic
+            ++progress;
+        }
+
+        std::lock_guard< std::recursive_mutex > lock( scene.getDataMutex( ));
+        mergeMorphologies( morphologies, scene.getPrimitives(),
+                           scene.getPrimitivesGroups(), scene.getWorldBounds( ));
+        scene.markModified();
+        scene.setProgress( "Loading cells",
+                           float( last ) / float( nbMorphologies ));
+    }
+}
 #endif
 
 namespace brayns
@@ -41,6 +243,8 @@ namespace brayns
 MorphologyLoader::MorphologyLoader(
         const GeometryParameters& geometryParameters )
     : _geometryParameters(geometryParameters)
+    , _morphologyCache( new MorphologyCache(
+          geometryParameters.getMorphologyCacheFolder( )))
 {
 }
 
@@ -50,11 +254,36 @@ bool MorphologyLoader::importMorphology(
     const int morphologyIndex,
     Scene& scene)
 {
-    float maxDistanceToSoma;
     return _importMorphology(
         uri, morphologyIndex, Matrix4f(),
-        0, scene.getPrimitives(),
-        scene.getWorldBounds(), 0, maxDistanceToSoma);
+        0, scene.getPrimitives(), scene.getPrimitivesGroups(),
+        scene.getWorldBounds(), 0);
+}
+
+bool MorphologyLoader::importMorphologies(
+    const strings& files,
+    Scene& scene)
+{
+    bool success = true;
+    importInBatches( files.size(), _geometryParameters.getLoadingBatchSize(),
+        scene,
+        [&]( const size_t i, PrimitivesMap& primitives,
+             PrimitivesGroups& groups, Boxf& bounds )
+        {
+            if( _importMorphology(
+                servus::URI( files[i] ), i, Matrix4f(), 0, primitives, groups,
+                bounds, 0 ))
+            {
+                return true;
+            }
+            #pragma omp critical( morphologyErrors )
+            {
+                BRAYNS_ERROR << "Failed to import " << files[i] << std::endl;
+                success = false;
+            }
+            return false;
+        });
+    return success;
 }
 
 bool MorphologyLoader::_importMorphology(
@@ -63,17 +292,25 @@ bool MorphologyLoader::_importMorphology(
     const Matrix4f& transformation,
     const SimulationInformation* simulationInformation,
     PrimitivesMap& primitives,
+    PrimitivesGroups& groups,
     Boxf& bounds,
-    const size_t simulationOffset,
-    float& maxDistanceToSoma)
+    const size_t simulationOffset)
 {
-    maxDistanceToSoma = 0.f;
     try
     {
-        Vector3f translation = { 0.f, 0.f, 0.f };
+        const CachedMorphologyPtr morphology = _morphologyCache->get(
+            source.getPath(),
+            [&source]() { return readMorphology( source ); });
 
-        brain::neuron::Morphology morphology( source, transformation );
-        brain::neuron::SectionTypes sectionTypes;
+        // The morphology is transformed to the position of the cell
+        const auto transform = [&transformation]( const Vector4f& point )
+        {
+            const Vector4f p = transformation *
+                Vector4f( point.x(), point.y(), point.z(), 1.f );
+            return Vector3f( p.x(), p.y(), p.z( ));
+        };
+
+        Vector3f translation = { 0.f, 0.f, 0.f };
 
         const MorphologyLayout& layout =
             _geometryParameters.getMorphologyLayout();
@@ -81,12 +318,12 @@ bool MorphologyLoader::_importMorphology(
         if( layout.nbColumns != 0 )
         {
             Boxf morphologyAABB;
-            const brain::Vector4fs& points = morphology.getPoints();
-            for( Vector4f point: points )
-            {
-                const Vector3f p = { point.x(), point.y(), point.z() };
-                morphologyAABB.merge( p );
-            }
+            for( const Vector3f& point: morphology->somaPoints )
+                morphologyAABB.merge( transform(
+                    Vector4f( point.x(), point.y(), point.z(), 1.f )));
+            for( const auto& section: morphology->sections )
+                for( const Vector4f& sample: section.samples )
+                    morphologyAABB.merge( transform( sample ));
 
             const Vector3f positionInGrid =
             {
@@ -101,17 +338,10 @@ bool MorphologyLoader::_importMorphology(
 
         const size_t morphologySectionTypes =
             _geometryParameters.getMorphologySectionTypes();
-        if( morphologySectionTypes & MST_SOMA )
-            sectionTypes.push_back( brain::neuron::SectionType::soma );
-        if( morphologySectionTypes & MST_AXON )
-            sectionTypes.push_back( brain::neuron::SectionType::axon );
-        if( morphologySectionTypes & MST_DENDRITE )
-            sectionTypes.push_back( brain::neuron::SectionType::dendrite );
-        if( morphologySectionTypes & MST_APICAL_DENDRITE )
-            sectionTypes.push_back( brain::neuron::SectionType::apicalDendrite );
 
-        const brain::neuron::Sections& sections =
-            morphology.getSections( sectionTypes );
+        // Primitives are first collected per section type, and then assigned
+        // to the material defined by the color scheme
+        PrimitivesMap sectionPrimitives;
 
         size_t sectionId = 0;
 
@@ -125,32 +355,35 @@ bool MorphologyLoader::_importMorphology(
         if( morphologySectionTypes & MST_SOMA )
         {
             // Soma
-            const brain::neuron::Soma& soma = morphology.getSoma();
-            const size_t material =
-                _material( morphologyIndex,
-                           size_t( brain::neuron::SectionType::soma ));
-            const Vector3f& center = soma.getCentroid() + translation;
+            const size_t sectionType =
+                size_t( brain::neuron::SectionType::soma );
+            const Vector3f& somaCentroid = morphology->somaCentroid;
+            const Vector3f center = transform( Vector4f(
+                somaCentroid.x(), somaCentroid.y(), somaCentroid.z(), 1.f )) +
+                translation;
 
             const float radius =
                 ( _geometryParameters.getRadiusCorrection() != 0.f ?
                 _geometryParameters.getRadiusCorrection() :
-                soma.getMeanRadius() *
+                morphology->somaMeanRadius *
                     _geometryParameters.getRadiusMultiplier() );
-            primitives[material].push_back( SpherePtr(
-                new Sphere( material, center, radius, 0.f, offset )));
+            sectionPrimitives[sectionType].addSphere(
+                center, radius, 0.f, offset );
             bounds.merge( center );
         }
 
         // Dendrites and axon
-        for( const auto& section: sections )
+        for( const auto& section: morphology->sections )
         {
-            const size_t material =
-                _material( morphologyIndex, size_t( section.getType( )));
-            const Vector4fs& samples = section.getSamples();
+            const size_t sectionType = section.type;
+            if( !( morphologySectionTypes & getSectionTypeMask( sectionType )))
+                continue;
+
+            const Vector4fs& samples = section.samples;
             if( samples.size() == 0 )
                 continue;
 
-            Vector4f previousSample = samples[0];
+            Vector3f previousPosition = transform( samples[0] );
             size_t step = 1;
             switch( _geometryParameters.getGeometryQuality() )
             {
@@ -165,8 +398,8 @@ bool MorphologyLoader::_importMorphology(
                     step = 1;
             }
 
-            const float distanceToSoma = section.getDistanceToSoma();
-            const floats& distancesToSoma = section.getSampleDistancesToSoma();
+            const float distanceToSoma = section.distanceToSoma;
+            const floats& distancesToSoma = section.sampleDistancesToSoma;
 
             float segmentStep = 0.f;
             if( simulationInformation )
@@ -188,54 +421,60 @@ bool MorphologyLoader::_importMorphology(
 
                 const float distance = distanceToSoma + distancesToSoma[i];
 
-                maxDistanceToSoma = std::max(maxDistanceToSoma, distance);
-
                 if( simulationInformation )
                     offset = (*simulationInformation->compartmentOffsets)[sectionId] + float(i)*segmentStep;
                 else
                     if( simulationOffset != 0 )
                         offset = simulationOffset + distance;
 
-                Vector4f sample =  samples[i];
+                const Vector4f& sample = samples[i];
                 const float previousRadius =
                     (_geometryParameters.getRadiusCorrection() != 0.f ?
                     _geometryParameters.getRadiusCorrection() :
                     samples[ i - step ].w() * 0.5f *
                         _geometryParameters.getRadiusMultiplier( ));
 
-                Vector3f position( sample.x(), sample.y(), sample.z());
-                position += translation;
-                Vector3f target(
-                    previousSample.x(), previousSample.y(), previousSample.z());
-                target += translation;
+                const Vector3f samplePosition = transform( sample );
+                const Vector3f position = samplePosition + translation;
+                const Vector3f target = previousPosition + translation;
                 const float radius =
                     (_geometryParameters.getRadiusCorrection() != 0.f ?
                     _geometryParameters.getRadiusCorrection() :
                     samples[ i ].w() * 0.5f *
                          _geometryParameters.getRadiusMultiplier( ));
 
-                if( radius > 0.f )
-                    primitives[material].push_back( SpherePtr(
-                        new Sphere( material, position,
-                            radius, distance, offset )));
-
+                // A single rounded cone covers the segment and both its
+                // joints, samples that do not start a segment are spheres
                 bounds.merge( position );
                 if( position != target && radius > 0.f && previousRadius > 0.f )
                 {
-                    if( radius == previousRadius )
-                        primitives[material].push_back( CylinderPtr(
-                            new Cylinder( material, position, target,
-                                radius, distance, offset )));
-                    else
-                        primitives[material].push_back( ConePtr(
-                            new Cone( material, position, target,
-                                radius, previousRadius, distance, offset )));
+                    sectionPrimitives[sectionType].addRoundedCone(
+                        position, target, radius, previousRadius,
+                        distance, offset );
                     bounds.merge( target );
                 }
-                previousSample = sample;
+                else if( radius > 0.f )
+                    sectionPrimitives[sectionType].addSphere(
+                        position, radius, distance, offset );
+                previousPosition = samplePosition;
             }
             ++sectionId;
         }
+
+        for( const auto& section: sectionPrimitives )
+        {
+            const size_t material =
+                getMaterial( morphologyIndex, section.first );
+            const Primitives& src = section.second;
+            Primitives& dst = primitives[material];
+            groups.push_back( {
+                morphologyIndex, section.first, material,
+                dst.getSpheres().size(), src.getSpheres().size(),
+                dst.getCylinders().size(), src.getCylinders().size(),
+                dst.getCones().size(), src.getCones().size(),
+                dst.getRoundedCones().size(), src.getRoundedCones().size() });
+            dst.append( src );
+        }
     }
     catch( const std::runtime_error& e )
     {
@@ -245,6 +484,40 @@ bool MorphologyLoader::_importMorphology(
     return true;
 }
 
+float MorphologyLoader::_getMaxDistanceToSoma(
+    const servus::URI& source ) const
+{
+    // Distances to the soma grow along the samples of a section, and the last
+    // sample of every imported section is always part of the geometry
+    try
+    {
+        const CachedMorphologyPtr morphology = _morphologyCache->get(
+            source.getPath(),
+            [&source]() { return readMorphology( source ); });
+
+        const size_t morphologySectionTypes =
+            _geometryParameters.getMorphologySectionTypes();
+        float maxDistanceToSoma = 0.f;
+        for( const auto& section: morphology->sections )
+        {
+            if( !( morphologySectionTypes &
+                   getSectionTypeMask( section.type )) ||
+                section.samples.empty( ))
+            {
+                continue;
+            }
+            maxDistanceToSoma = std::max( maxDistanceToSoma,
+                section.distanceToSoma + section.sampleDistancesToSoma.back( ));
+        }
+        return maxDistanceToSoma;
+    }
+    catch( const std::runtime_error& )
+    {
+        // Reported when the morphology is imported
+        return 0.f;
+    }
+}
+
 bool MorphologyLoader::importCircuit(
     const servus::URI& circuitConfig,
     const std::string& target,
@@ -266,42 +539,31 @@ bool MorphologyLoader::importCircuit(
 
     BRAYNS_INFO << "Loading " << uris.size() << " cells" << std::endl;
 
-    std::map< size_t, float > morphologyOffsets;
+    // Every cell starts its simulation values after the distances to the soma
+    // of the previous cells. The offsets are computed before importing, so that
+    // they do not depend on the order in which the cells are imported
+    floats maxDistancesToSoma( uris.size( ));
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t i = 0; i < uris.size(); ++i )
+        maxDistancesToSoma[i] = _getMaxDistanceToSoma( uris[i] );
 
+    std::vector< size_t > simulationOffsets( uris.size( ));
     size_t simulationOffset = 1;
-    size_t simulatedCells = 0;
-    size_t progress = 0;
-    #pragma omp parallel
+    for( size_t i = 0; i < uris.size(); ++i )
     {
-        PrimitivesMap private_primitives;
-        #pragma omp for nowait
-        for( size_t i = 0; i < uris.size(); ++i )
-        {
-            const auto& uri = uris[i];
-            float maxDistanceToSoma = 0.f;
-            if( _importMorphology(
-                uri, i, transforms[i], 0,
-                private_primitives, scene.getWorldBounds(),
-                simulationOffset, maxDistanceToSoma))
-            {
-                morphologyOffsets[simulatedCells] = maxDistanceToSoma;
-                simulationOffset += maxDistanceToSoma;
-            }
+        simulationOffsets[i] = simulationOffset;
+        simulationOffset += maxDistancesToSoma[i];
+    }
 
-            BRAYNS_PROGRESS( progress, uris.size() );
-            #pragma omp atomic
-            ++progress;
-        }
-        #pragma omp critical
-        for( const auto& p: private_primitives )
+    importInBatches( uris.size(), _geometryParameters.getLoadingBatchSize(),
+        scene,
+        [&]( const size_t i, PrimitivesMap& primitives,
+             PrimitivesGroups& groups, Boxf& bounds )
         {
-            const size_t material = p.first;
-            scene.getPrimitives()[material].insert(
-                scene.getPrimitives()[material].end(),
-                private_primitives[material].begin(),
-                private_primitives[material].end());
-        }
-    }
+            return _importMorphology(
+                uris[i], i, transforms[i], 0, primitives, groups, bounds,
+                simulationOffsets[i] );
+        });
 
     return true;
 }
@@ -349,40 +611,21 @@ bool MorphologyLoader::importCircuit(
         cr_uris.push_back( uris[ index ] );
     }
 
-    size_t progress = 0;
-    #pragma omp parallel
-    {
-        PrimitivesMap private_primitives;
-        #pragma omp for nowait
-        for( size_t i = 0; i < cr_uris.size(); ++i )
+    importInBatches( cr_uris.size(), _geometryParameters.getLoadingBatchSize(),
+        scene,
+        [&]( const size_t i, PrimitivesMap& primitives,
+             PrimitivesGroups& groups, Boxf& bounds )
         {
-            const auto& uri = cr_uris[i];
             const SimulationInformation simulationInformation =
             {
                 &compartmentCounts[i],
                 &compartmentOffsets[i]
             };
 
-            float maxDistanceToSoma;
-            _importMorphology(
-                uri, i, transforms[i], &simulationInformation,
-                private_primitives, scene.getWorldBounds(),
-                0, maxDistanceToSoma);
-
-            BRAYNS_PROGRESS( progress, cr_uris.size() );
-            #pragma omp atomic
-            ++progress;
-        }
-        #pragma omp critical
-        for( const auto& p: private_primitives )
-        {
-            const size_t material = p.first;
-            scene.getPrimitives()[material].insert(
-                scene.getPrimitives()[material].end(),
-                private_primitives[material].begin(),
-                private_primitives[material].end());
-        }
-    }
+            return _importMorphology(
+                cr_uris[i], i, transforms[i], &simulationInformation,
+                primitives, groups, bounds, 0 );
+        });
 
     size_t nonSimulatedCells =
         _geometryParameters.getNonSimulatedCells();
@@ -409,35 +652,15 @@ bool MorphologyLoader::importCircuit(
         BRAYNS_INFO << "Loading " << nonSimulatedCells
                     << " non-simulated cells" << std::endl;
 
-        progress = 0;
-        #pragma omp parallel
-        {
-            PrimitivesMap private_primitives;
-            #pragma omp for nowait
-            for( size_t i = 0; i < nonSimulatedCells; ++i )
-            {
-                float maxDistanceToSoma;
-                const auto& uri = allUris[i];
-
-                _importMorphology(
-                    uri, i, allTransforms[i], 0,
-                    private_primitives, scene.getWorldBounds(),
-                    0, maxDistanceToSoma);
-
-                BRAYNS_PROGRESS( progress, allUris.size() );
-                #pragma omp atomic
-                ++progress;
-            }
-            #pragma omp critical
-            for( const auto& p: private_primitives )
+        importInBatches( nonSimulatedCells,
+            _geometryParameters.getLoadingBatchSize(), scene,
+            [&]( const size_t i, PrimitivesMap& primitives,
+                 PrimitivesGroups& groups, Boxf& bounds )
             {
-                const size_t material = p.first;
-                scene.getPrimitives()[material].insert(
-                    scene.getPrimitives()[material].end(),
-                    private_primitives[material].begin(),
-                    private_primitives[material].end());
-            }
-        }
+                return _importMorphology(
+                    allUris[i], i, allTransforms[i], 0,
+                    primitives, groups, bounds, 0 );
+            });
     }
     return true;
 }
@@ -507,8 +730,12 @@ bool MorphologyLoader::importSimulationData(
         const floats& values = *valuesPtr;
         simulationHandler->writeFrame( file, values );
     }
+    simulationHandler->writeIndex( file );
     file.close();
 
+    if( !simulationHandler->attachSimulationToCacheFile( cacheFile ))
+        return false;
+
     BRAYNS_INFO << "----------------------------------------" << std::endl;
     BRAYNS_INFO << "Cache file successfully created" << std::endl;
     BRAYNS_INFO << "Number of frames: " << nbFrames << std::endl;
@@ -526,6 +753,12 @@ bool MorphologyLoader::importMorphology(
     return false;
 }
 
+bool MorphologyLoader::importMorphologies( const strings&, Scene& )
+{
+    BRAYNS_ERROR << "Brion is required to load morphologies" << std::endl;
+    return false;
+}
+
 bool MorphologyLoader::importCircuit(
     const servus::URI&, const std::string&, Scene& )
 {
@@ -550,9 +783,9 @@ bool MorphologyLoader::importSimulationData(
 
 #endif
 
-size_t MorphologyLoader::_material(
+size_t MorphologyLoader::getMaterial(
     const size_t morphologyIndex,
-    const size_t sectionType )
+    const size_t sectionType ) const
 {
     size_t material;
     switch( _geometryParameters.getColorScheme() )
@@ -22,7 +22,8 @@
 #define MORPHOLOGY_LOADER_H
 
 #include <brayns/common/types.h>
-#include <brayns/common/geometry/Primitive.h>
+#include <brayns/common/geometry/Primitives.h>
+#include <brayns/io/MorphologyCache.h>
 #include <brayns/parameters/GeometryParameters.h>
 
 #include <servus/types.h>
@@ -69,6 +70,20 @@ public:
         int morphologyIndex,
         Scene& scene);
 
+    /** Imports morphologies from a list of SWC or H5 files. Morphologies are
+     * loaded in parallel, by batches, and every batch is added to the scene
+     * while holding the scene data lock. The morphology index is the position
+     * of the file in the list.
+     *
+     * @param files Paths of the morphologies
+     * @param scene resulting scene
+     * @return True if all morphologies are successfully loaded, false
+     *         otherwise
+     */
+    bool importMorphologies(
+        const strings& files,
+        Scene& scene);
+
     /** Imports morphology from a circuit for the given target name
      *
      * @param circuitConfig URI of the Circuit Config file
@@ -116,6 +131,13 @@ public:
         const std::string& report,
         Scene& scene );
 
+    /**
+     * @return the material of the given section type of a morphology,
+     *         according to the color scheme
+     */
+    size_t getMaterial(
+        size_t morphologyIndex,
+        size_t sectionType ) const;
 
 private:
     bool _importMorphology(
@@ -124,15 +146,18 @@ private:
         const Matrix4f& transformation,
         const SimulationInformation* simulationInformation,
         PrimitivesMap& primitives,
+        PrimitivesGroups& groups,
         Boxf& bounds,
-        const size_t simulationOffset,
-        float& maxDistanceToSoma);
+        const size_t simulationOffset);
 
-    size_t _material(
-        size_t morphologyIndex,
-        size_t sectionType );
+    /**
+     * @return the largest distance to the soma of the imported samples of a
+     *         morphology, 0 if it cannot be read
+     */
+    float _getMaxDistanceToSoma( const servus::URI& source ) const;
 
     const GeometryParameters& _geometryParameters;
+    std::shared_ptr< MorphologyCache > _morphologyCache;
 };
 
 }
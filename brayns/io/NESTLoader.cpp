@@ -22,7 +22,7 @@
 
 #include <brayns/common/log.h>
 #include <brayns/common/types.h>
-#include <brayns/common/geometry/Sphere.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/common/simulation/SpikeSimulationHandler.h>
 
 #ifdef BRAYNS_USE_BRION
@@ -116,8 +116,7 @@ void NESTLoader::importCircuit( const std::string& filepath, Scene& scene, size_
             int(xColor[gid]) + int(yColor[gid] * 256) + int(zColor[gid] * 65536);
         const Vector3f center( xPos[gid], yPos[gid], zPos[gid] );
         _positions.push_back( center );
-        primitives[ 0 ].push_back( SpherePtr(
-            new Sphere( 0, center, radius, 0.f, materials[index].w() )));
+        primitives[ 0 ].addSphere( center, radius, 0.f, materials[index].w( ));
         bounds.merge( center );
     }
 
@@ -129,10 +128,24 @@ bool NESTLoader::importSpikeReport( const std::string& filename, Scene& scene )
     SpikeSimulationHandlerPtr simulationHandler(
         new SpikeSimulationHandler( _geometryParameters ));
 
+    if( filename.empty( ))
+    {
+        // No report, spikes are received from a running simulation
+        simulationHandler->setLive( _frameSize );
+        scene.setSimulationHandler( simulationHandler );
+        return true;
+    }
+
+    if( _geometryParameters.getNESTSparseSpikes( ))
+        return _importSparseSpikes( filename, simulationHandler, scene );
+
     const std::string& cacheFile = _geometryParameters.getNESTCacheFile();
     if( simulationHandler->attachSimulationToCacheFile( cacheFile ))
+    {
         // Cache already exists, no need to create it.
+        scene.setSimulationHandler( simulationHandler );
         return true;
+    }
 
     if( !_loadBinarySpikes( filename ))
     {
@@ -166,8 +179,12 @@ bool NESTLoader::importSpikeReport( const std::string& filename, Scene& scene )
         _load( timestamp );
         simulationHandler->writeFrame( file, _spikingTimes );
     }
+    simulationHandler->writeIndex( file );
     file.close();
 
+    if( !simulationHandler->attachSimulationToCacheFile( cacheFile ))
+        return false;
+
     scene.setSimulationHandler( simulationHandler );
 
     BRAYNS_INFO << "----------------------------------------" << std::endl;
@@ -177,6 +194,30 @@ bool NESTLoader::importSpikeReport( const std::string& filename, Scene& scene )
     return true;
 }
 
+bool NESTLoader::_importSparseSpikes(
+    const std::string& filename,
+    SpikeSimulationHandlerPtr simulationHandler,
+    Scene& scene )
+{
+    if( !_loadBinarySpikes( filename ))
+    {
+        BRAYNS_ERROR << "No valid binary .spikes file found" << std::endl;
+        return false;
+    }
+
+    SpikeEvents spikes;
+    spikes.reserve( _values.size( ));
+    for( size_t i = 0; i < _values.size(); ++i )
+        if( _gids[i] >= NEST_OFFSET )
+            spikes.push_back( { _values[i], _gids[i] - NEST_OFFSET } );
+    floats().swap( _values );
+    uint32_ts().swap( _gids );
+
+    simulationHandler->setSpikes( std::move( spikes ), _frameSize, NEST_TIMESTEP );
+    scene.setSimulationHandler( simulationHandler );
+    return true;
+}
+
 bool NESTLoader::_loadBinarySpikes( const std::string& spikesFilename )
 {
     std::ifstream file( spikesFilename, std::ios::out | std::ios::binary );
@@ -205,7 +246,7 @@ bool NESTLoader::_loadBinarySpikes( const std::string& spikesFilename )
     _values.reserve( _nbElements );
     _gids.reserve( _nbElements );
     size_t i = 0;
-    while( !file.eof( ))
+    while( i < _nbElements )
     {
         BRAYNS_PROGRESS( i, _nbElements );
         file.read(( char* )&value, sizeof( float ));
@@ -288,6 +329,12 @@ bool NESTLoader::importSpikeReport( const std::string&, Scene&)
     return false;
 }
 
+bool NESTLoader::_importSparseSpikes( const std::string&, SpikeSimulationHandlerPtr, Scene& )
+{
+    BRAYNS_ERROR << "Brion is required to load circuits" << std::endl;
+    return false;
+}
+
 bool NESTLoader::_loadBinarySpikes( const std::string& )
 {
     BRAYNS_ERROR << "Brion is required to load circuits" << std::endl;
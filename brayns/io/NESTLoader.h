@@ -23,7 +23,7 @@
 
 
 #include <brayns/common/types.h>
-#include <brayns/common/geometry/Primitive.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/common/scene/Scene.h>
 #include <brayns/parameters/GeometryParameters.h>
 
@@ -41,6 +41,10 @@ namespace brayns
  * The cache file contains a header of two uint64_t. The first one is the number of frame, and the
  * second one is the frame size (the number of floats per frame). The cache file is handled bu the
  * SpikeSimulationHandler class.
+ * With the --nest-sparse-spikes command line parameter, no cache file is created: spikes are kept
+ * in memory as a list of events, from which the SpikeSimulationHandler builds the frames.
+ * Without any report, spikes are expected from a running simulation (see SpikeSimulationHandler
+ * live mode).
  * Note that in the current implementation, the simulation can only be played forward.
  * @todo Move this loaded to Brion
  */
@@ -64,7 +68,8 @@ public:
      * Imports a spike report into the memory mapped cache file that will be attached to the
      * specified scene at the end of the loading. If the cache file does not exists, it is created.
      * The cache file contains the timestamp for the spike activation, for every neuron, and for
-     * every frame.
+     * every frame. If the filename is empty, the simulation handler waits for spikes from a
+     * running simulation instead.
      * @param filename File containing the report
      * @param scene Scene to which the simulation should be attached
      * @return True if report was successfully imported, false otherwise
@@ -73,6 +78,8 @@ public:
 
 private:
 
+    bool _importSparseSpikes( const std::string& filename,
+                              SpikeSimulationHandlerPtr simulationHandler, Scene& scene );
     bool _loadBinarySpikes( const std::string& spikesFilename );
     bool _load( const float timestamp );
 
@@ -22,11 +22,12 @@
 
 #include <brayns/common/log.h>
 #include <brayns/common/types.h>
-#include <brayns/common/geometry/Sphere.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/common/scene/Scene.h>
 
 #include <assert.h>
 #include <fstream>
+#include <iterator>
 
 namespace brayns
 {
@@ -304,6 +305,51 @@ static AtomicRadius atomic_radii[colorMapSize] = // atomic radii in microns
     { "P" ,   25.f, 113 }
 };
 
+/** Reads the given columns of a PDB record, without spaces
+ */
+static std::string readColumns(
+    const std::string& line,
+    const size_t begin,
+    const size_t end )
+{
+    std::string value;
+    for( size_t i = begin; i < end && i < line.length(); ++i )
+        if( line[i] != ' ' )
+            value += line[i];
+    return value;
+}
+
+/** Returns the index of the given atom symbol in the color map, colorMapSize
+ * if the symbol is unknown
+ */
+static size_t findColor( const std::string& symbol )
+{
+    static const std::map< std::string, size_t > colors = []
+    {
+        std::map< std::string, size_t > indices;
+        for( size_t i = colorMapSize; i > 0; --i )
+            indices[ colorMap[ i - 1 ].symbol ] = i - 1;
+        return indices;
+    }();
+    const auto it = colors.find( symbol );
+    return it == colors.end() ? colorMapSize : it->second;
+}
+
+/** Returns the radius of the given atom symbol, in microns
+ */
+static float findRadius( const std::string& symbol )
+{
+    static const std::map< std::string, float > radii = []
+    {
+        std::map< std::string, float > values;
+        for( size_t i = colorMapSize; i > 0; --i )
+            values[ atomic_radii[ i - 1 ].Symbol ] = atomic_radii[ i - 1 ].radius;
+        return values;
+    }();
+    const auto it = radii.find( symbol );
+    return it == radii.end() ? DEFAULT_RADIUS : it->second;
+}
+
 ProteinLoader::ProteinLoader(
     const GeometryParameters& geometryParameters )
     : _geometryParameters(geometryParameters)
@@ -316,138 +362,113 @@ bool ProteinLoader::importPDBFile(
     const size_t proteinIndex,
     Scene& scene)
 {
-    int index(0);
-    std::ifstream file(filename.c_str());
-    if(!file.is_open())
-    {
-        BRAYNS_ERROR << "Could not open " << filename << std::endl;
+    PrimitivesMap atoms;
+    Boxf bounds;
+    if( !importPDBFile( filename, proteinIndex, scene.getMaterials().size(),
+                        atoms, bounds ))
         return false;
+
+    for( const auto& material: atoms )
+    {
+        Primitives& primitives = scene.getPrimitives()[ material.first ];
+        for( const Sphere& atom: material.second.getSpheres( ))
+            primitives.addSphere( position + atom.center, atom.radius,
+                                  atom.timestamp, atom.value );
     }
-    else
+
+    if( !bounds.isEmpty( ))
     {
-        while( file.good() )
-        {
-            std::string line;
-            std::string value;
-            std::getline( file, line );
-            if( line.find( "ATOM" ) == 0 )
-            {
-                // Atom
-                Atom atom;
-                atom.chainId = 0;
-                atom.residue = 0;
-                atom.index = index;
-                index++;
-                std::string atomName;
-                std::string atomCode;
-                size_t i=0;
-                while( i<line.length() )
-                {
-                    switch(i)
-                    {
-                    case 6: //ID
-                    case 12:
-                    case 76: // Atom name
-                    case 22: // ChainID
-                    case 30: // x
-                    case 38: // y
-                    case 46: // z
-                        value = "";
-                        break;
-                    case 21:
-                        atom.chainId = (int)line.at(i)-64;
-                        break;
-                    case 11:
-                        atom.id = static_cast<int>(atoi(value.c_str()));
-                        break;
-                    case 17:
-                        atomCode = value;
-                        break;
-                    case 79:
-                        atomName = value;
-                        break;
-                    case 26:
-                        atom.residue = static_cast<int>(atoi(value.c_str()));
-                        break;
-                    case 37:
-                        atom.position[0] = static_cast<float>(atof(value.c_str()));
-                        break;
-                    case 45:
-                        atom.position[1] = static_cast<float>(atof(value.c_str()));
-                        break;
-                    case 53:
-                        atom.position[2] = static_cast<float>(atof(value.c_str()));
-                        break;
-                    default:
-                        if( line.at(i) != ' ' )
-                            value += line.at(i);
-                        break;
-                    }
-                    i++;
-                }
+        scene.getWorldBounds().merge( position + bounds.getMin( ));
+        scene.getWorldBounds().merge( position + bounds.getMax( ));
+    }
+    return true;
+}
 
-                // Material
-                atom.materialId = 0;
-                i = 0;
-                bool found = false;
-                const auto colorScheme = _geometryParameters.getColorScheme();
-                while(!found && i<colorMapSize)
-                {
-                    if( atomName == colorMap[i].symbol )
-                    {
-                        found = true;
-                        switch( colorScheme )
-                        {
-                        case ColorScheme::protein_chains:
-                            atom.materialId = abs( atom.chainId ) % scene.getMaterials().size();
-                            break;
-                        case ColorScheme::protein_residues:
-                            atom.materialId = abs( atom.residue ) % scene.getMaterials().size();
-                            break;
-                        default:
-                            atom.materialId = static_cast< int >( i );
-                            break;
-                        }
-                    }
-                    ++i;
-                }
+bool ProteinLoader::importPDBFile(
+    const std::string& filename,
+    const size_t proteinIndex,
+    const size_t nbMaterials,
+    PrimitivesMap& primitives,
+    Boxf& bounds )
+{
+    std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+    if( !file.is_open( ))
+    {
+        BRAYNS_ERROR << "Could not open " << filename << std::endl;
+        return false;
+    }
+    const std::string content(( std::istreambuf_iterator< char >( file )),
+                                std::istreambuf_iterator< char >( ));
+    file.close();
 
-                // Radius
-                atom.radius = DEFAULT_RADIUS;
-                i = 0;
-                found = false;
-                while( !found && i<colorMapSize )
-                {
-                    if( atomName == atomic_radii[ i ].Symbol )
-                    {
-                        atom.radius = atomic_radii[ i ].radius;
-                        found = true;
-                    }
-                    ++i;
-                }
+    // Locate atom records
+    std::vector< std::pair< size_t, size_t >> records;
+    for( size_t begin = 0; begin < content.length(); )
+    {
+        size_t end = content.find( '\n', begin );
+        if( end == std::string::npos )
+            end = content.length();
+        if( content.compare( begin, 4, "ATOM" ) == 0 )
+            records.push_back( { begin, end - begin } );
+        begin = end + 1;
+    }
 
-                SpherePtr sphere(new Sphere(
-                    0, Vector3f( position + 0.01f * atom.position ), // convert from nanometers
-                    0.0001f * atom.radius *                          // convert from angstrom
-                        _geometryParameters.getRadiusMultiplier(),
-                    0.f, 0.f));
+    // Parse atom records in parallel. Columns are defined by the PDB format
+    // specification
+    const auto colorScheme = _geometryParameters.getColorScheme();
+    std::vector< Atom > atoms( records.size( ));
+    #pragma omp parallel for
+    for( size_t i = 0; i < records.size(); ++i )
+    {
+        const std::string line =
+            content.substr( records[i].first, records[i].second );
+        Atom& atom = atoms[i];
+        atom.index = i;
+        atom.id = atoi( readColumns( line, 6, 11 ).c_str( ));
+        atom.chainId = line.length() > 21 ? (int)line.at(21) - 64 : 0;
+        atom.residue = atoi( readColumns( line, 22, 26 ).c_str( ));
+        for( size_t axis = 0; axis < 3; ++axis )
+            atom.position[axis] = static_cast< float >( atof(
+                readColumns( line, 30 + 8 * axis, 38 + 8 * axis ).c_str( )));
 
-                switch( colorScheme )
-                {
-                case ColorScheme::protein_by_id:
-                    {
-                        const auto material = proteinIndex % scene.getMaterials().size();
-                        scene.getPrimitives()[ material ].push_back( sphere );
-                    }
-                    break;
-                default:
-                    scene.getPrimitives()[ atom.materialId ].push_back( sphere );
-                }
+        const std::string atomName = readColumns( line, 76, 78 );
 
-                scene.getWorldBounds().merge(sphere->getCenter());
+        // Material
+        atom.materialId = 0;
+        const size_t color = findColor( atomName );
+        if( color != colorMapSize )
+        {
+            switch( colorScheme )
+            {
+            case ColorScheme::protein_chains:
+                atom.materialId = abs( atom.chainId ) % nbMaterials;
+                break;
+            case ColorScheme::protein_residues:
+                atom.materialId = abs( atom.residue ) % nbMaterials;
+                break;
+            default:
+                atom.materialId = static_cast< int >( color );
+                break;
             }
         }
-        file.close();
+
+        // Radius
+        atom.radius = findRadius( atomName );
+    }
+
+    for( const auto& atom: atoms )
+    {
+        // convert from nanometers
+        const Vector3f center( 0.01f * atom.position );
+        // convert from angstrom
+        const float radius = 0.0001f * atom.radius *
+            _geometryParameters.getRadiusMultiplier();
+
+        size_t material = atom.materialId;
+        if( colorScheme == ColorScheme::protein_by_id )
+            material = proteinIndex % nbMaterials;
+        primitives[ material ].addSphere( center, radius, 0.f, 0.f );
+        bounds.merge( center );
     }
 
     return true;
@@ -23,7 +23,7 @@
 
 #include <brayns/common/types.h>
 #include <brayns/common/material/Material.h>
-#include <brayns/common/geometry/Primitive.h>
+#include <brayns/common/geometry/Primitives.h>
 #include <brayns/parameters/GeometryParameters.h>
 #include <string>
 
@@ -52,6 +52,23 @@ public:
         const size_t proteinIndex,
         Scene& scene);
 
+    /** Imports atoms from a given PDB file, in the space of the protein. The
+     * resulting spheres can be shared by several instances of the protein
+     *
+     * @param filename PDB file to import
+     * @param proteinIndex Index of the protein when more than one is loaded
+     * @param nbMaterials Number of materials available in the scene
+     * @param primitives Resulting atoms, per material
+     * @param bounds Resulting bounds of the atom centers
+     * @return true if PDB file was successufully loaded, false otherwize
+     */
+    bool importPDBFile(
+        const std::string& filename,
+        size_t proteinIndex,
+        size_t nbMaterials,
+        PrimitivesMap& primitives,
+        Boxf& bounds );
+
     /** Returns the RGB composants for a given atom index, and according to the
      * JMol scheme
      *
@@ -20,10 +20,235 @@
 
 #include <brayns/common/log.h>
 #include <brayns/common/scene/Scene.h>
-#include <fstream>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "XYZBLoader.h"
 
+namespace
+{
+const int NO_DESCRIPTOR = -1;
+
+// Amount of data processed by a single task
+const uint64_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+// Number of digits that can be accumulated without overflowing the mantissa
+const uint64_t MAX_MANTISSA = 100000000000000000ull;
+
+const size_t NB_POWERS_OF_TEN = 23;
+const double POWERS_OF_TEN[NB_POWERS_OF_TEN] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/** Read-only memory mapping of a whole file */
+class MappedFile
+{
+public:
+    explicit MappedFile( const std::string& filename )
+        : _data( nullptr )
+        , _size( 0 )
+    {
+        const int descriptor = ::open( filename.c_str(), O_RDONLY );
+        if( descriptor == NO_DESCRIPTOR )
+            return;
+
+        struct stat sb;
+        if( ::fstat( descriptor, &sb ) != NO_DESCRIPTOR && sb.st_size > 0 )
+        {
+            void* data =
+                ::mmap( 0, sb.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+            if( data != MAP_FAILED )
+            {
+                ::madvise( data, sb.st_size, MADV_SEQUENTIAL );
+                _data = static_cast< const char* >( data );
+                _size = sb.st_size;
+            }
+        }
+        ::close( descriptor );
+    }
+
+    ~MappedFile()
+    {
+        if( _data )
+            ::munmap( const_cast< char* >( _data ), _size );
+    }
+
+    bool valid() const { return _data != nullptr; }
+    const char* data() const { return _data; }
+    uint64_t size() const { return _size; }
+
+private:
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    const char* _data;
+    uint64_t _size;
+};
+
+inline bool isSpace( const char c )
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit( const char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isSeparator( const char* cursor, const char* end )
+{
+    return cursor == end || isSpace( *cursor ) || *cursor == '\n';
+}
+
+/**
+ * Parses a plain decimal number ([+-]digits[.digits][(e|E)[+-]digits]) and
+ * moves the cursor after it. Any other notation (inf, nan, hexadecimal, ...)
+ * is left to strtof.
+ */
+bool parseFloat( const char*& cursor, const char* end, float& value )
+{
+    const char* c = cursor;
+    bool negative = false;
+    if( c != end && ( *c == '-' || *c == '+' ))
+        negative = ( *c++ == '-' );
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    for( ; c != end && isDigit( *c ); ++c, hasDigits = true )
+    {
+        if( mantissa < MAX_MANTISSA )
+            mantissa = mantissa * 10 + ( *c - '0' );
+        else
+            ++exponent;
+    }
+    if( c != end && *c == '.' )
+    {
+        for( ++c; c != end && isDigit( *c ); ++c, hasDigits = true )
+        {
+            if( mantissa < MAX_MANTISSA )
+            {
+                mantissa = mantissa * 10 + ( *c - '0' );
+                --exponent;
+            }
+        }
+    }
+    if( hasDigits && c != end && ( *c == 'e' || *c == 'E' ))
+    {
+        ++c;
+        bool negativeExponent = false;
+        if( c != end && ( *c == '-' || *c == '+' ))
+            negativeExponent = ( *c++ == '-' );
+        if( c == end || !isDigit( *c ))
+            hasDigits = false;
+        int exponentValue = 0;
+        for( ; c != end && isDigit( *c ); ++c )
+            if( exponentValue < 10000 )
+                exponentValue = exponentValue * 10 + ( *c - '0' );
+        exponent += negativeExponent ? -exponentValue : exponentValue;
+    }
+
+    if( hasDigits && isSeparator( c, end ))
+    {
+        double result = mantissa;
+        const size_t absExponent = std::abs( exponent );
+        const double scale = absExponent < NB_POWERS_OF_TEN ?
+            POWERS_OF_TEN[absExponent] : std::pow( 10.0, absExponent );
+        result = exponent < 0 ? result / scale : result * scale;
+        value = negative ? -result : result;
+        cursor = c;
+        return true;
+    }
+
+    // Fall back to the C library on a zero-terminated copy of the token
+    const char* tokenEnd = cursor;
+    while( !isSeparator( tokenEnd, end ))
+        ++tokenEnd;
+    char token[64];
+    const size_t length = tokenEnd - cursor;
+    if( length == 0 || length >= sizeof( token ))
+        return false;
+    memcpy( token, cursor, length );
+    token[length] = 0;
+    char* parsedEnd = nullptr;
+    value = std::strtof( token, &parsedEnd );
+    if( parsedEnd != token + length )
+        return false;
+    cursor = tokenEnd;
+    return true;
+}
+
+/** @return the end of the line starting at the given position */
+inline const char* findEndOfLine( const char* cursor, const char* end )
+{
+    const char* eol = static_cast< const char* >(
+        memchr( cursor, '\n', end - cursor ));
+    return eol ? eol : end;
+}
+
+inline bool isBlank( const char* begin, const char* end )
+{
+    for( ; begin != end; ++begin )
+        if( !isSpace( *begin ))
+            return false;
+    return true;
+}
+
+/** Parses a line made of exactly 3 values */
+bool parsePosition( const char* cursor, const char* end,
+                    brayns::Vector3f& position )
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        while( cursor != end && isSpace( *cursor ))
+            ++cursor;
+        if( !parseFloat( cursor, end, position[i] ))
+            return false;
+    }
+    return isBlank( cursor, end );
+}
+
+/** Text chunk, starting and ending on line boundaries */
+struct TextChunk
+{
+    const char* begin;
+    const char* end;
+    size_t nbPositions;
+    size_t offset;
+    brayns::Boxf bounds;
+    std::string invalidLine;
+};
+
+std::vector< TextChunk > splitText( const char* data, const uint64_t size )
+{
+    const char* end = data + size;
+    const size_t nbChunks = std::max< uint64_t >( 1, size / CHUNK_SIZE );
+    std::vector< TextChunk > chunks;
+    const char* begin = data;
+    for( size_t i = 1; i <= nbChunks && begin != end; ++i )
+    {
+        const char* chunkEnd = end;
+        if( i < nbChunks )
+        {
+            chunkEnd = std::max( begin, data + i * ( size / nbChunks ));
+            chunkEnd = findEndOfLine( chunkEnd, end );
+            if( chunkEnd != end )
+                ++chunkEnd;
+        }
+        chunks.push_back( { begin, chunkEnd, 0, 0, brayns::Boxf(), "" } );
+        begin = chunkEnd;
+    }
+    return chunks;
+}
+}
+
 namespace brayns
 {
 
@@ -37,46 +262,85 @@ bool XYZBLoader::importFromFile(
     Scene& scene )
 {
     BRAYNS_INFO << "Loading xyz file from " << filename << std::endl;
-    std::ifstream file( filename, std::ios::in );
-    if( !file.good( ))
+    const MappedFile file( filename );
+    if( !file.valid( ))
     {
         BRAYNS_ERROR << "Could not open file " << filename << std::endl;
         return false;
     }
 
-    PrimitivesMap& primitives = scene.getPrimitives();
-    bool validParsing = true;
-    std::string line;
+    std::vector< TextChunk > chunks = splitText( file.data(), file.size( ));
+
+    // First pass: count the non blank lines of every chunk so that positions
+    // can be written in place, at their final location
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t i = 0; i < chunks.size(); ++i )
+    {
+        TextChunk& chunk = chunks[i];
+        for( const char* line = chunk.begin; line < chunk.end; )
+        {
+            const char* eol = findEndOfLine( line, chunk.end );
+            if( !isBlank( line, eol ))
+                ++chunk.nbPositions;
+            line = eol + 1;
+        }
+    }
 
-    while( validParsing && std::getline( file, line ))
+    size_t nbPositions = 0;
+    for( auto& chunk: chunks )
     {
-        std::vector< float > lineData;
-        std::stringstream lineStream(line);
+        chunk.offset = nbPositions;
+        nbPositions += chunk.nbPositions;
+    }
 
-        float value;
-        while( lineStream >> value )
-            lineData.push_back(value);
+    Spheres& spheres = scene.getPrimitives()[0].getSpheres();
+    const size_t firstSphere = spheres.size();
+    spheres.resize( firstSphere + nbPositions );
 
-        switch( lineData.size() )
-        {
-        case 3:
+    // Second pass: parse positions
+    const float radius = _geometryParameters.getRadiusMultiplier();
+    size_t progress = 0;
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t i = 0; i < chunks.size(); ++i )
+    {
+        TextChunk& chunk = chunks[i];
+        Sphere* sphere = spheres.data() + firstSphere + chunk.offset;
+        for( const char* line = chunk.begin; line < chunk.end; )
         {
-            const Vector3f position( lineData[0], lineData[1], lineData[2] );
-            BRAYNS_INFO << position << std::endl;
-            primitives[0].push_back( SpherePtr(
-                new Sphere( 0, position, _geometryParameters.getRadiusMultiplier(), 0.f, 0.f)));
-            scene.getWorldBounds().merge( position );
-            break;
+            const char* eol = findEndOfLine( line, chunk.end );
+            if( !isBlank( line, eol ))
+            {
+                Vector3f position;
+                if( !parsePosition( line, eol, position ))
+                {
+                    chunk.invalidLine = std::string( line, eol );
+                    break;
+                }
+                *sphere++ = { position, radius, 0.f, 0.f };
+                chunk.bounds.merge( position );
+            }
+            line = eol + 1;
         }
-        default:
-            BRAYNS_ERROR << "Invalid line: " << line << std::endl;
-            validParsing = false;
-            break;
+
+        BRAYNS_PROGRESS( progress, chunks.size( ));
+        #pragma omp atomic
+        ++progress;
+    }
+
+    for( const auto& chunk: chunks )
+    {
+        if( !chunk.invalidLine.empty( ))
+        {
+            BRAYNS_ERROR << "Invalid line: " << chunk.invalidLine << std::endl;
+            spheres.resize( firstSphere );
+            return false;
         }
+        if( chunk.nbPositions != 0 )
+            scene.getWorldBounds().merge( chunk.bounds );
     }
 
-    file.close();
-    return validParsing;
+    BRAYNS_INFO << nbPositions << " positions loaded" << std::endl;
+    return true;
 }
 
 bool XYZBLoader::importFromBinaryFile(
@@ -84,40 +348,52 @@ bool XYZBLoader::importFromBinaryFile(
     Scene& scene )
 {
     BRAYNS_INFO << "Loading xyzb file from " << filename << std::endl;
-    std::ifstream file( filename, std::ios::in|std::fstream::binary );
-    if( !file.good( ))
+    const MappedFile file( filename );
+    if( !file.valid( ))
     {
         BRAYNS_ERROR << "Could not open file " << filename << std::endl;
         return false;
     }
 
-    uint64_t progress = 0;
-    file.seekg(0, std::ios_base::end);
-    uint64_t nbPoints = file.tellg() / ( 3 * sizeof(double) );
-    file.seekg(0);
-
-    PrimitivesMap& primitives = scene.getPrimitives();
-    while( !file.eof() )
-    {
-        if( progress % ( nbPoints / 100 ) == 0 )
-            BRAYNS_PROGRESS( progress, nbPoints );
+    // Records are made of 3 doubles
+    const size_t recordSize = 3 * sizeof( double );
+    const size_t nbPoints = file.size() / recordSize;
+    if( file.size() % recordSize != 0 )
+        BRAYNS_WARN << "Ignoring " << file.size() % recordSize
+                    << " trailing bytes in " << filename << std::endl;
 
-        double x,y,z;
-        file.read((char *)&x, sizeof(double));
-        file.read((char *)&y, sizeof(double));
-        file.read((char *)&z, sizeof(double));
+    Spheres& spheres = scene.getPrimitives()[0].getSpheres();
+    const size_t firstSphere = spheres.size();
+    spheres.resize( firstSphere + nbPoints );
 
-        BRAYNS_DEBUG << x << "," << y << "," << z << std::endl;
-
-        const Vector3f position( x, y, z );
-        primitives[0].push_back( SpherePtr( new Sphere(
-            0, position, _geometryParameters.getRadiusMultiplier(), 0.f, 0.f )));
-        scene.getWorldBounds().merge( position );
+    const float radius = _geometryParameters.getRadiusMultiplier();
+    const size_t pointsPerChunk = CHUNK_SIZE / recordSize;
+    const size_t nbChunks = ( nbPoints + pointsPerChunk - 1 ) / pointsPerChunk;
+    std::vector< Boxf > bounds( nbChunks );
+    size_t progress = 0;
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t chunk = 0; chunk < nbChunks; ++chunk )
+    {
+        const size_t begin = chunk * pointsPerChunk;
+        const size_t end = std::min( nbPoints, begin + pointsPerChunk );
+        for( size_t i = begin; i < end; ++i )
+        {
+            double record[3];
+            memcpy( record, file.data() + i * recordSize, recordSize );
+            const Vector3f position( record[0], record[1], record[2] );
+            spheres[firstSphere + i] = { position, radius, 0.f, 0.f };
+            bounds[chunk].merge( position );
+        }
 
+        BRAYNS_PROGRESS( progress, nbChunks );
+        #pragma omp atomic
         ++progress;
     }
 
-    file.close();
+    for( const auto& chunkBounds: bounds )
+        scene.getWorldBounds().merge( chunkBounds );
+
+    BRAYNS_INFO << nbPoints << " positions loaded" << std::endl;
     return true;
 }
 
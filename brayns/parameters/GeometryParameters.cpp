@@ -25,6 +25,8 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+
 namespace
 {
 
@@ -38,6 +40,8 @@ const std::string PARAM_MESH_FOLDER = "mesh-folder";
 const std::string PARAM_CIRCUIT_CONFIG = "circuit-config";
 const std::string PARAM_LOAD_CACHE_FILE = "load-cache-file";
 const std::string PARAM_SAVE_CACHE_FILE = "save-cache-file";
+const std::string PARAM_COMPRESS_CACHE_FILE = "compress-cache-file";
+const std::string PARAM_VERIFY_CACHE_FILE = "verify-cache-file";
 const std::string PARAM_RADIUS_MULTIPLIER = "radius-multiplier";
 const std::string PARAM_RADIUS_CORRECTION = "radius-correction";
 const std::string PARAM_COLOR_SCHEME = "color-scheme";
@@ -51,12 +55,20 @@ const std::string PARAM_END_SIMULATION_TIME = "end-simulation-time";
 const std::string PARAM_SIMULATION_RANGE = "simulation-values-range";
 const std::string PARAM_SIMULATION_CACHE_FILENAME = "simulation-cache-file";
 const std::string PARAM_SIMULATION_HISTOGRAM_SIZE = "simulation-histogram-size";
+const std::string PARAM_SIMULATION_PREFETCH_FRAMES = "simulation-prefetch-frames";
+const std::string PARAM_SIMULATION_CACHE_ENCODING = "simulation-cache-encoding";
 const std::string PARAM_NEST_CACHE_FILENAME = "nest-cache-file";
+const std::string PARAM_NEST_SPARSE_SPIKES = "nest-sparse-spikes";
 const std::string PARAM_MORPHOLOGY_SECTION_TYPES = "morphology-section-types";
 const std::string PARAM_MORPHOLOGY_LAYOUT = "morphology-layout";
 const std::string PARAM_GENERATE_MULTIPLE_MODELS = "generate-multiple-models";
+const std::string PARAM_GROWTH_ANIMATION = "growth-animation";
+const std::string PARAM_SORT_PRIMITIVES = "sort-primitives";
 const std::string PARAM_SPLASH_SCENE_FOLDER = "splash-scene-folder";
 const std::string PARAM_MOLECULAR_SYSTEM_CONFIG = "molecular-system-config";
+const std::string PARAM_ASYNCHRONOUS_LOADING = "asynchronous-loading";
+const std::string PARAM_LOADING_BATCH_SIZE = "loading-batch-size";
+const std::string PARAM_MORPHOLOGY_CACHE_FOLDER = "morphology-cache-folder";
 
 const std::string COLOR_SCHEMES[8] = {
     "none", "neuron-by-id", "neuron-by-type", "neuron-by-segment-type",
@@ -67,6 +79,8 @@ const std::string SCENE_ENVIRONMENTS[4] = { "none", "ground", "wall", "bounding-
 
 const std::string GEOMETRY_QUALITIES[3] = { "low", "medium", "high" };
 
+const std::string SIMULATION_ENCODINGS[3] = { "float32", "float16", "uint8" };
+
 }
 
 namespace brayns
@@ -74,6 +88,7 @@ namespace brayns
 
 GeometryParameters::GeometryParameters()
     : AbstractParameters( "Geometry" )
+    , _NESTSparseSpikes( false )
     , _radiusMultiplier( 1.f )
     , _radiusCorrection( 0.f )
     , _colorScheme( ColorScheme::none )
@@ -86,7 +101,15 @@ GeometryParameters::GeometryParameters()
     , _simulationValuesRange( Vector2f(
         std::numeric_limits<float>::max(), std::numeric_limits<float>::min( )))
     , _simulationHistogramSize( 128 )
+    , _simulationPrefetchFrames( 4 )
+    , _simulationCacheEncoding( SimulationEncoding::float32 )
     , _generateMultipleModels( false )
+    , _growthAnimation( false )
+    , _sortPrimitives( false )
+    , _compressCacheFile( false )
+    , _verifyCacheFile( false )
+    , _asynchronousLoading( false )
+    , _loadingBatchSize( 1000 )
 {
     _parameters.add_options()
         ( PARAM_MORPHOLOGY_FOLDER.c_str(), po::value< std::string >(),
@@ -109,6 +132,11 @@ GeometryParameters::GeometryParameters()
             "Load binary container of a scene [string]" )
         ( PARAM_SAVE_CACHE_FILE.c_str(), po::value< std::string >(),
             "Save binary container of a scene [string]" )
+        ( PARAM_COMPRESS_CACHE_FILE.c_str(), po::value< bool >(),
+            "Enable/Disable compression of the saved binary container [bool]" )
+        ( PARAM_VERIFY_CACHE_FILE.c_str(), po::value< bool >(),
+            "Enable/Disable verification of the checksums of the loaded "
+            "binary container [bool]" )
         ( PARAM_RADIUS_MULTIPLIER.c_str(), po::value< float >(),
             "Radius multiplier for spheres, cones and cylinders [float]" )
         ( PARAM_RADIUS_CORRECTION.c_str(), po::value< float >(),
@@ -145,14 +173,31 @@ GeometryParameters::GeometryParameters()
             "Cache file containing simulation data [string]" )
         (PARAM_SIMULATION_HISTOGRAM_SIZE.c_str(), po::value< size_t >(),
             "Number of values defining the simulation histogram [int]")
+        ( PARAM_SIMULATION_PREFETCH_FRAMES.c_str(), po::value< size_t >(),
+            "Number of simulation frames read ahead, 0 to disable [int]" )
+        ( PARAM_SIMULATION_CACHE_ENCODING.c_str(), po::value< std::string >(),
+            "Encoding of the simulation cache files created [float32|float16|uint8]" )
         ( PARAM_NEST_CACHE_FILENAME.c_str(), po::value< std::string >(),
             "Cache file containing nest data [string]" )
+        ( PARAM_NEST_SPARSE_SPIKES.c_str(), po::value< bool >(),
+            "Keep NEST spikes in memory as a list of events instead of creating a cache file [bool]" )
         ( PARAM_GENERATE_MULTIPLE_MODELS.c_str(), po::value< bool >(),
             "Enable/Disable generation of multiple models based on geometry timestamps [bool]" )
+        ( PARAM_GROWTH_ANIMATION.c_str(), po::value< bool >(),
+            "Enable/Disable models based on geometry timestamps that share a single copy of the geometry [bool]" )
+        ( PARAM_SORT_PRIMITIVES.c_str(), po::value< bool >(),
+            "Enable/Disable spatial sorting of the primitives before building the geometry. "
+            "Color scheme changes do not apply to sorted primitives [bool]" )
         ( PARAM_SPLASH_SCENE_FOLDER.c_str(), po::value< std::string >(),
             "Folder containing splash scene folder [string]" )
         ( PARAM_MOLECULAR_SYSTEM_CONFIG.c_str(), po::value< std::string >(),
-            "Molecular system configuration [string]" );
+            "Molecular system configuration [string]" )
+        ( PARAM_ASYNCHRONOUS_LOADING.c_str(), po::value< bool >(),
+            "Enable/Disable loading of the scene in the background [bool]" )
+        ( PARAM_LOADING_BATCH_SIZE.c_str(), po::value< size_t >(),
+            "Number of cells loaded before their geometry is committed [int]" )
+        ( PARAM_MORPHOLOGY_CACHE_FOLDER.c_str(), po::value< std::string >(),
+            "Folder where preprocessed morphologies are cached [string]" );
 }
 
 bool GeometryParameters::_parse( const po::variables_map& vm )
@@ -177,6 +222,10 @@ bool GeometryParameters::_parse( const po::variables_map& vm )
         _loadCacheFile = vm[PARAM_LOAD_CACHE_FILE].as< std::string >();
     if( vm.count( PARAM_SAVE_CACHE_FILE ))
         _saveCacheFile = vm[PARAM_SAVE_CACHE_FILE].as< std::string >();
+    if( vm.count( PARAM_COMPRESS_CACHE_FILE ))
+        _compressCacheFile = vm[PARAM_COMPRESS_CACHE_FILE].as< bool >();
+    if( vm.count( PARAM_VERIFY_CACHE_FILE ))
+        _verifyCacheFile = vm[PARAM_VERIFY_CACHE_FILE].as< bool >();
     if( vm.count( PARAM_COLOR_SCHEME ))
     {
         _colorScheme = ColorScheme::none;
@@ -242,16 +291,40 @@ bool GeometryParameters::_parse( const po::variables_map& vm )
             vm[PARAM_SIMULATION_CACHE_FILENAME].as< std::string >();
     if( vm.count( PARAM_SIMULATION_HISTOGRAM_SIZE ))
         _simulationHistogramSize = vm[PARAM_SIMULATION_HISTOGRAM_SIZE].as< size_t >();
+    if( vm.count( PARAM_SIMULATION_PREFETCH_FRAMES ))
+        _simulationPrefetchFrames = vm[PARAM_SIMULATION_PREFETCH_FRAMES].as< size_t >();
+    if( vm.count( PARAM_SIMULATION_CACHE_ENCODING ))
+    {
+        _simulationCacheEncoding = SimulationEncoding::float32;
+        const auto& encoding = vm[PARAM_SIMULATION_CACHE_ENCODING].as< std::string >();
+        for( size_t i = 0; i < sizeof( SIMULATION_ENCODINGS ) / sizeof( SIMULATION_ENCODINGS[0] ); ++i )
+            if( encoding == SIMULATION_ENCODINGS[i])
+                _simulationCacheEncoding = static_cast< SimulationEncoding >( i );
+    }
     if( vm.count( PARAM_NEST_CACHE_FILENAME ))
         _NESTCacheFile =
             vm[PARAM_NEST_CACHE_FILENAME].as< std::string >();
+    if( vm.count( PARAM_NEST_SPARSE_SPIKES ))
+        _NESTSparseSpikes = vm[PARAM_NEST_SPARSE_SPIKES].as< bool >();
     if( vm.count( PARAM_GENERATE_MULTIPLE_MODELS ))
         _generateMultipleModels =
             vm[PARAM_GENERATE_MULTIPLE_MODELS].as< bool >();
+    if( vm.count( PARAM_GROWTH_ANIMATION ))
+        _growthAnimation = vm[PARAM_GROWTH_ANIMATION].as< bool >();
+    if( vm.count( PARAM_SORT_PRIMITIVES ))
+        _sortPrimitives = vm[PARAM_SORT_PRIMITIVES].as< bool >();
     if( vm.count( PARAM_SPLASH_SCENE_FOLDER ))
         _splashSceneFolder = vm[PARAM_SPLASH_SCENE_FOLDER].as< std::string >();
     if( vm.count( PARAM_MOLECULAR_SYSTEM_CONFIG ))
         _molecularSystemConfig = vm[ PARAM_MOLECULAR_SYSTEM_CONFIG ].as< std::string >();
+    if( vm.count( PARAM_ASYNCHRONOUS_LOADING ))
+        _asynchronousLoading = vm[PARAM_ASYNCHRONOUS_LOADING].as< bool >();
+    if( vm.count( PARAM_LOADING_BATCH_SIZE ))
+        _loadingBatchSize =
+            std::max( vm[PARAM_LOADING_BATCH_SIZE].as< size_t >(), size_t( 1 ));
+    if( vm.count( PARAM_MORPHOLOGY_CACHE_FOLDER ))
+        _morphologyCacheFolder =
+            vm[PARAM_MORPHOLOGY_CACHE_FOLDER].as< std::string >();
 
     return true;
 }
@@ -267,6 +340,8 @@ void GeometryParameters::print()
         _NESTReport << std::endl;
     BRAYNS_INFO << "NEST cache file            : " <<
         _NESTCacheFile << std::endl;
+    BRAYNS_INFO << "NEST sparse spikes         : " <<
+        ( _NESTSparseSpikes ? "on" : "off" ) << std::endl;
     BRAYNS_INFO << "PDB file                   : " <<
         _pdbFile << std::endl;
     BRAYNS_INFO << "PDB folder                 : " <<
@@ -279,6 +354,10 @@ void GeometryParameters::print()
         _loadCacheFile << std::endl;
     BRAYNS_INFO << "Cache file to save         : " <<
         _saveCacheFile << std::endl;
+    BRAYNS_INFO << "Compress cache file        : " <<
+        ( _compressCacheFile ? "on" : "off" ) << std::endl;
+    BRAYNS_INFO << "Verify cache file          : " <<
+        ( _verifyCacheFile ? "on" : "off" ) << std::endl;
     BRAYNS_INFO << "Circuit configuration      : " <<
         _circuitConfig << std::endl;
     BRAYNS_INFO << "Color scheme               : " <<
@@ -307,6 +386,10 @@ void GeometryParameters::print()
         _simulationCacheFile << std::endl;
     BRAYNS_INFO << "- Simulation histogram size: " <<
         _simulationHistogramSize << std::endl;
+    BRAYNS_INFO << "- Simulation prefetching   : " <<
+        _simulationPrefetchFrames << std::endl;
+    BRAYNS_INFO << "- Simulation encoding      : " <<
+        getSimulationEncodingAsString( _simulationCacheEncoding ) << std::endl;
     BRAYNS_INFO << "Morphology section types   : " <<
         _morphologySectionTypes << std::endl;
     BRAYNS_INFO << "Morphology Layout          : " << std::endl;
@@ -318,10 +401,20 @@ void GeometryParameters::print()
         _morphologyLayout.horizontalSpacing << std::endl;
     BRAYNS_INFO << "Generate multiple models   : " <<
         (_generateMultipleModels ? "on" : "off") << std::endl;
+    BRAYNS_INFO << "Growth animation           : " <<
+        (_growthAnimation ? "on" : "off") << std::endl;
+    BRAYNS_INFO << "Sort primitives            : " <<
+        (_sortPrimitives ? "on" : "off") << std::endl;
     BRAYNS_INFO << "Splash scene folder        : " <<
         _splashSceneFolder << std::endl;
     BRAYNS_INFO << "Molecular system config    : " <<
         _molecularSystemConfig << std::endl;
+    BRAYNS_INFO << "Asynchronous loading       : " <<
+        ( _asynchronousLoading ? "on" : "off" ) << std::endl;
+    BRAYNS_INFO << "Loading batch size         : " <<
+        _loadingBatchSize << std::endl;
+    BRAYNS_INFO << "Morphology cache folder    : " <<
+        _morphologyCacheFolder << std::endl;
 }
 
 const std::string& GeometryParameters::getColorSchemeAsString(
@@ -342,4 +435,10 @@ const std::string& GeometryParameters::getGeometryQualityAsString(
     return GEOMETRY_QUALITIES[ static_cast< size_t >( value )];
 }
 
+const std::string& GeometryParameters::getSimulationEncodingAsString(
+    const SimulationEncoding value ) const
+{
+    return SIMULATION_ENCODINGS[ static_cast< size_t >( value )];
+}
+
 }
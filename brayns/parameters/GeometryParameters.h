@@ -71,6 +71,9 @@ public:
     std::string getNESTReport( ) const { return _NESTReport; }
     std::string getNESTCacheFile( ) const { return _NESTCacheFile; }
 
+    /** Spikes are kept in memory as events instead of being written to a cache file */
+    bool getNESTSparseSpikes() const { return _NESTSparseSpikes; }
+
     /** PDB file */
     std::string getPDBFile( ) const { return _pdbFile; }
 
@@ -92,6 +95,15 @@ public:
     /** Binary representation of a scene to save */
     std::string getSaveCacheFile( ) const { return _saveCacheFile; }
 
+    /** Compress the binary representation of the scene when saving it */
+    bool getCompressCacheFile( ) const { return _compressCacheFile; }
+
+    /**
+     * Verify the checksums of the binary representation of the scene when
+     * loading it
+     */
+    bool getVerifyCacheFile( ) const { return _verifyCacheFile; }
+
     /** Circuit target */
     std::string getTarget( ) const { return _target; }
 
@@ -153,10 +165,25 @@ public:
     /** Size of the simulation histogram */
     size_t getSimulationHistogramSize() const { return _simulationHistogramSize; }
 
+    /** Number of simulation frames read ahead of the current one */
+    size_t getSimulationPrefetchFrames() const { return _simulationPrefetchFrames; }
+
+    /** Encoding of the simulation cache files created by the loaders */
+    SimulationEncoding getSimulationCacheEncoding() const { return _simulationCacheEncoding; }
+    const std::string& getSimulationEncodingAsString( const SimulationEncoding value ) const;
+
     /** Defines if multiple models should be generated to increase the
         rendering performance */
     bool getGenerateMultipleModels() const { return _generateMultipleModels; }
 
+    /** Defines if the models of the timestamps should share the geometry of
+        the previous ones instead of holding a copy of it */
+    bool getGrowthAnimation() const { return _growthAnimation; }
+
+    /** Defines if primitives should be sorted in space before building the
+        geometry */
+    bool getSortPrimitives() const { return _sortPrimitives; }
+
     /** Splash scene folder */
     void setSplashSceneFolder( const std::string& value ) { _splashSceneFolder = value; }
     std::string getSplashSceneFolder() const { return _splashSceneFolder; }
@@ -164,6 +191,17 @@ public:
     /** Biological assembly */
     const std::string& getMolecularSystemConfig() const { return _molecularSystemConfig; }
 
+    /** Defines if the scene is loaded in the background while frames are
+        being rendered */
+    bool getAsynchronousLoading() const { return _asynchronousLoading; }
+
+    /** Number of cells loaded before their geometry is added to the scene */
+    size_t getLoadingBatchSize() const { return _loadingBatchSize; }
+
+    /** Folder where morphologies are cached, in the space of the morphology,
+        between runs. Morphologies are not persisted if empty */
+    const std::string& getMorphologyCacheFolder() const { return _morphologyCacheFolder; }
+
 protected:
 
     bool _parse( const po::variables_map& vm ) final;
@@ -172,6 +210,7 @@ protected:
     std::string _NESTCircuit;
     std::string _NESTReport;
     std::string _NESTCacheFile;
+    bool _NESTSparseSpikes;
     std::string _pdbFile;
     std::string _pdbFolder;
     std::string _xyzbFile;
@@ -195,9 +234,18 @@ protected:
     Vector2f _simulationValuesRange;
     std::string _simulationCacheFile;
     size_t _simulationHistogramSize;
+    size_t _simulationPrefetchFrames;
+    SimulationEncoding _simulationCacheEncoding;
     bool _generateMultipleModels;
+    bool _growthAnimation;
+    bool _sortPrimitives;
+    bool _compressCacheFile;
+    bool _verifyCacheFile;
     std::string _splashSceneFolder;
     std::string _molecularSystemConfig;
+    bool _asynchronousLoading;
+    size_t _loadingBatchSize;
+    std::string _morphologyCacheFolder;
 
 };
 
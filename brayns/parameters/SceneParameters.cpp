@@ -20,12 +20,15 @@
 
 #include "SceneParameters.h"
 
+#include <algorithm>
+
 namespace
 {
 
 const std::string PARAM_TIMESTAMP = "timestamp";
 const std::string PARAM_COLOR_MAP_FILE = "color-map-file";
 const std::string PARAM_ENVIRONMENT_MAP = "environment-map";
+const std::string PARAM_ANIMATION_SUBFRAMES = "animation-subframes";
 
 }
 
@@ -35,6 +38,7 @@ namespace brayns
 SceneParameters::SceneParameters()
     : AbstractParameters( "Scene" )
     , _timestamp( std::numeric_limits< float >::max())
+    , _animationSubframes( 1 )
 {
     _parameters.add_options()
         (PARAM_TIMESTAMP.c_str(), po::value< float >(),
@@ -42,7 +46,9 @@ SceneParameters::SceneParameters()
         (PARAM_COLOR_MAP_FILE.c_str(), po::value< std::string >(),
         "Color map filename [string]" )
         (PARAM_ENVIRONMENT_MAP.c_str(),
-            po::value< std::string >(), "Environment map filename [string]");
+            po::value< std::string >(), "Environment map filename [string]")
+        (PARAM_ANIMATION_SUBFRAMES.c_str(), po::value< size_t >(),
+        "Number of interpolated steps between two simulation frames when playing [int]");
 }
 
 bool SceneParameters::_parse( const po::variables_map& vm )
@@ -53,6 +59,9 @@ bool SceneParameters::_parse( const po::variables_map& vm )
         _colorMapFilename = vm[PARAM_COLOR_MAP_FILE].as< std::string >();
     if( vm.count( PARAM_ENVIRONMENT_MAP ))
         _environmentMap = vm[PARAM_ENVIRONMENT_MAP].as< std::string >();
+    if( vm.count( PARAM_ANIMATION_SUBFRAMES ))
+        _animationSubframes =
+            std::max( size_t( 1 ), vm[PARAM_ANIMATION_SUBFRAMES].as< size_t >( ));
     return true;
 }
 
@@ -62,6 +71,7 @@ void SceneParameters::print()
     BRAYNS_INFO << "Timestamp                :" << _timestamp << std::endl;
     BRAYNS_INFO << "Color Map filename       :" << _colorMapFilename << std::endl;
     BRAYNS_INFO << "Environment map filename : " << _environmentMap << std::endl;
+    BRAYNS_INFO << "Animation subframes      : " << _animationSubframes << std::endl;
 }
 
 }
@@ -45,6 +45,12 @@ public:
     void setAnimationDelta( const int32_t animation ) { _animation = animation; }
     int32_t getAnimationDelta() const { return _animation; }
 
+    /**
+       Number of steps to play a frame of the animation in. Timestamps in between two frames
+       blend the simulation values of these frames.
+    */
+    size_t getAnimationSubframes() const { return _animationSubframes; }
+
     const std::string& getColorMapFilename() const { return _colorMapFilename; }
 
     /**
@@ -61,6 +67,7 @@ protected:
 
     float _timestamp;
     int32_t _animation = 0;
+    size_t _animationSubframes;
     std::string _colorMapFilename;
     std::string _environmentMap;
 
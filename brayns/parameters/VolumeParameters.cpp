@@ -28,6 +28,10 @@ const std::string PARAM_VOLUME_DIMENSIONS = "volume-dimensions";
 const std::string PARAM_VOLUME_ELEMENT_SPACING = "volume-element-spacing";
 const std::string PARAM_VOLUME_OFFSET = "volume-offset";
 const std::string PARAM_VOLUME_SPR = "volume-samples-per-ray";
+const std::string PARAM_VOLUME_BRICK_SIZE = "volume-brick-size";
+const std::string PARAM_VOLUME_LEVEL = "volume-level";
+const std::string PARAM_VOLUME_CACHE_FOLDER = "volume-cache-folder";
+const std::string PARAM_VOLUME_GRADIENT_SHADING = "volume-gradient-shading";
 const size_t DEFAULT_SAMPLES_PER_RAY = 128;
 }
 
@@ -40,6 +44,9 @@ VolumeParameters::VolumeParameters()
     , _elementSpacing( 1.f, 1.f, 1.f )
     , _offset( 0.f, 0.f, 0.f )
     , _spr( DEFAULT_SAMPLES_PER_RAY )
+    , _brickSize( 0 )
+    , _level( 0 )
+    , _gradientShading( false )
 {
     _parameters.add_options()
         ( PARAM_VOLUME_FOLDER.c_str(), po::value< std::string >(),
@@ -53,7 +60,16 @@ VolumeParameters::VolumeParameters()
         ( PARAM_VOLUME_OFFSET.c_str(), po::value< floats >()->multitoken(),
             "Volume offset [int int int]" )
         ( PARAM_VOLUME_SPR.c_str(), po::value< size_t >(),
-            "Volume samples per ray [int]" );
+            "Volume samples per ray [int]" )
+        ( PARAM_VOLUME_BRICK_SIZE.c_str(), po::value< size_t >(),
+            "Size of the bricks the volume is split into, rounded up to a power of two. "
+            "0 keeps the raw layout [int]" )
+        ( PARAM_VOLUME_LEVEL.c_str(), po::value< size_t >(),
+            "Resolution level of bricked volumes, 0 being the full resolution [int]" )
+        ( PARAM_VOLUME_CACHE_FOLDER.c_str(), po::value< std::string >(),
+            "Folder where bricked volumes are cached [string]" )
+        ( PARAM_VOLUME_GRADIENT_SHADING.c_str(), po::value< bool >(),
+            "Enable/Disable shading of volumes using their gradient [bool]" );
 }
 
 bool VolumeParameters::_parse( const po::variables_map& vm )
@@ -84,6 +100,23 @@ bool VolumeParameters::_parse( const po::variables_map& vm )
     }
     if( vm.count( PARAM_VOLUME_SPR ))
         _spr = vm[PARAM_VOLUME_SPR].as< size_t >();
+    if( vm.count( PARAM_VOLUME_BRICK_SIZE ))
+    {
+        const size_t brickSize = vm[PARAM_VOLUME_BRICK_SIZE].as< size_t >();
+        _brickSize = 0;
+        if( brickSize > 0 )
+        {
+            _brickSize = 1;
+            while( _brickSize < brickSize )
+                _brickSize <<= 1;
+        }
+    }
+    if( vm.count( PARAM_VOLUME_LEVEL ))
+        _level = vm[PARAM_VOLUME_LEVEL].as< size_t >();
+    if( vm.count( PARAM_VOLUME_CACHE_FOLDER ))
+        _cacheFolder = vm[PARAM_VOLUME_CACHE_FOLDER].as< std::string >();
+    if( vm.count( PARAM_VOLUME_GRADIENT_SHADING ))
+        _gradientShading = vm[PARAM_VOLUME_GRADIENT_SHADING].as< bool >();
     return true;
 }
 
@@ -96,6 +129,10 @@ void VolumeParameters::print()
     BRAYNS_INFO << "Element spacing : " << _elementSpacing << std::endl;
     BRAYNS_INFO << "Offset          : " << _offset << std::endl;
     BRAYNS_INFO << "Samples per ray : " << _spr << std::endl;
+    BRAYNS_INFO << "Brick size      : " << _brickSize << std::endl;
+    BRAYNS_INFO << "Level           : " << _level << std::endl;
+    BRAYNS_INFO << "Cache folder    : " << _cacheFolder << std::endl;
+    BRAYNS_INFO << "Gradient shading: " << ( _gradientShading ? "on" : "off" ) << std::endl;
 }
 
 }
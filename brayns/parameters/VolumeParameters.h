@@ -54,6 +54,20 @@ public:
     void setSamplesPerRay( const size_t spr ) { _spr = spr; }
     size_t getSamplesPerRay() const { return _spr; }
 
+    /** Size of the bricks, a power of two. 0 if volumes are used in their raw layout */
+    size_t getBrickSize() const { return _brickSize; }
+
+    /** Resolution level of bricked volumes used for rendering */
+    void setLevel( const size_t level ) { _level = level; }
+    size_t getLevel() const { return _level; }
+
+    /** Folder where bricked volumes are cached */
+    const std::string& getCacheFolder() const { return _cacheFolder; }
+
+    /** Volume shading using the gradient of the volume as normal */
+    void setGradientShading( const bool value ) { _gradientShading = value; }
+    bool getGradientShading() const { return _gradientShading; }
+
 protected:
 
     bool _parse( const po::variables_map& vm ) final;
@@ -64,6 +78,10 @@ protected:
     Vector3f _elementSpacing;
     Vector3f _offset;
     size_t _spr;
+    size_t _brickSize;
+    size_t _level;
+    std::string _cacheFolder;
+    bool _gradientShading;
 
 };
 
@@ -72,6 +72,10 @@ void LivreScene::buildGeometry()
 {
 }
 
+void LivreScene::resetGeometry()
+{
+}
+
 void LivreScene::commitLights()
 {
 }
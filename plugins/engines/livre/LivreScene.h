@@ -45,6 +45,9 @@ public:
     /** Unsupported by Livre. */
     void buildGeometry() final;
 
+    /** Unsupported by Livre. */
+    void resetGeometry() final;
+
     /** Unsupported by Livre. */
     void commitLights() final;
 
@@ -78,14 +78,7 @@ void OptiXScene::reset()
 {
     Scene::reset();
 
-    // Geometry
-    for( auto geometryInstance: _geometryInstances)
-        geometryInstance->destroy();
-    _geometryInstances.clear();
-
-    if( _geometryGroup )
-        _geometryGroup->destroy();
-    _geometryGroup = nullptr;
+    resetGeometry();
 
     // Volume
     if( _volumeBuffer )
@@ -97,6 +90,32 @@ void OptiXScene::reset()
         _colorMapBuffer->destroy();
     _colorMapBuffer = nullptr;
 
+    // Lights
+    if( _lightBuffer )
+        _lightBuffer->destroy();
+    _lightBuffer = nullptr;
+
+    // Textures
+    for( auto optixTextures: _optixTextures )
+        optixTextures.second->destroy();
+    _optixTextures.clear();
+
+    for( auto optixTextureSamplers: _optixTextureSamplers )
+        optixTextureSamplers.second->destroy();
+    _optixTextureSamplers.clear();
+}
+
+void OptiXScene::resetGeometry()
+{
+    // Geometry
+    for( auto geometryInstance: _geometryInstances)
+        geometryInstance->destroy();
+    _geometryInstances.clear();
+
+    if( _geometryGroup )
+        _geometryGroup->destroy();
+    _geometryGroup = nullptr;
+
     // Spheres
     for( auto buffer: _spheresBuffers )
         buffer.second->destroy();
@@ -106,8 +125,6 @@ void OptiXScene::reset()
         optixSphere.second->destroy();
     _optixSpheres.clear();
 
-    _serializedSpheresData.clear();
-    _serializedSpheresDataSize.clear();
     _timestampSpheresIndices.clear();
 
     // Cylinders
@@ -119,9 +136,7 @@ void OptiXScene::reset()
         optixCylinder.second->destroy();
     _optixCylinders.clear();
 
-    _serializedCylindersData.clear();
     _timestampCylindersIndices.clear();
-    _serializedCylindersDataSize.clear();
 
     // Cones
     for( auto buffer: _conesBuffers )
@@ -132,8 +147,6 @@ void OptiXScene::reset()
         optixCone.second->destroy();
     _optixCones.clear();
 
-    _serializedConesData.clear();
-    _serializedConesDataSize.clear();
     _timestampConesIndices.clear();
 
     // Meshes
@@ -160,20 +173,6 @@ void OptiXScene::reset()
     if( _materialsBuffer )
         _materialsBuffer->destroy();
     _materialsBuffer = nullptr;
-
-    // Lights
-    if( _lightBuffer )
-        _lightBuffer->destroy();
-    _lightBuffer = nullptr;
-
-    // Textures
-    for( auto optixTextures: _optixTextures )
-        optixTextures.second->destroy();
-    _optixTextures.clear();
-
-    for( auto optixTextureSamplers: _optixTextureSamplers )
-        optixTextureSamplers.second->destroy();
-    _optixTextureSamplers.clear();
 }
 
 void OptiXScene::commit()
@@ -192,6 +191,9 @@ void OptiXScene::buildGeometry()
 
     _geometryInstances.clear();
 
+    // Instances are not shared with OptiX yet, and are expanded instead
+    _flattenInstancedGeometries();
+
     BRAYNS_INFO << "----------------------------------------" << std::endl;
     BRAYNS_INFO << "Data information:" << std::endl;
 
@@ -308,41 +310,24 @@ uint64_t OptiXScene::_processParametricGeometries()
         _timestampSpheresIndices[ materialId ] = 0;
         _timestampCylindersIndices[ materialId ] = 0;
         _timestampConesIndices[ materialId ] = 0;
-        if( _primitives.find( materialId ) != _primitives.end( ))
+        const auto it = _primitives.find( materialId );
+        if( it != _primitives.end( ))
         {
-            for( const auto& primitive: _primitives[materialId] )
-            {
-                switch( primitive->getGeometryType() )
-                {
-                    case GT_SPHERE:
-                    {
-                        primitive->serializeData( _serializedSpheresData[ materialId ] );
-                        ++_serializedSpheresDataSize[ materialId ];
-                        ++_timestampSpheresIndices[ materialId ];
-                    }
-                    break;
-                    case GT_CYLINDER:
-                    {
-                        primitive->serializeData( _serializedCylindersData[ materialId ] );
-                        ++_serializedCylindersDataSize[ materialId ];
-                        ++_timestampCylindersIndices[ materialId ];
-                    }
-                    break;
-                    case GT_CONE:
-                    {
-                        primitive->serializeData( _serializedConesData[ materialId ] );
-                        ++_serializedConesDataSize[ materialId ];
-                        ++_timestampConesIndices[ materialId ];
-                    }
-                    default:
-                        break;
-                }
-            }
+            // There is no rounded cone program, rounded cones are rendered
+            // as cones, which have the same memory layout, capped by a sphere
+            // at each end so that consecutive segments do not leave gaps
+            _timestampSpheresIndices[ materialId ] =
+                it->second.getSpheres().size() +
+                2 * it->second.getRoundedCones().size();
+            _timestampCylindersIndices[ materialId ] =
+                it->second.getCylinders().size();
+            _timestampConesIndices[ materialId ] =
+                it->second.getCones().size() +
+                it->second.getRoundedCones().size();
 
             totalNbSpheres += _timestampSpheresIndices[ materialId ];
             totalNbCylinders += _timestampCylindersIndices[ materialId ];
             totalNbCones += _timestampConesIndices[ materialId ];
-            _primitives[materialId].clear();
         }
 
         // Create spheres geometry
@@ -353,13 +338,23 @@ uint64_t OptiXScene::_processParametricGeometries()
             _optixSpheres[ materialId ]->setBoundingBoxProgram( spheresBoundsProgram );
             _optixSpheres[ materialId ]->setIntersectionProgram( spheresIntersectProgram );
             uint64_t size = _timestampSpheresIndices[ materialId ] *
-                Sphere::getSerializationSize();
+                ( sizeof( Sphere ) / sizeof( float ));
             _spheresBuffers[ materialId ] =
                 _context->createBuffer( RT_BUFFER_INPUT, RT_FORMAT_FLOAT, size );
-            memcpy(
-                _spheresBuffers[ materialId ]->map(),
-                &_serializedSpheresData[ materialId ][ 0 ],
-                size * sizeof(float));
+            const Spheres& spheres = _primitives[ materialId ].getSpheres();
+            const RoundedCones& roundedCones =
+                _primitives[ materialId ].getRoundedCones();
+            Sphere* spheresData =
+                static_cast< Sphere* >( _spheresBuffers[ materialId ]->map( ));
+            memcpy( spheresData, spheres.data(), spheres.size() * sizeof( Sphere ));
+            Sphere* caps = spheresData + spheres.size();
+            for( const RoundedCone& cone: roundedCones )
+            {
+                *caps++ = { cone.center, cone.centerRadius, cone.timestamp,
+                            cone.value };
+                *caps++ = { cone.up, cone.upRadius, cone.timestamp,
+                            cone.value };
+            }
             _spheresBuffers[ materialId ]->unmap();
             _optixSpheres[ materialId ][ "spheres" ]->setBuffer(
                 _spheresBuffers[ materialId ] );
@@ -368,7 +363,6 @@ uint64_t OptiXScene::_processParametricGeometries()
                     _optixSpheres[ materialId ],
                     &_optixMaterials[ materialId ],
                     &_optixMaterials[ materialId ]+1 ) );
-            _serializedSpheresData[ materialId ].clear();
         }
 
         // Create cylinders geometry
@@ -379,13 +373,13 @@ uint64_t OptiXScene::_processParametricGeometries()
             _optixCylinders[ materialId ]->setBoundingBoxProgram( cylindersBoundsProgram );
             _optixCylinders[ materialId ]->setIntersectionProgram( cylindersIntersectProgram );
             uint64_t size = _timestampCylindersIndices[ materialId ] *
-                Cylinder::getSerializationSize();
+                ( sizeof( Cylinder ) / sizeof( float ));
             _cylindersBuffers[ materialId ] =
                 _context->createBuffer( RT_BUFFER_INPUT, RT_FORMAT_FLOAT, size );
             memcpy(
                 _cylindersBuffers[ materialId ]->map(),
-                &_serializedCylindersData[ materialId ][ 0 ],
-                size * sizeof(float));
+                _primitives[ materialId ].getCylinders().data(),
+                size * sizeof(float) );
             _cylindersBuffers[ materialId ]->unmap();
             _optixCylinders[ materialId ][ "cylinders" ]->setBuffer(
                 _cylindersBuffers[ materialId ] );
@@ -394,7 +388,6 @@ uint64_t OptiXScene::_processParametricGeometries()
                     _optixCylinders[ materialId ],
                     &_optixMaterials[ materialId ],
                     &_optixMaterials[ materialId ]+1 ) );
-            _serializedCylindersData[ materialId ].clear();
         }
 
         // Create cones geometry
@@ -405,13 +398,17 @@ uint64_t OptiXScene::_processParametricGeometries()
             _optixCones[ materialId ]->setBoundingBoxProgram( conesBoundsProgram );
             _optixCones[ materialId ]->setIntersectionProgram( conesIntersectProgram );
             uint64_t size = _timestampConesIndices[ materialId ] *
-                Cone::getSerializationSize();
+                ( sizeof( Cone ) / sizeof( float ));
             _conesBuffers[ materialId ] =
                 _context->createBuffer( RT_BUFFER_INPUT, RT_FORMAT_FLOAT, size );
-            memcpy(
-                _conesBuffers[ materialId ]->map(),
-                &_serializedConesData[ materialId ][ 0 ],
-                size * sizeof(float) );
+            const Cones& cones = _primitives[ materialId ].getCones();
+            const RoundedCones& roundedCones =
+                _primitives[ materialId ].getRoundedCones();
+            uint8_t* conesData =
+                static_cast< uint8_t* >( _conesBuffers[ materialId ]->map( ));
+            memcpy( conesData, cones.data(), cones.size() * sizeof( Cone ));
+            memcpy( conesData + cones.size() * sizeof( Cone ),
+                roundedCones.data(), roundedCones.size() * sizeof( RoundedCone ));
             _conesBuffers[ materialId ]->unmap();
             _optixCones[ materialId ][ "cones" ]->setBuffer(
                 _conesBuffers[ materialId ] );
@@ -420,16 +417,19 @@ uint64_t OptiXScene::_processParametricGeometries()
                     _optixCones[ materialId ],
                     &_optixMaterials[ materialId ],
                     &_optixMaterials[ materialId ]+1 ) );
-            _serializedConesData[ materialId ].clear();
          }
+
+        // Geometry now lives on the GPU
+        if( it != _primitives.end( ))
+            it->second.clear();
     }
 
     const uint64_t spheresMemSize =
-        totalNbSpheres * Sphere::getSerializationSize() * sizeof(float);
+        totalNbSpheres * sizeof( Sphere );
     const uint64_t cylindersMemSize =
-        totalNbCylinders * Cylinder::getSerializationSize() * sizeof(float);
+        totalNbCylinders * sizeof( Cylinder );
     const uint64_t conesMemSize =
-        totalNbCones * Cone::getSerializationSize() * sizeof(float);
+        totalNbCones * sizeof( Cone );
     const uint64_t bvhSize = _getBvhSize( totalNbSpheres + totalNbCylinders + totalNbCones );
 
     BRAYNS_INFO << "- Spheres   : " << totalNbSpheres
@@ -62,6 +62,9 @@ public:
     /** @copydoc Scene::buildGeometry */
     void buildGeometry() final;
 
+    /** @copydoc Scene::resetGeometry */
+    void resetGeometry() final;
+
     /** @copydoc Scene::commitLights */
     void commitLights() final;
 
@@ -103,22 +106,16 @@ private:
     optix::Buffer _colorMapBuffer;
 
     // Spheres
-    std::map< size_t, floats > _serializedSpheresData;
-    std::map< size_t, size_t > _serializedSpheresDataSize;
     std::map< size_t, size_t > _timestampSpheresIndices;
     std::map< size_t, optix::Buffer > _spheresBuffers;
     std::map< size_t, optix::Geometry > _optixSpheres;
 
     // Cylinders
-    std::map< size_t, floats > _serializedCylindersData;
-    std::map< size_t, size_t > _serializedCylindersDataSize;
     std::map< size_t, size_t > _timestampCylindersIndices;
     std::map< size_t, optix::Buffer > _cylindersBuffers;
     std::map< size_t, optix::Geometry > _optixCylinders;
 
     // Cones
-    std::map< size_t, floats > _serializedConesData;
-    std::map< size_t, size_t > _serializedConesDataSize;
     std::map< size_t, size_t > _timestampConesIndices;
     std::map< size_t, optix::Buffer > _conesBuffers;
     std::map< size_t, optix::Geometry > _optixCones;
@@ -20,6 +20,7 @@
 
 #include "OSPRayScene.h"
 #include "OSPRayRenderer.h"
+#include "OSPRaySceneCache.h"
 
 #include <brayns/common/log.h>
 #include <brayns/parameters/SceneParameters.h>
@@ -31,17 +32,467 @@
 #include <brayns/common/volume/VolumeHandler.h>
 #include <brayns/io/TextureLoader.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace brayns
 {
 
-const size_t CACHE_VERSION = 6;
-
 struct TextureTypeMaterialAttribute
 {
     TextureType type;
     std::string attribute;
 };
 
+namespace
+{
+const int NO_DESCRIPTOR = -1;
+
+// Must match VOLUME_MAX_STEP_FACTOR in the renderers
+const size_t NB_VOLUME_STEP_FACTORS = 4;
+
+// Maximum number of primitives of a geometry, so that the byte offsets of all
+// its primitives fit in the 32 bit varying addressing of the ISPC kernels
+const size_t MAX_PRIMITIVES_PER_GEOMETRY = 1 << 25;
+
+// Radix sort of the Morton codes: bits per pass, and number of blocks of keys
+// processed in parallel
+const size_t RADIX_SORT_DIGIT_BITS = 8;
+const size_t RADIX_SORT_NB_DIGITS = 1 << RADIX_SORT_DIGIT_BITS;
+const size_t MAX_RADIX_SORT_BLOCKS = 256;
+const size_t MIN_RADIX_SORT_BLOCK_SIZE = 65536;
+
+// Maximum number of buckets the primitives are split into for growth
+// animations
+const size_t NB_GROWTH_BUCKETS = 64;
+
+/**
+ * For every timestamp, keeps the number of primitives to consider when
+ * building the model of that timestamp
+ */
+template< typename T >
+void setTimestampIndices(
+    const std::vector< T >& primitives,
+    const bool singleModel,
+    std::map< size_t, size_t >& indices )
+{
+    for( size_t i = 0; i < primitives.size(); ++i )
+    {
+        const size_t ts = singleModel ? 0 : primitives[i].timestamp;
+        indices[ts] = i + 1;
+    }
+}
+
+template< typename T >
+GeometryBuffer makeBuffer( const std::vector< T >& values )
+{
+    return { values.data(), values.size() * sizeof( T ) };
+}
+
+void setMeshBuffers( TrianglesMesh& mesh, GeometryBuffers& buffers )
+{
+    buffers[CBT_VERTICES] = makeBuffer( mesh.getVertices( ));
+    buffers[CBT_INDICES] = makeBuffer( mesh.getIndices( ));
+    buffers[CBT_NORMALS] = makeBuffer( mesh.getNormals( ));
+    buffers[CBT_COLORS] = makeBuffer( mesh.getColors( ));
+    buffers[CBT_TEXTURE_COORDINATES] =
+        makeBuffer( mesh.getTextureCoordinates( ));
+}
+
+osp::affine3f toAffine( const Matrix4f& matrix )
+{
+    osp::affine3f affine;
+    affine.l.vx = { matrix( 0, 0 ), matrix( 1, 0 ), matrix( 2, 0 ) };
+    affine.l.vy = { matrix( 0, 1 ), matrix( 1, 1 ), matrix( 2, 1 ) };
+    affine.l.vz = { matrix( 0, 2 ), matrix( 1, 2 ), matrix( 2, 2 ) };
+    affine.p = { matrix( 0, 3 ), matrix( 1, 3 ), matrix( 2, 3 ) };
+    return affine;
+}
+
+std::vector< CacheTimestampIndex > toCacheIndices(
+    const std::map< size_t, size_t >& indices )
+{
+    std::vector< CacheTimestampIndex > cacheIndices;
+    for( const auto& index: indices )
+        cacheIndices.push_back( { index.first, index.second } );
+    return cacheIndices;
+}
+
+typedef std::vector< OSPGeometry > OSPGeometries;
+
+/**
+ * Creates the geometries of nbPrimitives primitives of type T. Geometries hold
+ * at most MAX_PRIMITIVES_PER_GEOMETRY primitives, larger arrays are split in
+ * consecutive ranges.
+ */
+template< typename T >
+OSPGeometries createGeometries(
+    const void* primitives,
+    const size_t nbPrimitives,
+    const std::function< OSPGeometry( const void*, size_t )>& createGeometry )
+{
+    OSPGeometries geometries;
+    const T* data = static_cast< const T* >( primitives );
+    for( size_t first = 0; first < nbPrimitives;
+         first += MAX_PRIMITIVES_PER_GEOMETRY )
+    {
+        geometries.push_back( createGeometry( data + first,
+            std::min( nbPrimitives - first, MAX_PRIMITIVES_PER_GEOMETRY )));
+    }
+    return geometries;
+}
+
+Vector3f getCentroid( const Sphere& sphere ) { return sphere.center; }
+Vector3f getCentroid( const Cylinder& cylinder )
+{
+    return ( cylinder.center + cylinder.up ) * 0.5f;
+}
+Vector3f getCentroid( const Cone& cone )
+{
+    return ( cone.center + cone.up ) * 0.5f;
+}
+Vector3f getCentroid( const RoundedCone& cone )
+{
+    return ( cone.center + cone.up ) * 0.5f;
+}
+
+/** @return the bits of value, interleaved with two zero bits */
+uint64_t spreadMortonBits( uint64_t value )
+{
+    value &= 0x1fffff;
+    value = ( value | value << 32 ) & 0x1f00000000ffff;
+    value = ( value | value << 16 ) & 0x1f0000ff0000ff;
+    value = ( value | value << 8 ) & 0x100f00f00f00f00f;
+    value = ( value | value << 4 ) & 0x10c30c30c30c30c3;
+    value = ( value | value << 2 ) & 0x1249249249249249;
+    return value;
+}
+
+typedef std::pair< uint64_t, size_t > MortonKey;
+
+size_t getDigit( const MortonKey& key, const size_t shift )
+{
+    return ( key.first >> shift ) & ( RADIX_SORT_NB_DIGITS - 1 );
+}
+
+/**
+ * Sorts keys by Morton code with a least significant digit radix sort, 8 bits
+ * per pass. Every pass counts the digits of blocks of keys in parallel, then
+ * moves the blocks in parallel to the positions deduced from the counts, which
+ * keeps the sort stable. Passes over digits shared by all keys are skipped.
+ */
+void radixSort( std::vector< MortonKey >& keys )
+{
+    const size_t nbKeys = keys.size();
+    const size_t nbBlocks = std::max< size_t >( 1,
+        std::min( MAX_RADIX_SORT_BLOCKS, nbKeys / MIN_RADIX_SORT_BLOCK_SIZE ));
+    const size_t blockSize = ( nbKeys + nbBlocks - 1 ) / nbBlocks;
+    std::vector< MortonKey > buffer( nbKeys );
+    std::vector< size_t > offsets( nbBlocks * RADIX_SORT_NB_DIGITS );
+
+    for( size_t shift = 0; shift < 64; shift += RADIX_SORT_DIGIT_BITS )
+    {
+        std::fill( offsets.begin(), offsets.end(), 0 );
+        #pragma omp parallel for
+        for( size_t block = 0; block < nbBlocks; ++block )
+        {
+            size_t* counts = &offsets[block * RADIX_SORT_NB_DIGITS];
+            const size_t end = std::min( nbKeys, ( block + 1 ) * blockSize );
+            for( size_t i = block * blockSize; i < end; ++i )
+                ++counts[getDigit( keys[i], shift )];
+        }
+
+        // Keys of a digit go after the keys of the smaller digits, and after
+        // the keys of that digit found in the previous blocks
+        size_t offset = 0;
+        bool sorted = false;
+        for( size_t digit = 0; digit < RADIX_SORT_NB_DIGITS; ++digit )
+        {
+            const size_t first = offset;
+            for( size_t block = 0; block < nbBlocks; ++block )
+            {
+                size_t& count = offsets[block * RADIX_SORT_NB_DIGITS + digit];
+                const size_t position = offset;
+                offset += count;
+                count = position;
+            }
+            sorted = sorted || offset - first == nbKeys;
+        }
+        if( sorted )
+            continue;
+
+        #pragma omp parallel for
+        for( size_t block = 0; block < nbBlocks; ++block )
+        {
+            size_t* positions = &offsets[block * RADIX_SORT_NB_DIGITS];
+            const size_t end = std::min( nbKeys, ( block + 1 ) * blockSize );
+            for( size_t i = block * blockSize; i < end; ++i )
+                buffer[positions[getDigit( keys[i], shift )]++] = keys[i];
+        }
+        keys.swap( buffer );
+    }
+}
+
+/** @return the Morton code of a centroid, quantized on 21 bits per axis */
+uint64_t getMortonCode(
+    const Vector3f& centroid,
+    const Vector3f& origin,
+    const Vector3f& scale )
+{
+    const Vector3f position = ( centroid - origin ) * scale;
+    return spreadMortonBits( uint64_t( position.x( ))) |
+           spreadMortonBits( uint64_t( position.y( ))) << 1 |
+           spreadMortonBits( uint64_t( position.z( ))) << 2;
+}
+
+/**
+ * Sorts primitives along the Z-order curve of their centroids, quantized
+ * within the bounds of the centroids, so that primitives that are consecutive
+ * in the array are close in space. The primitives of a group stay in a single
+ * range: groups, and primitives that belong to no group, are sorted by the
+ * Morton code of their centroid, then the primitives of every group by their
+ * own Morton code. The ranges of the groups, given by the first and count
+ * members, are moved to the new position of their primitives.
+ */
+template< typename T >
+void sortByMortonCode(
+    std::vector< T >& primitives,
+    const std::vector< PrimitivesGroup* >& groups,
+    size_t PrimitivesGroup::* first,
+    size_t PrimitivesGroup::* count )
+{
+    const size_t nbPrimitives = primitives.size();
+    const size_t nbGroups = groups.size();
+
+    Boxf bounds;
+    for( const T& primitive: primitives )
+        bounds.merge( getCentroid( primitive ));
+    const Vector3f size = bounds.getSize();
+    const Vector3f& origin = bounds.getMin();
+    Vector3f scale;
+    for( size_t i = 0; i < 3; ++i )
+        scale[i] = size[i] > 0.f ? float( 0x1fffff ) / size[i] : 0.f;
+
+    // Every group is a segment of the array, and every primitive that belongs
+    // to no group is a segment of its own
+    const size_t noSegment = nbGroups + nbPrimitives;
+    std::vector< size_t > segments( nbPrimitives, noSegment );
+    std::vector< Vector3f > centroids( nbGroups, Vector3f( 0.f ));
+    for( size_t group = 0; group < nbGroups; ++group )
+    {
+        const size_t begin = groups[group]->*first;
+        const size_t end = begin + groups[group]->*count;
+        for( size_t i = begin; i < end; ++i )
+        {
+            segments[i] = group;
+            centroids[group] += getCentroid( primitives[i] );
+        }
+    }
+    size_t nbSegments = nbGroups;
+    for( size_t& segment: segments )
+        if( segment == noSegment )
+            segment = nbSegments++;
+
+    std::vector< MortonKey > segmentKeys( nbSegments );
+    for( size_t group = 0; group < nbGroups; ++group )
+    {
+        const size_t groupSize = groups[group]->*count;
+        segmentKeys[group].first = groupSize == 0 ? 0 : getMortonCode(
+            centroids[group] / float( groupSize ), origin, scale );
+        segmentKeys[group].second = group;
+    }
+
+    std::vector< MortonKey > keys( nbPrimitives );
+    #pragma omp parallel for
+    for( size_t i = 0; i < nbPrimitives; ++i )
+    {
+        keys[i].first = getMortonCode( getCentroid( primitives[i] ), origin,
+                                       scale );
+        keys[i].second = i;
+        if( segments[i] >= nbGroups )
+            segmentKeys[segments[i]] = { keys[i].first, segments[i] };
+    }
+
+    radixSort( segmentKeys );
+    std::vector< size_t > ranks( nbSegments );
+    for( size_t rank = 0; rank < nbSegments; ++rank )
+        ranks[segmentKeys[rank].second] = rank;
+
+    // Primitives sorted by Morton code, then by rank of their segment. The
+    // radix sort is stable, the primitives of a segment stay in Morton order
+    radixSort( keys );
+    #pragma omp parallel for
+    for( size_t i = 0; i < nbPrimitives; ++i )
+        keys[i].first = ranks[segments[keys[i].second]];
+    radixSort( keys );
+
+    std::vector< T > sorted( nbPrimitives );
+    #pragma omp parallel for
+    for( size_t i = 0; i < nbPrimitives; ++i )
+        sorted[i] = primitives[keys[i].second];
+    primitives.swap( sorted );
+
+    for( size_t i = 0; i < nbPrimitives; ++i )
+    {
+        const size_t segment = segments[keys[i].second];
+        if( segment < nbGroups &&
+            ( i == 0 || segments[keys[i - 1].second] != segment ))
+            groups[segment]->*first = i;
+    }
+}
+
+/**
+ * Reorders primitives by growth bucket, keeping their order within a bucket,
+ * so that every bucket is a range of the array. births holds the smallest
+ * timestamp of every bucket, in increasing order. The primitives that a group
+ * holds in a bucket are contiguous once reordered, and become the range of the
+ * group of that bucket in splitGroups, that holds nbBuckets groups for every
+ * group.
+ * @return the offset of every bucket in the array, followed by its size
+ */
+template< typename T >
+std::vector< size_t > sortInGrowthBuckets(
+    std::vector< T >& primitives,
+    const floats& births,
+    const std::vector< size_t >& groups,
+    const PrimitivesGroups& allGroups,
+    std::vector< PrimitivesGroups >& splitGroups,
+    size_t PrimitivesGroup::* first,
+    size_t PrimitivesGroup::* count )
+{
+    const size_t nbPrimitives = primitives.size();
+    std::vector< size_t > buckets( nbPrimitives );
+    std::vector< size_t > offsets( births.size() + 1, 0 );
+    for( size_t i = 0; i < nbPrimitives; ++i )
+    {
+        buckets[i] = std::upper_bound( births.begin(), births.end(),
+            primitives[i].timestamp ) - births.begin() - 1;
+        ++offsets[buckets[i] + 1];
+    }
+    for( size_t bucket = 0; bucket < births.size(); ++bucket )
+        offsets[bucket + 1] += offsets[bucket];
+
+    std::vector< size_t > positions( offsets.begin(), offsets.end() - 1 );
+    std::vector< size_t > newIndices( nbPrimitives );
+    for( size_t i = 0; i < nbPrimitives; ++i )
+        newIndices[i] = positions[buckets[i]]++;
+
+    for( const size_t group: groups )
+    {
+        const size_t begin = allGroups[group].*first;
+        const size_t end = begin + allGroups[group].*count;
+        for( size_t i = begin; i < end; ++i )
+        {
+            PrimitivesGroup& split = splitGroups[group][buckets[i]];
+            if( split.*count == 0 )
+                split.*first = newIndices[i];
+            ++( split.*count );
+        }
+    }
+
+    // Permutation applied in place, cycle by cycle
+    for( size_t i = 0; i < nbPrimitives; ++i )
+        while( newIndices[i] != i )
+        {
+            const size_t j = newIndices[i];
+            std::swap( primitives[i], primitives[j] );
+            std::swap( newIndices[i], newIndices[j] );
+        }
+    return offsets;
+}
+
+/** Offsets of the growth buckets in the arrays of primitives of a material */
+struct GrowthBucketOffsets
+{
+    std::vector< size_t > spheres;
+    std::vector< size_t > cylinders;
+    std::vector< size_t > cones;
+    std::vector< size_t > roundedCones;
+};
+
+template< typename T >
+GeometryBuffer makeBucketBuffer(
+    const std::vector< T >& values,
+    const std::vector< size_t >& offsets,
+    const size_t bucket )
+{
+    return { values.data() + offsets[bucket],
+             ( offsets[bucket + 1] - offsets[bucket] ) * sizeof( T ) };
+}
+
+void setPrimitivesBuffers( const Primitives& primitives,
+                           GeometryBuffers& buffers )
+{
+    buffers[CBT_SPHERES] = makeBuffer( primitives.getSpheres( ));
+    buffers[CBT_CYLINDERS] = makeBuffer( primitives.getCylinders( ));
+    buffers[CBT_CONES] = makeBuffer( primitives.getCones( ));
+    buffers[CBT_ROUNDED_CONES] = makeBuffer( primitives.getRoundedCones( ));
+}
+
+void readCacheIndices(
+    const GeometryBuffer& buffer,
+    const size_t nbPrimitives,
+    std::map< size_t, size_t >& indices )
+{
+    const CacheTimestampIndex* cacheIndices =
+        static_cast< const CacheTimestampIndex* >( buffer.data );
+    const size_t nbIndices = buffer.size / sizeof( CacheTimestampIndex );
+    for( size_t i = 0; i < nbIndices; ++i )
+        indices[cacheIndices[i].timestamp] =
+            std::min< size_t >( cacheIndices[i].count, nbPrimitives );
+}
+
+uint64_t alignCacheOffset( const uint64_t offset )
+{
+    return ( offset + CACHE_ALIGNMENT - 1 ) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+/** Chunk of data to be written to the cache file */
+struct CacheChunk
+{
+    GeometryBuffer buffer;
+    CacheBuffer* entry;
+};
+
+/**
+ * Block of a chunk read from the cache file. Blocks of chunks that are used
+ * in place have no destination, and are only verified.
+ */
+struct CacheBlockRead
+{
+    const CacheBlock* block;
+    uint64_t size;
+    char* dst;
+};
+
+bool writeToFile(
+    const int descriptor,
+    const void* data,
+    uint64_t size,
+    uint64_t offset )
+{
+    const char* bytes = static_cast< const char* >( data );
+    while( size > 0 )
+    {
+        const ssize_t written = ::pwrite( descriptor, bytes, size, offset );
+        if( written <= 0 )
+            return false;
+        bytes += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+}
+
 static TextureTypeMaterialAttribute textureTypeMaterialAttribute[6] =
 {
     {TT_DIFFUSE, "map_kd"},
@@ -59,9 +510,21 @@ OSPRayScene::OSPRayScene(
     , _ospLightData( 0 )
     , _ospMaterialData( 0 )
     , _ospVolumeData( 0 )
+    , _ospVolumeDataPtr( 0 )
+    , _ospVolumeDataSize( 0 )
+    , _ospVolumeMacroCellData( 0 )
+    , _volumeMacroCellMargin( 0 )
+    , _ospVolumeOpacityData( 0 )
+    , _volumeOpacityCorrection( 0.f )
     , _ospSimulationData( 0 )
+    , _ospSimulationDataPtr( 0 )
+    , _ospSimulationDataSize( 0 )
+    , _simulationTimestamp( 0.f )
     , _ospTransferFunctionDiffuseData( 0 )
     , _ospTransferFunctionEmissionData( 0 )
+    , _primitivesSorted( false )
+    , _cacheMemoryMapPtr( 0 )
+    , _cacheSize( 0 )
 {
 }
 
@@ -69,22 +532,25 @@ void OSPRayScene::reset()
 {
     Scene::reset();
 
-    _models.clear();
+    resetGeometry();
+    _unmapCacheFile();
+    _primitivesSorted = false;
 
     _ospMaterials.clear();
     _ospTextures.clear();
     _ospLights.clear();
+}
 
-    _serializedSpheresData.clear();
-    _serializedCylindersData.clear();
-    _serializedConesData.clear();
-    _serializedSpheresDataSize.clear();
-    _serializedCylindersDataSize.clear();
-    _serializedConesDataSize.clear();
+void OSPRayScene::resetGeometry()
+{
+    for( auto model: _models )
+        ospRelease( model.second );
+    _models.clear();
 
     _timestampSpheresIndices.clear();
     _timestampCylindersIndices.clear();
     _timestampConesIndices.clear();
+    _timestampRoundedConesIndices.clear();
 }
 
 void OSPRayScene::commit()
@@ -108,477 +574,1101 @@ OSPModel* OSPRayScene::modelImpl( const size_t timestamp )
 }
 
 
+OSPRayScene::~OSPRayScene()
+{
+    _unmapCacheFile();
+}
+
+GeometryBuffers OSPRayScene::_getGeometryBuffers( const size_t materialId )
+{
+    GeometryBuffers buffers{};
+
+    const auto primitives = _primitives.find( materialId );
+    if( primitives != _primitives.end( ))
+        setPrimitivesBuffers( primitives->second, buffers );
+
+    const auto mesh = _trianglesMeshes.find( materialId );
+    if( mesh != _trianglesMeshes.end( ))
+        setMeshBuffers( mesh->second, buffers );
+    return buffers;
+}
+
 void OSPRayScene::_saveCacheFile()
 {
-    const std::string& filename = _parametersManager.getGeometryParameters().getSaveCacheFile();
+    const auto& geometryParameters = _parametersManager.getGeometryParameters();
+    const std::string& filename = geometryParameters.getSaveCacheFile();
     BRAYNS_INFO << "Saving scene to binary file: " << filename << std::endl;
-    std::ofstream file( filename, std::ios::out | std::ios::binary );
 
-    const size_t version = CACHE_VERSION;
-    file.write( ( char* )&version, sizeof( size_t ));
-    BRAYNS_INFO << "Version: " << version << std::endl;
+    if( !_instancedGeometries.empty( ))
+        BRAYNS_WARN << "Instanced geometries are not saved to cache files"
+                    << std::endl;
 
-    const size_t nbModels = _models.size();
-    file.write( ( char* )&nbModels, sizeof( size_t ));
-    BRAYNS_INFO << nbModels << " models" << std::endl;
-    for( const auto& model: _models )
-        file.write( ( char* )&model.first, sizeof( size_t ));
+    bool compress = geometryParameters.getCompressCacheFile();
+#ifndef BRAYNS_USE_LZ4
+    if( compress )
+    {
+        BRAYNS_WARN << "LZ4 is required to compress cache files, "
+                    << "saving uncompressed data" << std::endl;
+        compress = false;
+    }
+#endif
 
+    // Materials, and the textures they reference
     const size_t nbMaterials = _materials.size();
-    file.write( ( char* )&nbMaterials, sizeof( size_t ));
-    BRAYNS_INFO << nbMaterials << " materials" << std::endl;
-
-    // Save materials
-    for( const auto& material: _materials )
-    {
-        Vector3f value3f;
-        value3f = material->getColor();
-        file.write( ( char* )&value3f, sizeof( Vector3f ));
-        value3f = material->getSpecularColor();
-        file.write( ( char* )&value3f, sizeof( Vector3f ));
-        float value = material->getSpecularExponent();
-        file.write( ( char* )&value, sizeof( float ));
-        value = material->getReflectionIndex();
-        file.write( ( char* )&value, sizeof( float ));
-        value = material->getOpacity();
-        file.write( ( char* )&value, sizeof( float ));
-        value = material->getRefractionIndex();
-        file.write( ( char* )&value, sizeof( float ));
-        value = material->getEmission();
-        file.write( ( char* )&value, sizeof( float ));
-        // TODO: Textures
-    }
-
-    // Save geometry
+    std::vector< CacheMaterial > cacheMaterials( nbMaterials );
+    std::vector< std::string > textureNames;
+    std::map< std::string, int32_t > textureIds;
     for( size_t materialId = 0; materialId < nbMaterials; ++materialId )
     {
-        size_t bufferSize;
-
-        // Spheres
-        bufferSize = _timestampSpheresIndices[materialId].size();
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        for( const auto& index: _timestampSpheresIndices[materialId] )
+        MaterialPtr material = _materials[materialId];
+        CacheMaterial& cacheMaterial = cacheMaterials[materialId];
+        for( size_t i = 0; i < 3; ++i )
         {
-            file.write( ( char* )&index.first, sizeof( size_t ));
-            file.write( ( char* )&index.second, sizeof( size_t ));
+            cacheMaterial.color[i] = material->getColor()[i];
+            cacheMaterial.specularColor[i] = material->getSpecularColor()[i];
         }
-
-        bufferSize =
-            _serializedSpheresDataSize[materialId] *
-            Sphere::getSerializationSize() *
-            sizeof( float );
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        file.write( ( char* )_serializedSpheresData[materialId].data(),
-            bufferSize );
-        if( bufferSize != 0 )
-            BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedSpheresDataSize[materialId]
-                         << " Spheres" << std::endl;
-
-        // Cylinders
-        bufferSize = _timestampCylindersIndices[materialId].size();
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        for( const auto& index: _timestampCylindersIndices[materialId] )
+        cacheMaterial.specularExponent = material->getSpecularExponent();
+        cacheMaterial.reflectionIndex = material->getReflectionIndex();
+        cacheMaterial.opacity = material->getOpacity();
+        cacheMaterial.refractionIndex = material->getRefractionIndex();
+        cacheMaterial.emission = material->getEmission();
+
+        for( size_t type = 0; type < CACHE_NB_TEXTURE_TYPES; ++type )
+            cacheMaterial.textures[type] = CACHE_NO_TEXTURE;
+        for( const auto& texture: material->getTextures( ))
         {
-            file.write( ( char* )&index.first, sizeof( size_t ));
-            file.write( ( char* )&index.second, sizeof( size_t ));
+            auto textureId = textureIds.find( texture.second );
+            if( textureId == textureIds.end( ))
+            {
+                textureId = textureIds.insert(
+                    { texture.second, int32_t( textureNames.size( )) } ).first;
+                textureNames.push_back( texture.second );
+            }
+            cacheMaterial.textures[texture.first] = textureId->second;
         }
+    }
+    const size_t nbTextures = textureNames.size();
+
+    CacheHeader header{};
+    memcpy( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ));
+    header.version = CACHE_VERSION;
+    header.nbModels = _models.size();
+    header.nbMaterials = nbMaterials;
+    header.nbTextures = nbTextures;
+    header.modelsOffset = sizeof( CacheHeader );
+    header.materialsOffset =
+        header.modelsOffset + header.nbModels * sizeof( uint64_t );
+    header.sectionsOffset =
+        header.materialsOffset + nbMaterials * sizeof( CacheMaterial );
+    header.texturesOffset =
+        header.sectionsOffset + nbMaterials * sizeof( CacheSection );
+    header.transferFunctionOffset =
+        header.texturesOffset + nbTextures * sizeof( CacheTexture );
+    for( size_t i = 0; i < 3; ++i )
+    {
+        header.bounds[i] = _bounds.getMin()[i];
+        header.bounds[i + 3] = _bounds.getMax()[i];
+    }
 
-        bufferSize =
-            _serializedCylindersDataSize[materialId] *
-            Cylinder::getSerializationSize() *
-            sizeof( float );
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        file.write( ( char* )_serializedCylindersData[materialId].data(),
-            bufferSize );
-        if( bufferSize != 0 )
-            BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedCylindersDataSize[materialId]
-                         << " Cylinders" << std::endl;
+    std::vector< uint64_t > timestamps;
+    for( const auto& model: _models )
+        timestamps.push_back( model.first );
 
-        // Cones
-        bufferSize = _timestampConesIndices[materialId].size();
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        for( const auto& index: _timestampConesIndices[materialId] )
-        {
-            file.write( ( char* )&index.first, sizeof( size_t ));
-            file.write( ( char* )&index.second, sizeof( size_t ));
-        }
+    // Collect the chunks of data. Their table entries are filled once the
+    // chunks are compressed and their offsets are known
+    std::vector< CacheSection > sections( nbMaterials );
+    std::vector< CacheTexture > cacheTextures( nbTextures );
+    CacheTransferFunction cacheTransferFunction{};
+    std::vector< std::vector< CacheTimestampIndex >> timestampIndices;
+    std::vector< CacheChunk > chunks;
 
-        bufferSize =
-            _serializedConesDataSize[materialId] *
-            Cone::getSerializationSize() *
-            sizeof( float );
-        file.write( ( char* )&bufferSize, sizeof( size_t ));
-        file.write( ( char* )_serializedConesData[materialId].data(),
-            bufferSize );
-        if( bufferSize != 0 )
+    for( size_t materialId = 0; materialId < nbMaterials; ++materialId )
+    {
+        GeometryBuffers buffers = _getGeometryBuffers( materialId );
+
+        // Geometry that was itself loaded from a cache file
+        const auto cached = _cachedGeometryBuffers.find( materialId );
+        if( cached != _cachedGeometryBuffers.end( ))
+            for( size_t i = 0; i < CBT_COUNT; ++i )
+                if( buffers[i].size == 0 )
+                    buffers[i] = cached->second[i];
+
+        timestampIndices.push_back(
+            toCacheIndices( _timestampSpheresIndices[materialId] ));
+        buffers[CBT_SPHERES_TIMESTAMPS] = makeBuffer( timestampIndices.back( ));
+        timestampIndices.push_back(
+            toCacheIndices( _timestampCylindersIndices[materialId] ));
+        buffers[CBT_CYLINDERS_TIMESTAMPS] =
+            makeBuffer( timestampIndices.back( ));
+        timestampIndices.push_back(
+            toCacheIndices( _timestampConesIndices[materialId] ));
+        buffers[CBT_CONES_TIMESTAMPS] = makeBuffer( timestampIndices.back( ));
+        timestampIndices.push_back(
+            toCacheIndices( _timestampRoundedConesIndices[materialId] ));
+        buffers[CBT_ROUNDED_CONES_TIMESTAMPS] =
+            makeBuffer( timestampIndices.back( ));
+
+        for( size_t i = 0; i < CBT_COUNT; ++i )
+            chunks.push_back(
+                { buffers[i], &sections[materialId].buffers[i] } );
+
+        if( buffers[CBT_SPHERES].size != 0 )
+            BRAYNS_DEBUG << "[" << materialId << "] "
+                         << buffers[CBT_SPHERES].size / sizeof( Sphere )
+                         << " Spheres" << std::endl;
+        if( buffers[CBT_CYLINDERS].size != 0 )
             BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedConesDataSize[materialId]
+                         << buffers[CBT_CYLINDERS].size / sizeof( Cylinder )
+                         << " Cylinders" << std::endl;
+        if( buffers[CBT_CONES].size != 0 )
+            BRAYNS_DEBUG << "[" << materialId << "] "
+                         << buffers[CBT_CONES].size / sizeof( Cone )
                          << " Cones" << std::endl;
+        if( buffers[CBT_ROUNDED_CONES].size != 0 )
+            BRAYNS_DEBUG << "[" << materialId << "] "
+                         << buffers[CBT_ROUNDED_CONES].size /
+                            sizeof( RoundedCone )
+                         << " Rounded cones" << std::endl;
+        if( buffers[CBT_VERTICES].size != 0 )
+            BRAYNS_DEBUG << "[" << materialId << "] "
+                         << buffers[CBT_VERTICES].size / sizeof( Vector3f )
+                         << " Vertices" << std::endl;
+    }
 
-        if( _trianglesMeshes.find( materialId ) != _trianglesMeshes.end( ))
+    // Textures that are not in the texture cache (e.g. the simulation
+    // texture) are only saved by name
+    for( size_t textureId = 0; textureId < nbTextures; ++textureId )
+    {
+        const std::string& name = textureNames[textureId];
+        CacheTexture& cacheTexture = cacheTextures[textureId];
+        chunks.push_back(
+            { { name.data(), name.size() }, &cacheTexture.name } );
+
+        const auto texture = _textures.find( name );
+        if( texture == _textures.end() || !texture->second )
+            continue;
+        cacheTexture.type = texture->second->getType();
+        cacheTexture.width = texture->second->getWidth();
+        cacheTexture.height = texture->second->getHeight();
+        cacheTexture.nbChannels = texture->second->getNbChannels();
+        cacheTexture.depth = texture->second->getDepth();
+        chunks.push_back( { { texture->second->getRawData(),
+                              texture->second->getRawDataSize() },
+                            &cacheTexture.data } );
+    }
+
+    const Vector2f& valuesRange = _transferFunction.getValuesRange();
+    cacheTransferFunction.valuesRange[0] = valuesRange.x();
+    cacheTransferFunction.valuesRange[1] = valuesRange.y();
+    chunks.push_back( { makeBuffer( _transferFunction.getDiffuseColors( )),
+                        &cacheTransferFunction.diffuseColors } );
+    chunks.push_back(
+        { makeBuffer( _transferFunction.getEmissionIntensities( )),
+          &cacheTransferFunction.emissionIntensities } );
+
+    // Split chunks in blocks, that are compressed and checksummed in parallel
+    std::vector< CacheBlock > blocks;
+    std::vector< GeometryBuffer > storedBlocks;
+    for( const auto& chunk: chunks )
+    {
+        const uint64_t size = chunk.buffer.size;
+        chunk.entry->size = size;
+        chunk.entry->firstBlock = blocks.size();
+        for( uint64_t block = 0; block < getCacheBlockCount( size ); ++block )
         {
-            // Vertices
-            bufferSize = _trianglesMeshes[materialId].getVertices().size() * sizeof(Vector3f);
-            file.write( ( char* )&bufferSize, sizeof( size_t ));
-            file.write( ( char* )_trianglesMeshes[materialId].getVertices().data(), bufferSize );
-            if( bufferSize != 0 )
-                BRAYNS_DEBUG << "[" << materialId << "] "
-                             << _trianglesMeshes[materialId].getVertices().size()
-                             << " Vertices" << std::endl;
-
-            // Indices
-            bufferSize = _trianglesMeshes[materialId].getIndices().size() * sizeof(Vector3ui);
-            file.write( ( char* )&bufferSize, sizeof( size_t ));
-            file.write( ( char* )_trianglesMeshes[materialId].getIndices().data(), bufferSize );
-            if( bufferSize != 0 )
-                BRAYNS_DEBUG << "[" << materialId << "] "
-                             << _trianglesMeshes[materialId].getIndices().size()
-                             << " Indices" << std::endl;
-
-            // Normals
-            bufferSize = _trianglesMeshes[materialId].getNormals().size() * sizeof(Vector3f);
-            file.write( ( char* )&bufferSize, sizeof( size_t ));
-            file.write( ( char* )_trianglesMeshes[materialId].getNormals().data(), bufferSize );
-            if( bufferSize != 0 )
-                BRAYNS_DEBUG << "[" << materialId << "] "
-                             << _trianglesMeshes[materialId].getNormals().size()
-                             << " Vertices" << std::endl;
-
-            // Texture coordinates
-            bufferSize = _trianglesMeshes[materialId].getTextureCoordinates().size() * sizeof(Vector2f);
-            file.write( ( char* )&bufferSize, sizeof( size_t ));
-            file.write( ( char* )_trianglesMeshes[materialId].getTextureCoordinates().data(), bufferSize );
-            if( bufferSize != 0 )
-                BRAYNS_DEBUG << "[" << materialId << "] "
-                             << _trianglesMeshes[materialId].getTextureCoordinates().size()
-                             << " Texture coordinates" << std::endl;
+            storedBlocks.push_back( {
+                static_cast< const char* >( chunk.buffer.data ) +
+                    block * CACHE_BLOCK_SIZE,
+                getCacheBlockSize( size, block ) } );
+            blocks.push_back( CacheBlock() );
         }
-        else
+    }
+
+    std::vector< std::vector< char >> compressedBlocks( blocks.size( ));
+    #pragma omp parallel for schedule( dynamic )
+    for( size_t i = 0; i < blocks.size(); ++i )
+    {
+        CacheBlock& block = blocks[i];
+        GeometryBuffer& stored = storedBlocks[i];
+        block.compression = compress ?
+            compressCacheBlock( stored, compressedBlocks[i] ) : CC_NONE;
+        if( block.compression != CC_NONE )
+            stored = { compressedBlocks[i].data(), compressedBlocks[i].size() };
+        block.storedSize = stored.size;
+        block.checksum = computeCacheChecksum( stored.data, stored.size );
+    }
+
+    header.nbBlocks = blocks.size();
+    header.blocksOffset =
+        header.transferFunctionOffset + sizeof( CacheTransferFunction );
+    uint64_t fileSize =
+        header.blocksOffset + header.nbBlocks * sizeof( CacheBlock );
+    uint64_t dataSize = 0;
+    for( const auto& chunk: chunks )
+    {
+        const CacheBuffer& entry = *chunk.entry;
+        dataSize += entry.size;
+        if( entry.size == 0 )
+            continue;
+        fileSize = alignCacheOffset( fileSize );
+        for( uint64_t i = 0; i < getCacheBlockCount( entry.size ); ++i )
         {
-            bufferSize = 0;
-            file.write( ( char* )&bufferSize, sizeof( size_t )); // No vertices
-            file.write( ( char* )&bufferSize, sizeof( size_t )); // No indices
-            file.write( ( char* )&bufferSize, sizeof( size_t )); // No normals
-            file.write( ( char* )&bufferSize, sizeof( size_t )); // No Texture coordinates
+            CacheBlock& block = blocks[entry.firstBlock + i];
+            block.offset = fileSize;
+            fileSize += block.storedSize;
         }
     }
 
-    file.write( ( char* )&_bounds, sizeof( Boxf ));
+    const int descriptor =
+        ::open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if( descriptor == NO_DESCRIPTOR )
+    {
+        BRAYNS_ERROR << "Could not create cache file " << filename << std::endl;
+        return;
+    }
+
+    // Padding between chunks is left to the file system, as zeros
+    bool success =
+        ::ftruncate( descriptor, fileSize ) == 0 &&
+        writeToFile( descriptor, &header, sizeof( CacheHeader ), 0 ) &&
+        writeToFile( descriptor, timestamps.data(),
+            timestamps.size() * sizeof( uint64_t ), header.modelsOffset ) &&
+        writeToFile( descriptor, cacheMaterials.data(),
+            nbMaterials * sizeof( CacheMaterial ), header.materialsOffset ) &&
+        writeToFile( descriptor, sections.data(),
+            nbMaterials * sizeof( CacheSection ), header.sectionsOffset ) &&
+        writeToFile( descriptor, cacheTextures.data(),
+            nbTextures * sizeof( CacheTexture ), header.texturesOffset ) &&
+        writeToFile( descriptor, &cacheTransferFunction,
+            sizeof( CacheTransferFunction ), header.transferFunctionOffset ) &&
+        writeToFile( descriptor, blocks.data(),
+            header.nbBlocks * sizeof( CacheBlock ), header.blocksOffset );
+
+    size_t nbFailedBlocks = 0;
+    if( success )
+    {
+        #pragma omp parallel for schedule( dynamic ) reduction( +:nbFailedBlocks )
+        for( size_t i = 0; i < blocks.size(); ++i )
+            if( !writeToFile( descriptor, storedBlocks[i].data,
+                              storedBlocks[i].size, blocks[i].offset ))
+                ++nbFailedBlocks;
+    }
+    success = ( ::close( descriptor ) == 0 ) && success &&
+              nbFailedBlocks == 0;
+
+    if( !success )
+    {
+        BRAYNS_ERROR << "Failed to write cache file " << filename << std::endl;
+        return;
+    }
+
+    BRAYNS_INFO << "Version: " << header.version << std::endl;
+    BRAYNS_INFO << header.nbModels << " models" << std::endl;
+    BRAYNS_INFO << nbMaterials << " materials" << std::endl;
+    BRAYNS_INFO << nbTextures << " textures" << std::endl;
+    BRAYNS_INFO << chunks.size() << " chunks in " << blocks.size()
+                << " blocks, " << dataSize
+                << " bytes of data stored in " << fileSize
+                << " bytes" << std::endl;
     BRAYNS_INFO << _bounds << std::endl;
-    file.close();
     BRAYNS_INFO << "Scene successfully saved"<< std::endl;
 }
 
+bool OSPRayScene::_mapCacheFile( const std::string& filename )
+{
+    _unmapCacheFile();
+
+    const int descriptor = ::open( filename.c_str(), O_RDONLY );
+    if( descriptor == NO_DESCRIPTOR )
+    {
+        BRAYNS_ERROR << "Could not open cache file " << filename << std::endl;
+        return false;
+    }
+
+    struct stat sb;
+    if( ::fstat( descriptor, &sb ) == NO_DESCRIPTOR ||
+        uint64_t( sb.st_size ) < sizeof( CacheHeader ))
+    {
+        BRAYNS_ERROR << "Invalid cache file " << filename << std::endl;
+        ::close( descriptor );
+        return false;
+    }
+
+    // The mapping is shared so that several instances loading the same cache
+    // file use the same pages in memory. It remains valid once the file is
+    // closed.
+    void* memoryMapPtr =
+        ::mmap( 0, sb.st_size, PROT_READ, MAP_SHARED, descriptor, 0 );
+    ::close( descriptor );
+    if( memoryMapPtr == MAP_FAILED )
+    {
+        BRAYNS_ERROR << "Failed to map cache file " << filename << std::endl;
+        return false;
+    }
+
+    _cacheMemoryMapPtr = memoryMapPtr;
+    _cacheSize = sb.st_size;
+    return true;
+}
+
+void OSPRayScene::_unmapCacheFile()
+{
+    _cachedGeometryBuffers.clear();
+    _cacheBuffers.clear();
+    if( _cacheMemoryMapPtr )
+    {
+        ::munmap( _cacheMemoryMapPtr, _cacheSize );
+        _cacheMemoryMapPtr = 0;
+        _cacheSize = 0;
+    }
+}
+
+bool OSPRayScene::_isInCacheFile( const uint64_t offset, const uint64_t size ) const
+{
+    return offset <= _cacheSize && size <= _cacheSize - offset;
+}
+
+bool OSPRayScene::_mapCacheBuffer(
+    const CacheBuffer& chunk,
+    const CacheBlock* blocks,
+    GeometryBuffer& buffer ) const
+{
+    buffer = { nullptr, 0 };
+    if( chunk.size == 0 )
+        return true;
+
+    // Chunks whose blocks are all uncompressed and stored consecutively are
+    // used in place
+    const uint64_t offset = blocks[chunk.firstBlock].offset;
+    for( uint64_t i = 0; i < getCacheBlockCount( chunk.size ); ++i )
+    {
+        const CacheBlock& block = blocks[chunk.firstBlock + i];
+        if( block.compression != CC_NONE ||
+            block.offset != offset + i * CACHE_BLOCK_SIZE ||
+            block.storedSize != getCacheBlockSize( chunk.size, i ))
+            return false;
+    }
+    buffer = { static_cast< const char* >( _cacheMemoryMapPtr ) + offset,
+               chunk.size };
+    return true;
+}
+
+bool OSPRayScene::_readCacheBlock(
+    const CacheBlock& block,
+    const uint64_t size,
+    char* dst,
+    const bool verify ) const
+{
+    // Decompression checks the bounds of the stored bytes, verifying their
+    // checksum only detects silent corruption of the file
+    const char* stored =
+        static_cast< const char* >( _cacheMemoryMapPtr ) + block.offset;
+    if( verify &&
+        computeCacheChecksum( stored, block.storedSize ) != block.checksum )
+        return false;
+
+    if( !dst )
+        return true;
+
+    if( block.compression == CC_NONE )
+    {
+        if( block.storedSize != size )
+            return false;
+        memcpy( dst, stored, size );
+        return true;
+    }
+    return decompressCacheBlock( block, stored, dst, size );
+}
+
 void OSPRayScene::_loadCacheFile()
 {
     commitMaterials();
 
     const std::string& filename = _parametersManager.getGeometryParameters().getLoadCacheFile();
     BRAYNS_INFO << "Loading scene from binary file: " << filename << std::endl;
-    std::ifstream file( filename, std::ios::in | std::ios::binary );
-    if( !file.good( ))
+    if( !_mapCacheFile( filename ))
+        return;
+
+    const uint8_t* data = static_cast< const uint8_t* >( _cacheMemoryMapPtr );
+    const CacheHeader& header = *reinterpret_cast< const CacheHeader* >( data );
+    if( memcmp( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC )) != 0 )
     {
-        BRAYNS_ERROR << "Could not open cache file " << filename << std::endl;
+        BRAYNS_ERROR << filename << " is not a Brayns cache file" << std::endl;
+        _unmapCacheFile();
         return;
     }
 
-    size_t version;
-    file.read( (char*)&version, sizeof( size_t ));
-    BRAYNS_INFO << "Version: " << version << std::endl;
-
-    if( version != CACHE_VERSION )
+    BRAYNS_INFO << "Version: " << header.version << std::endl;
+    if( header.version != CACHE_VERSION )
     {
         BRAYNS_ERROR << "Only version " << CACHE_VERSION
                      << " is supported" << std::endl;
+        _unmapCacheFile();
+        return;
+    }
+
+    const size_t nbMaterials = header.nbMaterials;
+    const size_t nbTextures = header.nbTextures;
+    bool valid =
+        _isInCacheFile( header.modelsOffset,
+                        header.nbModels * sizeof( uint64_t )) &&
+        _isInCacheFile( header.materialsOffset,
+                        nbMaterials * sizeof( CacheMaterial )) &&
+        _isInCacheFile( header.sectionsOffset,
+                        nbMaterials * sizeof( CacheSection )) &&
+        _isInCacheFile( header.texturesOffset,
+                        nbTextures * sizeof( CacheTexture )) &&
+        _isInCacheFile( header.transferFunctionOffset,
+                        sizeof( CacheTransferFunction )) &&
+        header.nbBlocks <= _cacheSize / sizeof( CacheBlock ) &&
+        _isInCacheFile( header.blocksOffset,
+                        header.nbBlocks * sizeof( CacheBlock ));
+    if( !valid )
+    {
+        BRAYNS_ERROR << "Cache file " << filename << " is corrupted" << std::endl;
+        _unmapCacheFile();
+        return;
+    }
+
+    const CacheSection* sections =
+        reinterpret_cast< const CacheSection* >( data + header.sectionsOffset );
+    const CacheTexture* cacheTextures =
+        reinterpret_cast< const CacheTexture* >( data + header.texturesOffset );
+    const CacheTransferFunction& cacheTransferFunction =
+        *reinterpret_cast< const CacheTransferFunction* >(
+            data + header.transferFunctionOffset );
+    const CacheBlock* blocks =
+        reinterpret_cast< const CacheBlock* >( data + header.blocksOffset );
+
+    // Materials that are not known to the scene are ignored, together with
+    // their geometry
+    const size_t nbSceneMaterials = std::min( nbMaterials, _materials.size( ));
+
+    // Chunks to read, and the buffers they are read into
+    const bool verify =
+        _parametersManager.getGeometryParameters().getVerifyCacheFile();
+    std::vector< GeometryBuffer > textureBuffers( 2 * nbTextures );
+    GeometryBuffer transferFunctionBuffers[2];
+    std::vector< std::pair< const CacheBuffer*, GeometryBuffer* >> chunks;
+    for( size_t materialId = 0; materialId < nbSceneMaterials; ++materialId )
+    {
+        GeometryBuffers& buffers = _cachedGeometryBuffers[materialId];
+        for( size_t i = 0; i < CBT_COUNT; ++i )
+            chunks.push_back(
+                { &sections[materialId].buffers[i], &buffers[i] } );
+    }
+    for( size_t textureId = 0; textureId < nbTextures; ++textureId )
+    {
+        chunks.push_back( { &cacheTextures[textureId].name,
+                            &textureBuffers[2 * textureId] } );
+        chunks.push_back( { &cacheTextures[textureId].data,
+                            &textureBuffers[2 * textureId + 1] } );
+    }
+    chunks.push_back( { &cacheTransferFunction.diffuseColors,
+                        &transferFunctionBuffers[0] } );
+    chunks.push_back( { &cacheTransferFunction.emissionIntensities,
+                        &transferFunctionBuffers[1] } );
+
+    for( const auto& chunk: chunks )
+        valid = valid && chunk.first->firstBlock <= header.nbBlocks &&
+            getCacheBlockCount( chunk.first->size ) <=
+                header.nbBlocks - chunk.first->firstBlock;
+    for( uint64_t i = 0; valid && i < header.nbBlocks; ++i )
+        valid = _isInCacheFile( blocks[i].offset, blocks[i].storedSize );
+
+    // Blocks of chunks that cannot be used in place are decompressed in
+    // parallel, into buffers allocated beforehand
+    size_t nbInvalidBlocks = 0;
+    if( valid )
+    {
+        std::vector< CacheBlockRead > reads;
+        _cacheBuffers.resize( chunks.size( ));
+        for( size_t i = 0; i < chunks.size(); ++i )
+        {
+            const CacheBuffer& chunk = *chunks[i].first;
+            GeometryBuffer& buffer = *chunks[i].second;
+            char* dst = nullptr;
+            if( !_mapCacheBuffer( chunk, blocks, buffer ))
+            {
+                _cacheBuffers[i].resize( chunk.size );
+                dst = _cacheBuffers[i].data();
+                buffer = { dst, chunk.size };
+            }
+            else if( !verify )
+                continue;
+
+            for( uint64_t j = 0; j < getCacheBlockCount( chunk.size ); ++j )
+                reads.push_back( { &blocks[chunk.firstBlock + j],
+                                   getCacheBlockSize( chunk.size, j ),
+                                   dst ? dst + j * CACHE_BLOCK_SIZE : dst } );
+        }
+
+        #pragma omp parallel for schedule( dynamic ) reduction( +:nbInvalidBlocks )
+        for( size_t i = 0; i < reads.size(); ++i )
+            if( !_readCacheBlock( *reads[i].block, reads[i].size,
+                                  reads[i].dst, verify ))
+                ++nbInvalidBlocks;
+    }
+    if( !valid || nbInvalidBlocks != 0 )
+    {
+        BRAYNS_ERROR << "Cache file " << filename << " is corrupted" << std::endl;
+        _unmapCacheFile();
         return;
     }
 
     _models.clear();
-    size_t nbModels;
-    file.read( (char*)&nbModels, sizeof( size_t ));
-    BRAYNS_INFO << nbModels << " models" << std::endl;
-    for( size_t model = 0; model < nbModels; ++model )
+    const uint64_t* timestamps =
+        reinterpret_cast< const uint64_t* >( data + header.modelsOffset );
+    BRAYNS_INFO << header.nbModels << " models" << std::endl;
+    for( size_t model = 0; model < header.nbModels; ++model )
     {
-        size_t ts;
-        file.read( (char*)&ts, sizeof( size_t ));
+        const size_t ts = timestamps[model];
         BRAYNS_INFO << "Model for ts " << ts << " created" << std::endl;
         _models[ts] = ospNewModel();
     }
 
-    size_t nbMaterials;
-    file.read( (char*)&nbMaterials, sizeof( size_t ));
-    BRAYNS_INFO << nbMaterials << " materials" << std::endl;
+    // Read textures
+    BRAYNS_INFO << nbTextures << " textures" << std::endl;
+    std::vector< std::string > textureNames( nbTextures );
+    for( size_t textureId = 0; textureId < nbTextures; ++textureId )
+    {
+        const GeometryBuffer& name = textureBuffers[2 * textureId];
+        const GeometryBuffer& rawData = textureBuffers[2 * textureId + 1];
+        textureNames[textureId] = std::string(
+            static_cast< const char* >( name.data ), name.size );
+        if( rawData.size == 0 )
+            continue;
+
+        const CacheTexture& cacheTexture = cacheTextures[textureId];
+        Texture2DPtr texture( new Texture2D );
+        texture->setType( TextureType( cacheTexture.type ));
+        texture->setWidth( cacheTexture.width );
+        texture->setHeight( cacheTexture.height );
+        texture->setNbChannels( cacheTexture.nbChannels );
+        texture->setDepth( cacheTexture.depth );
+        texture->setRawData( ( unsigned char* )rawData.data, rawData.size );
+        _textures[textureNames[textureId]] = texture;
+        _ospTextures.erase( textureNames[textureId] );
+    }
 
     // Read materials
-    for( const auto& material: _materials )
-    {
-        Vector3f value3f;
-        file.read( ( char* )&value3f, sizeof( Vector3f ));
-        material->setColor( value3f );
-        file.read( ( char* )&value3f, sizeof( Vector3f ));
-        material->setSpecularColor( value3f );
-        float value;
-        file.read( ( char* )&value, sizeof( float ));
-        material->setSpecularExponent( value );
-        file.read( ( char* )&value, sizeof( float ));
-        material->setReflectionIndex( value );
-        file.read( ( char* )&value, sizeof( float ));
-        material->setOpacity( value );
-        file.read( ( char* )&value, sizeof( float ));
-        material->setRefractionIndex( value );
-        file.read( ( char* )&value, sizeof( float ));
-        material->setEmission( value );
-        // TODO: Textures
-    }
-    commitMaterials( true );
-
-    // Read geometry
-    for( size_t materialId = 0; materialId < nbMaterials; ++materialId )
+    BRAYNS_INFO << nbMaterials << " materials" << std::endl;
+    const CacheMaterial* materials =
+        reinterpret_cast< const CacheMaterial* >( data + header.materialsOffset );
+    for( size_t i = 0; i < nbSceneMaterials; ++i )
     {
-        // Spheres
-        size_t bufferSize = 0;
-
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i<bufferSize; ++i)
+        const CacheMaterial& cacheMaterial = materials[i];
+        MaterialPtr material = _materials[i];
+        material->setColor( Vector3f( cacheMaterial.color[0],
+            cacheMaterial.color[1], cacheMaterial.color[2] ));
+        material->setSpecularColor( Vector3f( cacheMaterial.specularColor[0],
+            cacheMaterial.specularColor[1], cacheMaterial.specularColor[2] ));
+        material->setSpecularExponent( cacheMaterial.specularExponent );
+        material->setReflectionIndex( cacheMaterial.reflectionIndex );
+        material->setOpacity( cacheMaterial.opacity );
+        material->setRefractionIndex( cacheMaterial.refractionIndex );
+        material->setEmission( cacheMaterial.emission );
+
+        material->getTextures().clear();
+        for( size_t type = 0; type < CACHE_NB_TEXTURE_TYPES; ++type )
         {
-            size_t ts;
-            file.read( ( char* )&ts, sizeof( size_t ));
-            size_t index;
-            file.read( ( char* )&index, sizeof( size_t ));
-            _timestampSpheresIndices[materialId][ts] = index;
-        }
-
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        _serializedSpheresDataSize[materialId] = bufferSize /
-            ( Sphere::getSerializationSize() * sizeof( float ));
-        if( bufferSize != 0 )
-        {
-            BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedSpheresDataSize[materialId]
-                         << " Spheres" << std::endl;
-            _serializedSpheresData[materialId].resize( bufferSize );
-            file.read( (char*)_serializedSpheresData[materialId].data(),
-                bufferSize );
+            const int32_t textureId = cacheMaterial.textures[type];
+            if( textureId >= 0 && size_t( textureId ) < nbTextures )
+                material->setTexture(
+                    TextureType( type ), textureNames[textureId] );
         }
+    }
+    commitMaterials();
 
-        // Cylinders
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i<bufferSize; ++i)
+    // Read transfer function
+    const GeometryBuffer& diffuseColors = transferFunctionBuffers[0];
+    const GeometryBuffer& emissionIntensities = transferFunctionBuffers[1];
+    if( diffuseColors.size != 0 )
+    {
+        const Vector4f* colors =
+            static_cast< const Vector4f* >( diffuseColors.data );
+        const float* intensities =
+            static_cast< const float* >( emissionIntensities.data );
+        _transferFunction.getDiffuseColors().assign(
+            colors, colors + diffuseColors.size / sizeof( Vector4f ));
+        _transferFunction.getEmissionIntensities().assign( intensities,
+            intensities + emissionIntensities.size / sizeof( float ));
+        _transferFunction.setValuesRange( Vector2f(
+            cacheTransferFunction.valuesRange[0],
+            cacheTransferFunction.valuesRange[1] ));
+
+        // The diffuse data shares the buffer of the transfer function, which
+        // may have been reallocated
+        if( _ospTransferFunctionDiffuseData )
         {
-            size_t ts;
-            file.read( ( char* )&ts, sizeof( size_t ));
-            size_t index;
-            file.read( ( char* )&index, sizeof( size_t ));
-            _timestampCylindersIndices[materialId][ts] = index;
+            ospRelease( _ospTransferFunctionDiffuseData );
+            _ospTransferFunctionDiffuseData = 0;
         }
+        commitTransferFunctionData();
+    }
 
-        file.read( (char*)&bufferSize, sizeof( size_t ));
-        _serializedCylindersDataSize[materialId] = bufferSize /
-            ( Cylinder::getSerializationSize() * sizeof( float ));
-        if( bufferSize != 0 )
-        {
-            BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedCylindersDataSize[materialId]
-                         << " Cylinders" << std::endl;
-            _serializedCylindersData[materialId].reserve( bufferSize );
-            file.read( (char*)_serializedCylindersData[materialId].data(),
-                bufferSize );
-        }
+    // Geometry is used in place, from the memory mapped file, unless it was
+    // compressed
+    size_t nbSpheres = 0;
+    size_t nbCylinders = 0;
+    size_t nbCones = 0;
+    size_t nbRoundedCones = 0;
+    size_t nbVertices = 0;
+    for( size_t materialId = 0; materialId < nbSceneMaterials; ++materialId )
+    {
+        const GeometryBuffers& buffers = _cachedGeometryBuffers[materialId];
+        readCacheIndices( buffers[CBT_SPHERES_TIMESTAMPS],
+            buffers[CBT_SPHERES].size / sizeof( Sphere ),
+            _timestampSpheresIndices[materialId] );
+        readCacheIndices( buffers[CBT_CYLINDERS_TIMESTAMPS],
+            buffers[CBT_CYLINDERS].size / sizeof( Cylinder ),
+            _timestampCylindersIndices[materialId] );
+        readCacheIndices( buffers[CBT_CONES_TIMESTAMPS],
+            buffers[CBT_CONES].size / sizeof( Cone ),
+            _timestampConesIndices[materialId] );
+        readCacheIndices( buffers[CBT_ROUNDED_CONES_TIMESTAMPS],
+            buffers[CBT_ROUNDED_CONES].size / sizeof( RoundedCone ),
+            _timestampRoundedConesIndices[materialId] );
+
+        nbSpheres += buffers[CBT_SPHERES].size / sizeof( Sphere );
+        nbCylinders += buffers[CBT_CYLINDERS].size / sizeof( Cylinder );
+        nbCones += buffers[CBT_CONES].size / sizeof( Cone );
+        nbRoundedCones +=
+            buffers[CBT_ROUNDED_CONES].size / sizeof( RoundedCone );
+        nbVertices += buffers[CBT_VERTICES].size / sizeof( Vector3f );
+
+        _buildParametricOSPGeometry( materialId, buffers );
+        _buildMeshOSPGeometry( materialId, buffers );
+    }
 
-        // Cones
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i<bufferSize; ++i)
-        {
-            size_t ts;
-            file.read( ( char* )&ts, sizeof( size_t ));
-            size_t index;
-            file.read( ( char* )&index, sizeof( size_t ));
-            _timestampConesIndices[materialId][ts] = index;
-        }
+    // Scene bounds
+    _bounds = Boxf(
+        Vector3f( header.bounds[0], header.bounds[1], header.bounds[2] ),
+        Vector3f( header.bounds[3], header.bounds[4], header.bounds[5] ));
+
+    BRAYNS_INFO << "Cached spheres      : " << nbSpheres << std::endl;
+    BRAYNS_INFO << "Cached cylinders    : " << nbCylinders << std::endl;
+    BRAYNS_INFO << "Cached cones        : " << nbCones << std::endl;
+    BRAYNS_INFO << "Cached rounded cones: " << nbRoundedCones << std::endl;
+    BRAYNS_INFO << "Cached vertices     : " << nbVertices << std::endl;
+    BRAYNS_INFO << _bounds << std::endl;
+    BRAYNS_INFO << "Scene successfully loaded"<< std::endl;
+}
 
-        file.read( (char*)&bufferSize, sizeof( size_t ));
-        _serializedConesDataSize[materialId] = bufferSize /
-            ( Cone::getSerializationSize() * sizeof( float ));
-        if( bufferSize != 0 )
-        {
-            BRAYNS_DEBUG << "[" << materialId << "] "
-                         << _serializedConesDataSize[materialId]
-                         << " Cones" << std::endl;
-            _serializedConesData[materialId].reserve( bufferSize );
-            file.read( (char*)_serializedConesData[materialId].data(),
-                bufferSize );
-        }
+OSPGeometry OSPRayScene::_createExtendedSpheres(
+    const size_t materialId,
+    const void* spheres,
+    const size_t nbSpheres )
+{
+    OSPGeometry extendedSpheres = ospNewGeometry("extendedspheres");
+    assert( extendedSpheres );
+
+    OSPData data = ospNewData( nbSpheres * sizeof( Sphere ) / sizeof( float ),
+        OSP_FLOAT, spheres, OSP_DATA_SHARED_BUFFER );
+
+    ospSetObject(extendedSpheres, "extendedspheres", data );
+    ospRelease( data );
+    ospSet1i(extendedSpheres, "bytes_per_extended_sphere", sizeof( Sphere ));
+    ospSet1i(extendedSpheres, "materialID", materialId );
+    ospSet1i(extendedSpheres, "offset_center", offsetof( Sphere, center ));
+    ospSet1i(extendedSpheres, "offset_radius", offsetof( Sphere, radius ));
+    ospSet1i(extendedSpheres,
+        "offset_timestamp", offsetof( Sphere, timestamp ));
+    ospSet1i(extendedSpheres, "offset_value", offsetof( Sphere, value ));
+    // Primitives have a fixed layout, for which the geometry has specialized
+    // intersection functions that do not use the offsets above
+    ospSet1i(extendedSpheres, "packed", 1 );
+
+    if( _ospMaterials[materialId] )
+        ospSetMaterial( extendedSpheres, _ospMaterials[materialId] );
+
+    ospCommit( extendedSpheres );
+    return extendedSpheres;
+}
 
-        _buildParametricOSPGeometry( materialId );
+OSPGeometry OSPRayScene::_createExtendedCylinders(
+    const size_t materialId,
+    const void* cylinders,
+    const size_t nbCylinders )
+{
+    OSPGeometry extendedCylinders = ospNewGeometry("extendedcylinders");
+    assert( extendedCylinders );
+
+    OSPData data = ospNewData(
+        nbCylinders * sizeof( Cylinder ) / sizeof( float ),
+        OSP_FLOAT, cylinders, OSP_DATA_SHARED_BUFFER );
+
+    ospSet1i( extendedCylinders, "materialID", materialId );
+    ospSetObject( extendedCylinders, "extendedcylinders", data);
+    ospRelease( data );
+    ospSet1i(extendedCylinders, "bytes_per_extended_cylinder",
+        sizeof( Cylinder ));
+    ospSet1i(extendedCylinders, "offset_v0", offsetof( Cylinder, center ));
+    ospSet1i(extendedCylinders, "offset_v1", offsetof( Cylinder, up ));
+    ospSet1i(extendedCylinders, "offset_radius", offsetof( Cylinder, radius ));
+    ospSet1i(extendedCylinders,
+        "offset_timestamp", offsetof( Cylinder, timestamp ));
+    ospSet1i(extendedCylinders, "offset_value", offsetof( Cylinder, value ));
+    ospSet1i(extendedCylinders, "packed", 1 );
+
+    if( _ospMaterials[materialId] )
+        ospSetMaterial( extendedCylinders, _ospMaterials[materialId]);
+
+    ospCommit(extendedCylinders);
+    return extendedCylinders;
+}
 
-        // Vertices
-        _trianglesMeshes[materialId].getVertices().clear();
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i < bufferSize / sizeof( Vector3f ); ++i)
-        {
-            Vector3f vertex;
-            file.read( ( char* )&vertex, sizeof( Vector3f ));
-            _trianglesMeshes[materialId].getVertices().push_back( vertex );
-        }
+OSPGeometry OSPRayScene::_createExtendedCones(
+    const size_t materialId,
+    const void* cones,
+    const size_t nbCones )
+{
+    OSPGeometry extendedCones = ospNewGeometry("extendedcones");
+    assert(extendedCones);
+
+    OSPData data = ospNewData( nbCones * sizeof( Cone ) / sizeof( float ),
+        OSP_FLOAT, cones, OSP_DATA_SHARED_BUFFER );
+
+    ospSet1i( extendedCones, "materialID", materialId );
+    ospSetObject(extendedCones, "extendedcones", data);
+    ospRelease( data );
+    ospSet1i(extendedCones, "bytes_per_extended_cone", sizeof( Cone ));
+    ospSet1i(extendedCones, "offset_center", offsetof( Cone, center ));
+    ospSet1i(extendedCones, "offset_up", offsetof( Cone, up ));
+    ospSet1i(extendedCones,
+        "offset_centerRadius", offsetof( Cone, centerRadius ));
+    ospSet1i(extendedCones, "offset_upRadius", offsetof( Cone, upRadius ));
+    ospSet1i(extendedCones, "offset_timestamp", offsetof( Cone, timestamp ));
+    ospSet1i(extendedCones, "offset_value", offsetof( Cone, value ));
+    ospSet1i(extendedCones, "packed", 1 );
+
+    if( _ospMaterials[materialId] )
+        ospSetMaterial( extendedCones, _ospMaterials[materialId]);
+
+    ospCommit( extendedCones );
+    return extendedCones;
+}
 
-        // Indices
-        _trianglesMeshes[materialId].getIndices().clear();
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i < bufferSize / sizeof( Vector3ui ) ; ++i)
-        {
-            Vector3ui index;
-            file.read( ( char* )&index, sizeof( Vector3ui ));
-            _trianglesMeshes[materialId].getIndices().push_back( index );
-        }
+OSPGeometry OSPRayScene::_createExtendedRoundedCones(
+    const size_t materialId,
+    const void* roundedCones,
+    const size_t nbRoundedCones )
+{
+    OSPGeometry extendedRoundedCones = ospNewGeometry("extendedroundedcones");
+    assert(extendedRoundedCones);
 
-        // Normals
-        _trianglesMeshes[materialId].getNormals().clear();
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i < bufferSize / sizeof( Vector3f ); ++i)
-        {
-            Vector3f normal;
-            file.read( ( char* )&normal, sizeof( Vector3f ));
-            _trianglesMeshes[materialId].getVertices().push_back( normal );
-        }
+    OSPData data = ospNewData(
+        nbRoundedCones * sizeof( RoundedCone ) / sizeof( float ),
+        OSP_FLOAT, roundedCones, OSP_DATA_SHARED_BUFFER );
 
-        // Texture coordinates
-        _trianglesMeshes[materialId].getTextureCoordinates().clear();
-        bufferSize = 0;
-        file.read( ( char* )&bufferSize, sizeof( size_t ));
-        for( size_t i = 0; i < bufferSize / sizeof( Vector2f ); ++i)
-        {
-            Vector2f texCoord;
-            file.read( ( char* )&texCoord, sizeof( Vector2f ));
-            _trianglesMeshes[materialId].getTextureCoordinates().push_back( texCoord );
-        }
+    // The geometry only supports the layout of the Brayns primitives
+    ospSet1i( extendedRoundedCones, "materialID", materialId );
+    ospSetObject( extendedRoundedCones, "extendedroundedcones", data );
+    ospRelease( data );
+    ospSet1i( extendedRoundedCones, "bytes_per_extended_rounded_cone",
+        sizeof( RoundedCone ));
 
-        _buildMeshOSPGeometry( materialId );
-    }
+    if( _ospMaterials[materialId] )
+        ospSetMaterial( extendedRoundedCones, _ospMaterials[materialId]);
 
-    // Scene bounds
-    file.read( ( char* )&_bounds, sizeof( Boxf ));
+    ospCommit( extendedRoundedCones );
+    return extendedRoundedCones;
+}
 
-    BRAYNS_INFO << _bounds << std::endl;
-    BRAYNS_INFO << "Scene successfully loaded"<< std::endl;
-    file.close();
+void OSPRayScene::_sortPrimitives( const size_t materialId )
+{
+    // Primitives are sorted in space when requested, so that neighbours in
+    // the arrays are close in the scene, which speeds up the BVH build and
+    // makes the traversal more cache friendly. Arrays that are split in
+    // several geometries are always sorted, so that each geometry covers a
+    // compact region of the scene instead of overlapping the others. Models of
+    // multiple timestamps expect the arrays to be sorted by timestamp and are
+    // not concerned. Values travel with their primitives, and groups keep
+    // covering their primitives so that materials can still be reassigned.
+    const size_t minSize = _parametersManager.getGeometryParameters().
+        getSortPrimitives() ? 2 : MAX_PRIMITIVES_PER_GEOMETRY + 1;
+    std::vector< PrimitivesGroup* > groups;
+    for( PrimitivesGroup& group: _primitivesGroups )
+        if( group.material == materialId )
+            groups.push_back( &group );
+
+    Primitives& primitives = _primitives[materialId];
+    if( primitives.getSpheres().size() >= minSize )
+        sortByMortonCode( primitives.getSpheres(), groups,
+            &PrimitivesGroup::firstSphere, &PrimitivesGroup::nbSpheres );
+    if( primitives.getCylinders().size() >= minSize )
+        sortByMortonCode( primitives.getCylinders(), groups,
+            &PrimitivesGroup::firstCylinder, &PrimitivesGroup::nbCylinders );
+    if( primitives.getCones().size() >= minSize )
+        sortByMortonCode( primitives.getCones(), groups,
+            &PrimitivesGroup::firstCone, &PrimitivesGroup::nbCones );
+    if( primitives.getRoundedCones().size() >= minSize )
+        sortByMortonCode( primitives.getRoundedCones(), groups,
+            &PrimitivesGroup::firstRoundedCone,
+            &PrimitivesGroup::nbRoundedCones );
 }
 
-void OSPRayScene::_buildParametricOSPGeometry( const size_t materialId )
+void OSPRayScene::_buildParametricOSPGeometry(
+    const size_t materialId,
+    const GeometryBuffers& buffers )
 {
-    // Extended spheres
-    for( const auto& timestampSpheresIndex: _timestampSpheresIndices[materialId] )
+    // Every model contains the primitives of its timestamp and of all the
+    // previous ones. Geometries are shared by all models using them, and
+    // released with the last of these models.
+    const auto addToModels = [this]( const size_t timestamp,
+                                     const OSPGeometries& geometries )
     {
-        const size_t spheresBufferSize =
-            timestampSpheresIndex.second * Sphere::getSerializationSize();
-
         for( const auto& model: _models )
-        {
-            if( timestampSpheresIndex.first <= model.first )
+            if( timestamp <= model.first )
+                for( OSPGeometry geometry: geometries )
+                    ospAddGeometry( model.second, geometry );
+        for( OSPGeometry geometry: geometries )
+            ospRelease( geometry );
+    };
+
+    for( const auto& index: _timestampSpheresIndices[materialId] )
+        addToModels( index.first, createGeometries< Sphere >(
+            buffers[CBT_SPHERES].data, index.second,
+            [&]( const void* spheres, const size_t nbSpheres )
+            { return _createExtendedSpheres( materialId, spheres, nbSpheres ); }));
+
+    for( const auto& index: _timestampCylindersIndices[materialId] )
+        addToModels( index.first, createGeometries< Cylinder >(
+            buffers[CBT_CYLINDERS].data, index.second,
+            [&]( const void* cylinders, const size_t nbCylinders )
             {
-                OSPGeometry extendedSpheres =
-                    ospNewGeometry("extendedspheres");
-                OSPData data = ospNewData( spheresBufferSize, OSP_FLOAT,
-                    &_serializedSpheresData[materialId][0],
-                    OSP_DATA_SHARED_BUFFER );
+                return _createExtendedCylinders(
+                    materialId, cylinders, nbCylinders );
+            }));
+
+    for( const auto& index: _timestampConesIndices[materialId] )
+        addToModels( index.first, createGeometries< Cone >(
+            buffers[CBT_CONES].data, index.second,
+            [&]( const void* cones, const size_t nbCones )
+            { return _createExtendedCones( materialId, cones, nbCones ); }));
+
+    for( const auto& index: _timestampRoundedConesIndices[materialId] )
+        addToModels( index.first, createGeometries< RoundedCone >(
+            buffers[CBT_ROUNDED_CONES].data, index.second,
+            [&]( const void* cones, const size_t nbCones )
+            {
+                return _createExtendedRoundedCones(
+                    materialId, cones, nbCones );
+            }));
+}
 
-                ospSetObject(extendedSpheres,
-                    "extendedspheres", data );
-                ospSet1i(extendedSpheres, "bytes_per_extended_sphere",
-                    Sphere::getSerializationSize() * sizeof(float));
-                ospSet1i(extendedSpheres, "materialID", materialId );
-                ospSet1i(extendedSpheres,
-                    "offset_radius", 3 * sizeof(float));
-                ospSet1i(extendedSpheres,
-                    "offset_timestamp", 4 * sizeof(float));
-                ospSet1i(extendedSpheres,
-                    "offset_value", 5 * sizeof(float));
-
-                if( _ospMaterials[materialId] )
-                    ospSetMaterial( extendedSpheres, _ospMaterials[materialId] );
-
-                ospCommit( extendedSpheres );
-                ospAddGeometry( model.second, extendedSpheres );
-            }
-        }
+void OSPRayScene::_addParametricOSPGeometry(
+    OSPModel model,
+    const size_t materialId,
+    const GeometryBuffers& buffers )
+{
+    OSPGeometries geometries;
+    const auto append = [&geometries]( const OSPGeometries& other )
+    {
+        geometries.insert( geometries.end(), other.begin(), other.end( ));
+    };
+
+    append( createGeometries< Sphere >( buffers[CBT_SPHERES].data,
+        buffers[CBT_SPHERES].size / sizeof( Sphere ),
+        [&]( const void* data, const size_t nbSpheres )
+        { return _createExtendedSpheres( materialId, data, nbSpheres ); }));
+    append( createGeometries< Cylinder >( buffers[CBT_CYLINDERS].data,
+        buffers[CBT_CYLINDERS].size / sizeof( Cylinder ),
+        [&]( const void* data, const size_t nbCylinders )
+        { return _createExtendedCylinders( materialId, data, nbCylinders ); }));
+    append( createGeometries< Cone >( buffers[CBT_CONES].data,
+        buffers[CBT_CONES].size / sizeof( Cone ),
+        [&]( const void* data, const size_t nbCones )
+        { return _createExtendedCones( materialId, data, nbCones ); }));
+    append( createGeometries< RoundedCone >( buffers[CBT_ROUNDED_CONES].data,
+        buffers[CBT_ROUNDED_CONES].size / sizeof( RoundedCone ),
+        [&]( const void* data, const size_t nbCones )
+        { return _createExtendedRoundedCones( materialId, data, nbCones ); }));
+
+    for( OSPGeometry geometry: geometries )
+    {
+        ospAddGeometry( model, geometry );
+        ospRelease( geometry );
     }
+}
 
-    // Extended cylinders
-    for( const auto& timestampCylindersIndex: _timestampCylindersIndices[materialId] )
+void OSPRayScene::_buildGrowthOSPGeometry()
+{
+    floats timestamps;
+    for( const auto& primitives: _primitives )
     {
-        const size_t cylindersBufferSize =
-            timestampCylindersIndex.second * Cylinder::getSerializationSize();
-
-        for( const auto& model: _models )
-        {
-            if( timestampCylindersIndex.first <= model.first )
-            {
-                OSPGeometry extendedCylinders =
-                    ospNewGeometry("extendedcylinders");
-                assert( extendedCylinders );
+        for( const Sphere& sphere: primitives.second.getSpheres( ))
+            timestamps.push_back( sphere.timestamp );
+        for( const Cylinder& cylinder: primitives.second.getCylinders( ))
+            timestamps.push_back( cylinder.timestamp );
+        for( const Cone& cone: primitives.second.getCones( ))
+            timestamps.push_back( cone.timestamp );
+        for( const RoundedCone& cone: primitives.second.getRoundedCones( ))
+            timestamps.push_back( cone.timestamp );
+    }
+    if( timestamps.empty( ))
+        return;
 
-                OSPData data = ospNewData(
-                    cylindersBufferSize, OSP_FLOAT,
-                    &_serializedCylindersData[materialId][0],
-                    OSP_DATA_SHARED_BUFFER );
+    // Buckets hold similar numbers of primitives, all the primitives of a
+    // given timestamp being in the same bucket
+    std::sort( timestamps.begin(), timestamps.end( ));
+    floats births;
+    for( size_t i = 0; i < NB_GROWTH_BUCKETS; ++i )
+    {
+        const float birth = timestamps[i * timestamps.size() / NB_GROWTH_BUCKETS];
+        if( births.empty() || birth > births.back( ))
+            births.push_back( birth );
+    }
+    floats().swap( timestamps );
+
+    // Primitives are reordered in place, so that every bucket is a range of
+    // the arrays of its material, shared with OSPRay like the other
+    // geometries. Groups are split by bucket to keep covering a single range
+    // of every array, so that materials can still be reassigned.
+    const size_t nbBuckets = births.size();
+    std::vector< PrimitivesGroups > splitGroups( _primitivesGroups.size( ));
+    std::map< size_t, GrowthBucketOffsets > offsets;
+    for( auto& primitives: _primitives )
+    {
+        const size_t materialId = primitives.first;
+        if( materialId >= _materials.size( ))
+            continue;
 
-                ospSet1i( extendedCylinders, "materialID", materialId );
-                ospSetObject( extendedCylinders, "extendedcylinders", data);
-                ospSet1i(extendedCylinders, "bytes_per_extended_cylinder",
-                    Cylinder::getSerializationSize() * sizeof(float));
-                ospSet1i(extendedCylinders,
-                    "offset_timestamp", 7 * sizeof(float));
-                ospSet1i(extendedCylinders, "offset_value", 8 * sizeof(float));
+        std::vector< size_t > groups;
+        for( size_t i = 0; i < _primitivesGroups.size(); ++i )
+        {
+            if( _primitivesGroups[i].material != materialId )
+                continue;
+            PrimitivesGroup split = _primitivesGroups[i];
+            split.firstSphere = split.nbSpheres = 0;
+            split.firstCylinder = split.nbCylinders = 0;
+            split.firstCone = split.nbCones = 0;
+            split.firstRoundedCone = split.nbRoundedCones = 0;
+            splitGroups[i].assign( nbBuckets, split );
+            groups.push_back( i );
+        }
 
-                if( _ospMaterials[materialId] )
-                    ospSetMaterial( extendedCylinders,
-                                    _ospMaterials[materialId]);
+        GrowthBucketOffsets& bucketOffsets = offsets[materialId];
+        bucketOffsets.spheres = sortInGrowthBuckets(
+            primitives.second.getSpheres(), births, groups,
+            _primitivesGroups, splitGroups,
+            &PrimitivesGroup::firstSphere, &PrimitivesGroup::nbSpheres );
+        bucketOffsets.cylinders = sortInGrowthBuckets(
+            primitives.second.getCylinders(), births, groups,
+            _primitivesGroups, splitGroups,
+            &PrimitivesGroup::firstCylinder, &PrimitivesGroup::nbCylinders );
+        bucketOffsets.cones = sortInGrowthBuckets(
+            primitives.second.getCones(), births, groups,
+            _primitivesGroups, splitGroups,
+            &PrimitivesGroup::firstCone, &PrimitivesGroup::nbCones );
+        bucketOffsets.roundedCones = sortInGrowthBuckets(
+            primitives.second.getRoundedCones(), births, groups,
+            _primitivesGroups, splitGroups,
+            &PrimitivesGroup::firstRoundedCone,
+            &PrimitivesGroup::nbRoundedCones );
+    }
 
-                ospCommit(extendedCylinders);
-                ospAddGeometry( model.second, extendedCylinders);
+    PrimitivesGroups groups;
+    for( size_t i = 0; i < _primitivesGroups.size(); ++i )
+    {
+        const size_t nbGroups = groups.size();
+        for( const PrimitivesGroup& group: splitGroups[i] )
+            if( group.nbSpheres + group.nbCylinders + group.nbCones +
+                group.nbRoundedCones > 0 )
+            {
+                groups.push_back( group );
             }
-        }
+        if( groups.size() == nbGroups )
+            groups.push_back( _primitivesGroups[i] );
     }
+    _primitivesGroups.swap( groups );
 
-    // Extended cones
-    for( const auto& timestampConesIndex: _timestampConesIndices[materialId] )
+    // Every bucket is committed once, in a model of its own. Models of the
+    // timestamps reference the buckets that are already born, so that the
+    // others are skipped as a whole, and rely on the intersection functions
+    // to discard the primitives of the last bucket that are not born yet.
+    for( size_t i = 0; i < nbBuckets; ++i )
     {
-        const size_t conesBufferSize =
-            timestampConesIndex.second * Cone::getSerializationSize();
-
-        for( const auto& model: _models )
+        OSPModel model = ospNewModel();
+        for( const auto& bucketOffsets: offsets )
         {
-            if( timestampConesIndex.first <= model.first )
-            {
-                OSPGeometry extendedCones = ospNewGeometry("extendedcones");
-                assert(extendedCones);
+            const Primitives& primitives = _primitives[bucketOffsets.first];
+            GeometryBuffers buffers{};
+            buffers[CBT_SPHERES] = makeBucketBuffer(
+                primitives.getSpheres(), bucketOffsets.second.spheres, i );
+            buffers[CBT_CYLINDERS] = makeBucketBuffer(
+                primitives.getCylinders(), bucketOffsets.second.cylinders, i );
+            buffers[CBT_CONES] = makeBucketBuffer(
+                primitives.getCones(), bucketOffsets.second.cones, i );
+            buffers[CBT_ROUNDED_CONES] = makeBucketBuffer(
+                primitives.getRoundedCones(),
+                bucketOffsets.second.roundedCones, i );
+            _addParametricOSPGeometry( model, bucketOffsets.first, buffers );
+        }
+        ospCommit( model );
+
+        // Instances keep the model, and the models of the timestamps keep
+        // the instances
+        OSPGeometry instance = ospNewInstance( model, toAffine( Matrix4f( )));
+        ospRelease( model );
+        for( const auto& sceneModel: _models )
+            if( size_t( births[i] ) <= sceneModel.first )
+                ospAddGeometry( sceneModel.second, instance );
+        ospRelease( instance );
+    }
 
-                OSPData data = ospNewData(
-                    conesBufferSize, OSP_FLOAT,
-                    &_serializedConesData[materialId][0],
-                    OSP_DATA_SHARED_BUFFER );
+    BRAYNS_INFO << nbBuckets << " growth buckets shared by "
+                << _models.size() << " models" << std::endl;
+}
 
-                ospSet1i( extendedCones, "materialID", materialId );
-                ospSetObject(extendedCones, "extendedcones", data);
-                ospSet1i(extendedCones, "bytes_per_extended_cone",
-                    Cone::getSerializationSize() * sizeof(float));
-                ospSet1i(extendedCones, "offset_timestamp", 8 * sizeof(float));
-                ospSet1i(extendedCones, "offset_value", 9 * sizeof(float));
+void OSPRayScene::_buildInstancedOSPGeometry()
+{
+    size_t nbInstances = 0;
+    for( auto& instancedGeometry: _instancedGeometries )
+    {
+        // The geometry is committed once, in a model of its own that is
+        // referenced by all its instances
+        OSPModel model = ospNewModel();
+        for( const auto& primitives: instancedGeometry.getPrimitives( ))
+        {
+            if( primitives.first >= _materials.size( ))
+                continue;
+            GeometryBuffers buffers{};
+            setPrimitivesBuffers( primitives.second, buffers );
+            _addParametricOSPGeometry( model, primitives.first, buffers );
+        }
 
-                if( _ospMaterials[materialId] )
-                    ospSetMaterial( extendedCones, _ospMaterials[materialId]);
+        for( auto& mesh: instancedGeometry.getTrianglesMeshes( ))
+        {
+            const size_t materialId = mesh.first;
+            GeometryBuffers buffers{};
+            setMeshBuffers( mesh.second, buffers );
+            if( materialId < _materials.size() &&
+                buffers[CBT_VERTICES].size != 0 )
+            {
+                OSPGeometry geometry =
+                    _createTrianglesMesh( materialId, buffers );
+                ospAddGeometry( model, geometry );
+                ospRelease( geometry );
+            }
+        }
+        ospCommit( model );
 
-                ospCommit( extendedCones );
-                ospAddGeometry( model.second, extendedCones );
-           }
-       }
+        for( const auto& transform: instancedGeometry.getTransforms( ))
+        {
+            OSPGeometry instance =
+                ospNewInstance( model, toAffine( transform ));
+            for( const auto& sceneModel: _models )
+                ospAddGeometry( sceneModel.second, instance );
+            ospRelease( instance );
+        }
+        ospRelease( model );
+        nbInstances += instancedGeometry.getTransforms().size();
     }
+
+    if( !_instancedGeometries.empty( ))
+        BRAYNS_INFO << _instancedGeometries.size() << " instanced geometries, "
+                    << nbInstances << " instances" << std::endl;
 }
 
 void OSPRayScene::buildGeometry()
@@ -589,21 +1679,28 @@ void OSPRayScene::buildGeometry()
 
     BRAYNS_INFO << "Building OSPRay geometry" << std::endl;
 
-    if( _parametersManager.getGeometryParameters().getGenerateMultipleModels() )
+    const auto& geometryParameters = _parametersManager.getGeometryParameters();
+    const bool growthAnimation = geometryParameters.getGrowthAnimation();
+    if( geometryParameters.getGenerateMultipleModels() || growthAnimation )
     {
         // Initialize models according to timestamps
-        for( size_t materialId = 0; materialId < _materials.size(); ++materialId )
+        std::set< size_t > timestamps;
+        for( const auto& primitives: _primitives )
         {
-            for( const PrimitivePtr& primitive: _primitives[materialId] )
-            {
-                const size_t ts = primitive->getTimestamp();
-                if( _models.find(ts) == _models.end())
-                {
-                    _models[ts] = ospNewModel();
-                    BRAYNS_INFO << "Model created for timestamp " << ts
-                                << ": " << _models[ts] << std::endl;
-                }
-            }
+            for( const Sphere& sphere: primitives.second.getSpheres( ))
+                timestamps.insert( sphere.timestamp );
+            for( const Cylinder& cylinder: primitives.second.getCylinders( ))
+                timestamps.insert( cylinder.timestamp );
+            for( const Cone& cone: primitives.second.getCones( ))
+                timestamps.insert( cone.timestamp );
+            for( const RoundedCone& cone: primitives.second.getRoundedCones( ))
+                timestamps.insert( cone.timestamp );
+        }
+        for( const size_t ts: timestamps )
+        {
+            _models[ts] = ospNewModel();
+            BRAYNS_INFO << "Model created for timestamp " << ts
+                        << ": " << _models[ts] << std::endl;
         }
     }
     if( _models.size() == 0 )
@@ -615,143 +1712,160 @@ void OSPRayScene::buildGeometry()
     size_t totalNbVertices = 0;
     size_t totalNbIndices = 0;
 
+    // Primitives are sorted once all of them are loaded. Groups follow their
+    // primitives, the geometry can then be rebuilt after radius and color
+    // scheme changes without sorting them again
+    const bool sortPrimitives = !_primitivesSorted && !isLoading();
+
     // Process geometries
     for( size_t materialId = 0; materialId < _materials.size(); ++materialId )
     {
-        _serializedSpheresDataSize[ materialId ] = 0;
-        _serializedCylindersDataSize[ materialId ] = 0;
-        _serializedConesDataSize[ materialId ] = 0;
-
-        size_t sphereCount = 0;
-        size_t cylinderCount = 0;
-        size_t coneCount = 0;
-        if( _primitives.find( materialId ) != _primitives.end( ))
+        const auto it = _primitives.find( materialId );
+        if( it != _primitives.end( ))
         {
-            for( const PrimitivePtr& primitive: _primitives[materialId] )
-            {
-                const float ts =
-                    ( _models.size() == 1 ) ? 0.f : primitive->getTimestamp();
-                switch(primitive->getGeometryType())
-                {
-                    case GT_SPHERE:
-                    {
-                        primitive->serializeData(_serializedSpheresData[materialId]);
-                        ++_serializedSpheresDataSize[materialId];
-                        ++sphereCount;
-                        _timestampSpheresIndices[materialId][ts] = sphereCount;
-                    }
-                    break;
-                    case GT_CYLINDER:
-                    {
-                        primitive->serializeData(_serializedCylindersData[materialId]);
-                        ++_serializedCylindersDataSize[materialId];
-                        ++cylinderCount;
-                        _timestampCylindersIndices[materialId][ts] = cylinderCount;
-                    }
-                    break;
-                    case GT_CONE:
-                    {
-                        primitive->serializeData(_serializedConesData[materialId]);
-                        ++_serializedConesDataSize[materialId];
-                        ++coneCount;
-                        _timestampConesIndices[materialId][ts] = coneCount;
-                    }
-                    default:
-                        break;
-                }
-            }
-            _buildParametricOSPGeometry( materialId );
+            // Primitives are stored in the layout expected by the extended
+            // geometries and are shared with OSPRay as they are
+            const Primitives& primitives = it->second;
+            const bool singleModel = ( _models.size() == 1 );
+            if( singleModel && sortPrimitives )
+                _sortPrimitives( materialId );
+            setTimestampIndices( primitives.getSpheres(), singleModel,
+                                 _timestampSpheresIndices[materialId] );
+            setTimestampIndices( primitives.getCylinders(), singleModel,
+                                 _timestampCylindersIndices[materialId] );
+            setTimestampIndices( primitives.getCones(), singleModel,
+                                 _timestampConesIndices[materialId] );
+            setTimestampIndices( primitives.getRoundedCones(), singleModel,
+                                 _timestampRoundedConesIndices[materialId] );
+            if( !growthAnimation )
+                _buildParametricOSPGeometry(
+                    materialId, _getGeometryBuffers( materialId ));
         }
 
         // Triangle meshes
         if( _trianglesMeshes.find( materialId ) != _trianglesMeshes.end( ))
         {
-            _buildMeshOSPGeometry( materialId );
+            _buildMeshOSPGeometry(
+                materialId, _getGeometryBuffers( materialId ));
             totalNbVertices += _trianglesMeshes[materialId].getVertices().size();
             totalNbIndices += _trianglesMeshes[materialId].getIndices().size();
         }
     }
 
+    if( sortPrimitives )
+        _primitivesSorted = true;
+
+    if( growthAnimation )
+        _buildGrowthOSPGeometry();
+    _buildInstancedOSPGeometry();
+
     commitLights();
 
-    if(!_parametersManager.getGeometryParameters().getLoadCacheFile().empty())
+    // The geometry is rebuilt for every batch of data loaded in the
+    // background, the cache file is only loaded and saved with the last one
+    if( !isLoading() &&
+        !_parametersManager.getGeometryParameters().getLoadCacheFile().empty( ))
         _loadCacheFile();
 
     size_t totalNbSpheres = 0;
     size_t totalNbCylinders = 0;
     size_t totalNbCones = 0;
-    for( size_t i = 0; i < _materials.size(); ++i )
+    size_t totalNbRoundedCones = 0;
+    for( const auto& primitives: _primitives )
     {
-        totalNbSpheres += _serializedSpheresDataSize[i];
-        totalNbCylinders += _serializedCylindersDataSize[i];
-        totalNbCones += _serializedConesDataSize[i];
+        totalNbSpheres += primitives.second.getSpheres().size();
+        totalNbCylinders += primitives.second.getCylinders().size();
+        totalNbCones += primitives.second.getCones().size();
+        totalNbRoundedCones += primitives.second.getRoundedCones().size();
     }
 
     BRAYNS_INFO << "--------------------" << std::endl;
     BRAYNS_INFO << "Primitive information" << std::endl;
-    BRAYNS_INFO << "Spheres  : " << totalNbSpheres << std::endl;
-    BRAYNS_INFO << "Cylinders: " << totalNbCylinders << std::endl;
-    BRAYNS_INFO << "Cones    : " << totalNbCones << std::endl;
-    BRAYNS_INFO << "Vertices : " << totalNbVertices << std::endl;
-    BRAYNS_INFO << "Indices  : " << totalNbIndices << std::endl;
+    BRAYNS_INFO << "Spheres      : " << totalNbSpheres << std::endl;
+    BRAYNS_INFO << "Cylinders    : " << totalNbCylinders << std::endl;
+    BRAYNS_INFO << "Cones        : " << totalNbCones << std::endl;
+    BRAYNS_INFO << "Rounded cones: " << totalNbRoundedCones << std::endl;
+    BRAYNS_INFO << "Vertices     : " << totalNbVertices << std::endl;
+    BRAYNS_INFO << "Indices      : " << totalNbIndices << std::endl;
     BRAYNS_INFO << "--------------------" << std::endl;
 
-    if(!_parametersManager.getGeometryParameters().getSaveCacheFile().empty())
+    if( !isLoading() &&
+        !_parametersManager.getGeometryParameters().getSaveCacheFile().empty( ))
         _saveCacheFile();
 }
 
-void OSPRayScene::_buildMeshOSPGeometry( const size_t materialId )
+void OSPRayScene::_buildMeshOSPGeometry(
+    const size_t materialId,
+    const GeometryBuffers& buffers )
 {
     // Triangle mesh
-    if( _trianglesMeshes.find(materialId) != _trianglesMeshes.end() )
-    {
-        OSPGeometry mesh = ospNewGeometry("trianglemesh");
-        assert(mesh);
-        OSPData vertices = ospNewData(
-            _trianglesMeshes[materialId].getVertices().size(),
-            OSP_FLOAT3,
-            &_trianglesMeshes[materialId].getVertices()[0],
-            OSP_DATA_SHARED_BUFFER);
-
-        OSPData normals = ospNewData(
-            _trianglesMeshes[materialId].getNormals().size(),
-            OSP_FLOAT3,
-            &_trianglesMeshes[materialId].getNormals()[0],
-            OSP_DATA_SHARED_BUFFER);
-        OSPData indices = ospNewData(
-            _trianglesMeshes[materialId].getIndices().size(),
-            OSP_INT3,
-            &_trianglesMeshes[materialId].getIndices()[0],
-            OSP_DATA_SHARED_BUFFER);
-
-        OSPData colors = ospNewData(
-            _trianglesMeshes[materialId].getColors().size(),
-            OSP_FLOAT3A,
-            &_trianglesMeshes[materialId].getColors()[0],
-            OSP_DATA_SHARED_BUFFER);
-        OSPData texcoord = ospNewData(
-            _trianglesMeshes[materialId].getTextureCoordinates().size(),
-            OSP_FLOAT2,
-            &_trianglesMeshes[materialId].getTextureCoordinates()[0],
-            OSP_DATA_SHARED_BUFFER);
-        ospSetObject(mesh,"position",vertices);
-        ospSetObject(mesh,"index",indices);
-        ospSetObject(mesh,"vertex.normal",normals);
-        ospSetObject(mesh,"vertex.color",colors);
-        ospSetObject(mesh,"vertex.texcoord",texcoord);
-        ospSet1i(mesh, "alpha_type", 0);
-        ospSet1i(mesh, "alpha_component", 4);
-
-        if (_ospMaterials[materialId])
-            ospSetMaterial(mesh, _ospMaterials[materialId]);
-
-        ospCommit(mesh);
-
-        // Meshes are by default added to all timestamps
-        for( const auto& model: _models )
-            ospAddGeometry( model.second, mesh);
-    }
+    if( buffers[CBT_VERTICES].size == 0 )
+        return;
 
+    OSPGeometry mesh = _createTrianglesMesh( materialId, buffers );
+
+    // Meshes are by default added to all timestamps
+    for( const auto& model: _models )
+        ospAddGeometry( model.second, mesh);
+    ospRelease( mesh );
+}
+
+OSPGeometry OSPRayScene::_createTrianglesMesh(
+    const size_t materialId,
+    const GeometryBuffers& buffers )
+{
+    OSPGeometry mesh = ospNewGeometry("trianglemesh");
+    assert(mesh);
+    OSPData vertices = ospNewData(
+        buffers[CBT_VERTICES].size / sizeof( Vector3f ),
+        OSP_FLOAT3,
+        buffers[CBT_VERTICES].data,
+        OSP_DATA_SHARED_BUFFER);
+
+    OSPData normals = ospNewData(
+        buffers[CBT_NORMALS].size / sizeof( Vector3f ),
+        OSP_FLOAT3,
+        buffers[CBT_NORMALS].data,
+        OSP_DATA_SHARED_BUFFER);
+    OSPData indices = ospNewData(
+        buffers[CBT_INDICES].size / sizeof( Vector3ui ),
+        OSP_INT3,
+        buffers[CBT_INDICES].data,
+        OSP_DATA_SHARED_BUFFER);
+
+    OSPData colors = ospNewData(
+        buffers[CBT_COLORS].size / sizeof( Vector4f ),
+        OSP_FLOAT3A,
+        buffers[CBT_COLORS].data,
+        OSP_DATA_SHARED_BUFFER);
+    OSPData texcoord = ospNewData(
+        buffers[CBT_TEXTURE_COORDINATES].size / sizeof( Vector2f ),
+        OSP_FLOAT2,
+        buffers[CBT_TEXTURE_COORDINATES].data,
+        OSP_DATA_SHARED_BUFFER);
+    ospSetObject(mesh,"position",vertices);
+    ospSetObject(mesh,"index",indices);
+    ospSetObject(mesh,"vertex.normal",normals);
+    ospSetObject(mesh,"vertex.color",colors);
+    ospSetObject(mesh,"vertex.texcoord",texcoord);
+    ospRelease( vertices );
+    ospRelease( indices );
+    ospRelease( normals );
+    ospRelease( colors );
+    ospRelease( texcoord );
+    ospSet1i(mesh, "alpha_type", 0);
+    ospSet1i(mesh, "alpha_component", 4);
+
+    if (_ospMaterials[materialId])
+        ospSetMaterial(mesh, _ospMaterials[materialId]);
+
+    ospCommit(mesh);
+    return mesh;
+}
+
+bool OSPRayScene::empty() const
+{
+    return Scene::empty() && _cachedGeometryBuffers.empty();
 }
 
 void OSPRayScene::commitLights()
@@ -923,46 +2037,163 @@ void OSPRayScene::commitTransferFunctionData()
         ospSet1f( osprayRenderer->impl(),  "transferFunctionRange",
             _transferFunction.getValuesRange().y() - _transferFunction.getValuesRange().x() );
     }
+    _commitVolumeOpacityTable();
+    _commitVolumeMacroCells();
 }
 
-void OSPRayScene::commitVolumeData()
+void OSPRayScene::_commitVolumeOpacityTable()
+{
+    const Vector4fs& colors = _transferFunction.getDiffuseColors();
+    if( colors.empty() || _volumeOpacityCorrection <= 0.f )
+        return;
+
+    // Opacity of each color, corrected for steps of 1 to NB_VOLUME_STEP_FACTORS epsilons, so that
+    // renderers do not have to compute it for every sample
+    const float maxOpacity = 1.f - 1.f / float( colors.size( ));
+    _volumeOpacityTable.resize( NB_VOLUME_STEP_FACTORS * colors.size( ));
+    for( size_t factor = 1; factor <= NB_VOLUME_STEP_FACTORS; ++factor )
+        for( size_t i = 0; i < colors.size(); ++i )
+        {
+            const float opacity = std::max( 0.f, std::min( colors[i].w(), maxOpacity ));
+            _volumeOpacityTable[( factor - 1 ) * colors.size() + i] =
+                1.f - std::pow( 1.f - opacity, factor * _volumeOpacityCorrection );
+        }
+
+    if( _ospVolumeOpacityData )
+        ospRelease( _ospVolumeOpacityData );
+    _ospVolumeOpacityData = ospNewData( _volumeOpacityTable.size(), OSP_FLOAT,
+        _volumeOpacityTable.data(), OSP_DATA_SHARED_BUFFER );
+    ospCommit( _ospVolumeOpacityData );
+
+    for( const auto& renderer: _renderers )
+    {
+        OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
+        ospSetData( osprayRenderer->impl(), "volumeOpacityTable", _ospVolumeOpacityData );
+    }
+}
+
+void OSPRayScene::_commitVolumeMacroCells()
 {
     VolumeHandlerPtr volumeHandler = getVolumeHandler();
-    if( !volumeHandler )
+    if( !volumeHandler || !volumeHandler->getData( ))
         return;
 
-    const float timestamp = _parametersManager.getSceneParameters().getTimestamp();
-    volumeHandler->setTimestamp( timestamp );
-    void* data = volumeHandler->getData();
-    if( data )
+    const uint8_ts& macroCells = volumeHandler->getMacroCells();
+    _volumeMacroCellMargin = volumeHandler->getMacroCellMargin();
+    const size_t nbMacroCells = macroCells.size() / 2;
+    if( nbMacroCells == 0 )
     {
         for( const auto& renderer: _renderers )
         {
             OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
+            ospSet1i( osprayRenderer->impl(), "volumeMacroCellSize", 0 );
+        }
+        return;
+    }
 
-            const size_t size = volumeHandler->getSize();
+    // A macro cell is transparent if all the transfer function colors between its minimum and
+    // maximum values are, using the same lookup as the renderers
+    const Vector4fs& colors = _transferFunction.getDiffuseColors();
+    const float minValue = _transferFunction.getValuesRange().x();
+    const float range = _transferFunction.getValuesRange().y() - minValue;
+    _volumeMacroCellVisibility.assign( nbMacroCells, 1 );
+    if( !colors.empty() && range > 0.f )
+    {
+        const int maxIndex = colors.size() - 1;
+        std::vector< size_t > nbOpaqueColors( colors.size() + 1, 0 );
+        for( size_t i = 0; i < colors.size(); ++i )
+            nbOpaqueColors[i + 1] = nbOpaqueColors[i] + ( colors[i].w() > 0.f ? 1 : 0 );
 
-            _ospVolumeData = ospNewData( size, OSP_UCHAR, data, OSP_DATA_SHARED_BUFFER );
-            ospCommit( _ospVolumeData );
-            ospSetData( osprayRenderer->impl(), "volumeData", _ospVolumeData );
+        for( size_t i = 0; i < nbMacroCells; ++i )
+        {
+            const int first = std::max( 0, std::min( maxIndex,
+                int( colors.size() * ( macroCells[ 2 * i ] - minValue ) / range )));
+            const int last = std::max( 0, std::min( maxIndex,
+                int( colors.size() * ( macroCells[ 2 * i + 1 ] - minValue ) / range )));
+            _volumeMacroCellVisibility[i] = nbOpaqueColors[last + 1] > nbOpaqueColors[first];
+        }
+    }
 
-            const Vector3ui& dimensions = volumeHandler->getDimensions();
-            ospSet3i( osprayRenderer->impl(),
-                "volumeDimensions", dimensions.x(), dimensions.y(), dimensions.z() );
+    if( _ospVolumeMacroCellData )
+        ospRelease( _ospVolumeMacroCellData );
+    _ospVolumeMacroCellData = ospNewData( nbMacroCells, OSP_UCHAR,
+        _volumeMacroCellVisibility.data(), OSP_DATA_SHARED_BUFFER );
+    ospCommit( _ospVolumeMacroCellData );
 
-            const Vector3f& elementSpacing =
-                _parametersManager.getVolumeParameters().getElementSpacing();
-            ospSet3f( osprayRenderer->impl(),
-                "volumeElementSpacing", elementSpacing.x(), elementSpacing.y(), elementSpacing.z());
+    const Vector3ui nbCells = volumeHandler->getNbMacroCells();
+    for( const auto& renderer: _renderers )
+    {
+        OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
+        ospSetData( osprayRenderer->impl(), "volumeMacroCells", _ospVolumeMacroCellData );
+        ospSet1i( osprayRenderer->impl(), "volumeMacroCellSize",
+                  volumeHandler->getMacroCellSize( ));
+        ospSet3i( osprayRenderer->impl(),
+            "volumeNbMacroCells", nbCells.x(), nbCells.y(), nbCells.z() );
+    }
+}
 
-            const Vector3f& offset = _parametersManager.getVolumeParameters().getOffset();
-            ospSet3f( osprayRenderer->impl(),
-                "volumeOffset", offset.x(), offset.y(), offset.z() );
+void OSPRayScene::commitVolumeData()
+{
+    VolumeHandlerPtr volumeHandler = getVolumeHandler();
+    if( !volumeHandler )
+        return;
 
-            const float epsilon = volumeHandler->getEpsilon(
-                elementSpacing, _parametersManager.getVolumeParameters().getSamplesPerRay());
-            ospSet1f( osprayRenderer->impl(), "volumeEpsilon", epsilon );
-        }
+    const float timestamp = _parametersManager.getSceneParameters().getTimestamp();
+    volumeHandler->setTimestamp( timestamp );
+    void* data = volumeHandler->getData();
+    if( !data )
+        return;
+
+    // The volume is shared with OSPRay, and only changes with the timestamp or the level
+    const size_t size = volumeHandler->getSize();
+    if( !_ospVolumeData || data != _ospVolumeDataPtr || size != _ospVolumeDataSize )
+    {
+        if( _ospVolumeData )
+            ospRelease( _ospVolumeData );
+        _ospVolumeData = ospNewData( size, OSP_UCHAR, data, OSP_DATA_SHARED_BUFFER );
+        ospCommit( _ospVolumeData );
+        _ospVolumeDataPtr = data;
+        _ospVolumeDataSize = size;
+        _commitVolumeMacroCells();
+    }
+    else if( volumeHandler->getMacroCellMargin() != _volumeMacroCellMargin )
+        // Turning gradient shading on or off changes the margin of the macro cells
+        _commitVolumeMacroCells();
+
+    // Coarser levels cover the same space with fewer, larger voxels
+    const Vector3ui dimensions = volumeHandler->getLevelDimensions();
+    const Vector3f elementSpacing =
+        _parametersManager.getVolumeParameters().getElementSpacing() *
+        Vector3f( volumeHandler->getDimensions( )) / Vector3f( dimensions );
+    const Vector3f& offset = _parametersManager.getVolumeParameters().getOffset();
+    const float epsilon = volumeHandler->getEpsilon(
+        _parametersManager.getVolumeParameters().getElementSpacing(),
+        _parametersManager.getVolumeParameters().getSamplesPerRay());
+
+    // Opacities depend on the length of the steps relative to the size of the volume
+    const float opacityCorrection =
+        epsilon / ( Vector3f( dimensions ) * elementSpacing ).find_max();
+    if( opacityCorrection != _volumeOpacityCorrection )
+    {
+        _volumeOpacityCorrection = opacityCorrection;
+        _commitVolumeOpacityTable();
+    }
+
+    for( const auto& renderer: _renderers )
+    {
+        OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
+
+        ospSetData( osprayRenderer->impl(), "volumeData", _ospVolumeData );
+        ospSet3i( osprayRenderer->impl(),
+            "volumeDimensions", dimensions.x(), dimensions.y(), dimensions.z() );
+        ospSet1i( osprayRenderer->impl(), "volumeBrickSize", volumeHandler->getBrickSize( ));
+        ospSet3f( osprayRenderer->impl(),
+            "volumeElementSpacing", elementSpacing.x(), elementSpacing.y(), elementSpacing.z());
+        ospSet3f( osprayRenderer->impl(),
+            "volumeOffset", offset.x(), offset.y(), offset.z() );
+        ospSet1f( osprayRenderer->impl(), "volumeEpsilon", epsilon );
+        ospSet1i( osprayRenderer->impl(), "volumeGradientShading",
+                  _parametersManager.getVolumeParameters().getGradientShading( ));
     }
 }
 
@@ -971,20 +2202,40 @@ void OSPRayScene::commitSimulationData()
     if( !_simulationHandler )
         return;
 
-    for( const auto& renderer: _renderers )
+    // Nothing to do as long as the timestamp does not change, unless the data that was committed
+    // for it is not up to date yet (frame still being loaded, or live spikes pending)
+    const float timestamp = _parametersManager.getSceneParameters().getTimestamp();
+    if( _ospSimulationData && timestamp == _simulationTimestamp &&
+        _committedSimulationHandler.lock() == _simulationHandler &&
+        _simulationHandler->isReady( ))
     {
-        OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
+        return;
+    }
 
-        // Simulation data
-        const uint64_t frame = _parametersManager.getSceneParameters().getTimestamp();
+    // Simulation data
+    _simulationHandler->setTimestamp( timestamp );
+    void* data = _simulationHandler->getFrameData();
+    const uint64_t size = _simulationHandler->getFrameSize();
+    _simulationTimestamp = timestamp;
+    _committedSimulationHandler = _simulationHandler;
 
-        _simulationHandler->setTimestamp( frame );
-        _ospSimulationData = ospNewData(
-            _simulationHandler->getFrameSize(), OSP_FLOAT,
-            _simulationHandler->getFrameData(), OSP_DATA_SHARED_BUFFER );
-        ospCommit( _ospSimulationData );
+    // The data is shared with OSPRay, buffers that are updated in place (e.g. live spikes) do
+    // not need a new OSPData
+    if( _ospSimulationData && data == _ospSimulationDataPtr && size == _ospSimulationDataSize )
+        return;
+
+    if( _ospSimulationData )
+        ospRelease( _ospSimulationData );
+    _ospSimulationData = ospNewData( size, OSP_FLOAT, data, OSP_DATA_SHARED_BUFFER );
+    ospCommit( _ospSimulationData );
+    _ospSimulationDataPtr = data;
+    _ospSimulationDataSize = size;
+
+    // Renderers are committed by the engine before rendering
+    for( const auto& renderer: _renderers )
+    {
+        OSPRayRenderer* osprayRenderer = dynamic_cast<OSPRayRenderer*>( renderer.get( ));
         ospSetData( osprayRenderer->impl(), "simulationData", _ospSimulationData );
-        ospCommit(osprayRenderer->impl());
     }
 }
 
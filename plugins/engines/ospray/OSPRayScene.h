@@ -23,6 +23,7 @@
 
 #include <brayns/common/types.h>
 #include <brayns/common/scene/Scene.h>
+#include <plugins/engines/ospray/OSPRaySceneCache.h>
 
 #include <ospray_cpp/Model.h>
 #include <ospray_cpp/Texture2D.h>
@@ -50,12 +51,17 @@ public:
         Renderers renderer,
         ParametersManager& parametersManager );
 
+    ~OSPRayScene();
+
     /** @copydoc Scene::commit */
     void commit() final;
 
     /** @copydoc Scene::buildGeometry */
     void buildGeometry() final;
 
+    /** @copydoc Scene::resetGeometry */
+    void resetGeometry() final;
+
     /** @copydoc Scene::commitLights */
     void commitLights() final;
 
@@ -77,16 +83,48 @@ public:
     /** @copydoc Scene::saveSceneToCacheFile */
     void saveSceneToCacheFile() final;
 
+    /** @copydoc Scene::empty */
+    bool empty() const final;
+
     OSPModel* modelImpl( const size_t timestamp );
 
 private:
 
     OSPTexture2D _createTexture2D(const std::string& textureName);
 
-    void _buildParametricOSPGeometry( const size_t materialId );
-    void _buildMeshOSPGeometry( const size_t materialId );
+    GeometryBuffers _getGeometryBuffers( size_t materialId );
+    OSPGeometry _createExtendedSpheres(
+        size_t materialId, const void* spheres, size_t nbSpheres );
+    OSPGeometry _createExtendedCylinders(
+        size_t materialId, const void* cylinders, size_t nbCylinders );
+    OSPGeometry _createExtendedCones(
+        size_t materialId, const void* cones, size_t nbCones );
+    OSPGeometry _createExtendedRoundedCones(
+        size_t materialId, const void* roundedCones, size_t nbRoundedCones );
+    OSPGeometry _createTrianglesMesh(
+        size_t materialId, const GeometryBuffers& buffers );
+    void _sortPrimitives( size_t materialId );
+    void _addParametricOSPGeometry(
+        OSPModel model, size_t materialId, const GeometryBuffers& buffers );
+    void _buildGrowthOSPGeometry();
+    void _buildInstancedOSPGeometry();
+    void _buildParametricOSPGeometry(
+        size_t materialId, const GeometryBuffers& buffers );
+    void _buildMeshOSPGeometry(
+        size_t materialId, const GeometryBuffers& buffers );
+
+    void _commitVolumeOpacityTable();
+    void _commitVolumeMacroCells();
+
     void _loadCacheFile();
     void _saveCacheFile();
+    bool _mapCacheFile( const std::string& filename );
+    void _unmapCacheFile();
+    bool _isInCacheFile( uint64_t offset, uint64_t size ) const;
+    bool _mapCacheBuffer( const CacheBuffer& chunk, const CacheBlock* blocks,
+                          GeometryBuffer& buffer ) const;
+    bool _readCacheBlock( const CacheBlock& block, uint64_t size, char* dst,
+                          bool verify ) const;
 
     std::map< size_t, OSPModel > _models;
     std::vector< OSPMaterial > _ospMaterials;
@@ -96,24 +134,40 @@ private:
     OSPData _ospLightData;
     OSPData _ospMaterialData;
     OSPData _ospVolumeData;
+    void* _ospVolumeDataPtr;
+    uint64_t _ospVolumeDataSize;
+    uint8_ts _volumeMacroCellVisibility;
+    OSPData _ospVolumeMacroCellData;
+    size_t _volumeMacroCellMargin;
+    floats _volumeOpacityTable;
+    OSPData _ospVolumeOpacityData;
+    float _volumeOpacityCorrection;
     OSPData _ospSimulationData;
+    void* _ospSimulationDataPtr;
+    uint64_t _ospSimulationDataSize;
+    float _simulationTimestamp;
+    std::weak_ptr< AbstractSimulationHandler > _committedSimulationHandler;
     OSPData _ospTransferFunctionDiffuseData;
     OSPData _ospTransferFunctionEmissionData;
 
     std::map< float, size_t > _timestamps;
 
-    std::map< size_t, floats > _serializedSpheresData;
-    std::map< size_t, floats > _serializedCylindersData;
-    std::map< size_t, floats > _serializedConesData;
-    std::map< size_t, size_t > _serializedSpheresDataSize;
-    std::map< size_t, size_t > _serializedCylindersDataSize;
-    std::map< size_t, size_t > _serializedConesDataSize;
-
     std::map< size_t, std::map< size_t, size_t > > _timestampSpheresIndices;
     std::map< size_t, std::map< size_t, size_t > > _timestampCylindersIndices;
     std::map< size_t, std::map< size_t, size_t > > _timestampConesIndices;
+    std::map< size_t, std::map< size_t, size_t > >
+        _timestampRoundedConesIndices;
+
+    // Whether the primitives were sorted in space since they were loaded
+    bool _primitivesSorted;
 
     float _currentTimestamp;
+
+    // Memory mapped cache file, and geometry buffers pointing into it
+    void* _cacheMemoryMapPtr;
+    uint64_t _cacheSize;
+    std::map< size_t, GeometryBuffers > _cachedGeometryBuffers;
+    std::vector< std::vector< char >> _cacheBuffers;
 };
 
 }
@@ -0,0 +1,150 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "OSPRaySceneCache.h"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef BRAYNS_USE_LZ4
+#  include <lz4.h>
+#endif
+
+namespace
+{
+const size_t CHECKSUM_SLICES = 8;
+typedef std::array< std::array< uint32_t, 256 >, CHECKSUM_SLICES >
+    ChecksumTables;
+
+/**
+ * Tables of the slicing-by-8 CRC32: tables[0] is the bytewise table, and
+ * tables[k] gives the CRC of a byte followed by k zero bytes
+ */
+ChecksumTables createChecksumTables()
+{
+    ChecksumTables tables;
+    for( uint32_t i = 0; i < 256; ++i )
+    {
+        uint32_t crc = i;
+        for( size_t bit = 0; bit < 8; ++bit )
+            crc = ( crc & 1 ) ? ( crc >> 1 ) ^ 0xEDB88320u : crc >> 1;
+        tables[0][i] = crc;
+    }
+    for( size_t k = 1; k < CHECKSUM_SLICES; ++k )
+        for( uint32_t i = 0; i < 256; ++i )
+            tables[k][i] = ( tables[k - 1][i] >> 8 ) ^
+                           tables[0][tables[k - 1][i] & 0xFF];
+    return tables;
+}
+}
+
+namespace brayns
+{
+
+uint64_t getCacheBlockCount( const uint64_t size )
+{
+    return ( size + CACHE_BLOCK_SIZE - 1 ) / CACHE_BLOCK_SIZE;
+}
+
+uint64_t getCacheBlockSize( const uint64_t size, const uint64_t block )
+{
+    return std::min( CACHE_BLOCK_SIZE, size - block * CACHE_BLOCK_SIZE );
+}
+
+uint32_t computeCacheChecksum( const void* data, const uint64_t size )
+{
+    static const ChecksumTables tables = createChecksumTables();
+
+    const uint8_t* bytes = static_cast< const uint8_t* >( data );
+    const uint8_t* end = bytes + size;
+    uint32_t crc = 0xFFFFFFFFu;
+    for( ; end - bytes >= int64_t( CHECKSUM_SLICES ); bytes += CHECKSUM_SLICES )
+    {
+        const uint32_t low = crc ^ ( uint32_t( bytes[0] ) |
+                                     uint32_t( bytes[1] ) << 8 |
+                                     uint32_t( bytes[2] ) << 16 |
+                                     uint32_t( bytes[3] ) << 24 );
+        crc = tables[7][low & 0xFF] ^ tables[6][( low >> 8 ) & 0xFF] ^
+              tables[5][( low >> 16 ) & 0xFF] ^ tables[4][low >> 24] ^
+              tables[3][bytes[4]] ^ tables[2][bytes[5]] ^
+              tables[1][bytes[6]] ^ tables[0][bytes[7]];
+    }
+    for( ; bytes < end; ++bytes )
+        crc = tables[0][( crc ^ *bytes ) & 0xFF] ^ ( crc >> 8 );
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#ifdef BRAYNS_USE_LZ4
+CacheCompression compressCacheBlock( const GeometryBuffer& buffer,
+                                     std::vector< char >& compressed )
+{
+    static_assert( CACHE_BLOCK_SIZE <= LZ4_MAX_INPUT_SIZE,
+                   "Cache blocks are too large to be compressed with LZ4" );
+    compressed.clear();
+    if( buffer.size == 0 || buffer.size > CACHE_BLOCK_SIZE )
+        return CC_NONE;
+
+    const int srcSize = buffer.size;
+    compressed.resize( LZ4_compressBound( srcSize ));
+    const int compressedSize = LZ4_compress_default(
+        static_cast< const char* >( buffer.data ), compressed.data(),
+        srcSize, compressed.size( ));
+    if( compressedSize <= 0 || uint64_t( compressedSize ) >= buffer.size )
+    {
+        std::vector< char >().swap( compressed );
+        return CC_NONE;
+    }
+    compressed.resize( compressedSize );
+    return CC_LZ4;
+}
+
+bool decompressCacheBlock( const CacheBlock& block, const void* src,
+                           char* dst, const uint64_t size )
+{
+    switch( block.compression )
+    {
+    case CC_NONE:
+        return false;
+    case CC_LZ4:
+        if( size > CACHE_BLOCK_SIZE ||
+            block.storedSize > uint64_t( std::numeric_limits< int >::max( )))
+            return false;
+        return LZ4_decompress_safe(
+            static_cast< const char* >( src ), dst,
+            block.storedSize, size ) == int( size );
+    default:
+        return false;
+    }
+}
+#else
+CacheCompression compressCacheBlock( const GeometryBuffer&,
+                                     std::vector< char >& compressed )
+{
+    compressed.clear();
+    return CC_NONE;
+}
+
+bool decompressCacheBlock( const CacheBlock&, const void*, char*, uint64_t )
+{
+    return false;
+}
+#endif
+
+}
@@ -0,0 +1,215 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef OSPRAYSCENECACHE_H
+#define OSPRAYSCENECACHE_H
+
+#include <brayns/common/material/Texture2D.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace brayns
+{
+
+/**
+   Binary scene cache file format
+
+   The file starts with a fixed size header, followed by the timestamps of the
+   models, the materials, a section table containing one entry per material,
+   the texture table, the transfer function and the block table. Section,
+   texture and transfer function entries reference their data by chunk.
+   Chunks are split in blocks of CACHE_BLOCK_SIZE bytes, that carry a checksum
+   of their stored bytes, verified on load when requested, and are optionally
+   compressed. The blocks of a chunk are stored consecutively, from an offset
+   aligned on CACHE_ALIGNMENT bytes, so that uncompressed chunks can be memory
+   mapped and handed over to OSPRay as they are. All offsets are in bytes,
+   from the beginning of the file.
+*/
+
+const char CACHE_MAGIC[8] = { 'B', 'R', 'A', 'Y', 'N', 'S', 'S', 'C' };
+const uint64_t CACHE_VERSION = 10;
+const uint64_t CACHE_ALIGNMENT = 4096;
+const uint64_t CACHE_BLOCK_SIZE = 64 * 1024 * 1024;
+const size_t CACHE_NB_TEXTURE_TYPES = TT_OCCLUSION + 1;
+const int32_t CACHE_NO_TEXTURE = -1;
+
+/** Buffers stored for every material */
+enum CacheBufferType
+{
+    CBT_SPHERES_TIMESTAMPS = 0,
+    CBT_SPHERES,
+    CBT_CYLINDERS_TIMESTAMPS,
+    CBT_CYLINDERS,
+    CBT_CONES_TIMESTAMPS,
+    CBT_CONES,
+    CBT_ROUNDED_CONES_TIMESTAMPS,
+    CBT_ROUNDED_CONES,
+    CBT_VERTICES,
+    CBT_INDICES,
+    CBT_NORMALS,
+    CBT_COLORS,
+    CBT_TEXTURE_COORDINATES,
+    CBT_COUNT
+};
+
+enum CacheCompression
+{
+    CC_NONE = 0,
+    CC_LZ4
+};
+
+struct CacheHeader
+{
+    char magic[8];
+    uint64_t version;
+    uint64_t nbModels;
+    uint64_t nbMaterials;
+    uint64_t nbTextures;
+    uint64_t modelsOffset;
+    uint64_t materialsOffset;
+    uint64_t sectionsOffset;
+    uint64_t texturesOffset;
+    uint64_t transferFunctionOffset;
+    uint64_t nbBlocks;
+    uint64_t blocksOffset;
+    float bounds[6];
+};
+static_assert( sizeof( CacheHeader ) == 120, "Unexpected cache header size" );
+
+/**
+ * Material attributes, as stored in the cache. Textures are indices in the
+ * texture table, CACHE_NO_TEXTURE if the material has no texture of that type
+ */
+struct CacheMaterial
+{
+    float color[3];
+    float specularColor[3];
+    float specularExponent;
+    float reflectionIndex;
+    float opacity;
+    float refractionIndex;
+    float emission;
+    int32_t textures[CACHE_NB_TEXTURE_TYPES];
+};
+
+/**
+ * Chunk of data. size is the size of the data once decompressed. The blocks
+ * of the chunk are the getCacheBlockCount( size ) consecutive entries of the
+ * block table starting at firstBlock.
+ */
+struct CacheBuffer
+{
+    uint64_t size;
+    uint64_t firstBlock;
+};
+
+/**
+ * Block table entry. storedSize is the number of bytes actually stored in the
+ * file, and checksum the CRC32 of these stored bytes.
+ */
+struct CacheBlock
+{
+    uint64_t offset;
+    uint64_t storedSize;
+    uint32_t compression;
+    uint32_t checksum;
+};
+
+/** Section table entry for a given material */
+struct CacheSection
+{
+    CacheBuffer buffers[CBT_COUNT];
+};
+
+/** Texture table entry. The name is stored without trailing zero */
+struct CacheTexture
+{
+    uint64_t type;
+    uint64_t width;
+    uint64_t height;
+    uint64_t nbChannels;
+    uint64_t depth;
+    CacheBuffer name;
+    CacheBuffer data;
+};
+
+/** Resampled transfer function */
+struct CacheTransferFunction
+{
+    float valuesRange[2];
+    CacheBuffer diffuseColors;
+    CacheBuffer emissionIntensities;
+};
+
+/**
+ * Timestamp index entry: number of primitives to consider for the model of a
+ * given timestamp
+ */
+struct CacheTimestampIndex
+{
+    uint64_t timestamp;
+    uint64_t count;
+};
+
+/**
+ * View on the data of a geometry buffer, either owned by the scene or mapped
+ * from a cache file
+ */
+struct GeometryBuffer
+{
+    const void* data;
+    uint64_t size;
+};
+typedef std::array< GeometryBuffer, CBT_COUNT > GeometryBuffers;
+
+/** @return the number of blocks of a chunk of size bytes */
+uint64_t getCacheBlockCount( uint64_t size );
+
+/** @return the size, once decompressed, of a block of a chunk of size bytes */
+uint64_t getCacheBlockSize( uint64_t size, uint64_t block );
+
+/** @return the CRC32 of the given bytes */
+uint32_t computeCacheChecksum( const void* data, uint64_t size );
+
+/**
+ * Compresses a block with the fastest available codec
+ * @param buffer Block to compress, of at most CACHE_BLOCK_SIZE bytes
+ * @param compressed Compressed bytes
+ * @return The compression that was applied, CC_NONE if no codec is available
+ *         or if compression does not reduce the size of the block
+ */
+CacheCompression compressCacheBlock( const GeometryBuffer& buffer,
+                                     std::vector< char >& compressed );
+
+/**
+ * Decompresses the stored bytes of a block
+ * @param block Description of the block
+ * @param src Stored bytes of the block
+ * @param dst Destination
+ * @param size Size of the block once decompressed
+ * @return True if the block could be decompressed
+ */
+bool decompressCacheBlock( const CacheBlock& block, const void* src,
+                           char* dst, uint64_t size );
+
+}
+#endif // OSPRAYSCENECACHE_H
@@ -46,6 +46,8 @@ void ExtendedCones::finalize( ospray::Model *model )
     offset_timestamp    = getParam1i("offset_timestamp",8*sizeof(float));
     offset_value        = getParam1i("offset_value",9*sizeof(float));
     offset_materialID   = getParam1i("offset_materialID",-1);
+    packed              = bool(getParam1i("packed",0)) &&
+                          bytesPerCone == 10*sizeof(float);
     data                = getParamData("extendedcones",nullptr);
 
     if (data.ptr == nullptr || bytesPerCone == 0)
@@ -67,7 +69,8 @@ void ExtendedCones::finalize( ospray::Model *model )
                 offset_upRadius,
                 offset_timestamp,
                 offset_value,
-                offset_materialID);
+                offset_materialID,
+                packed);
 }
 
 OSP_REGISTER_GEOMETRY( ExtendedCones, extendedcones );
@@ -45,6 +45,8 @@ struct ExtendedCones : public ospray::Geometry
     int64 offset_timestamp;
     int64 offset_value;
     int64 offset_materialID;
+    // Records have the memory layout of the Brayns primitives, offsets are ignored
+    bool packed;
 
     ospray::Ref< ospray::Data > data;
 
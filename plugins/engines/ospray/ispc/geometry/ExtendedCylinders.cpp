@@ -36,13 +36,15 @@ void ExtendedCylinders::finalize(ospray::Model *model)
 {
     radius            = getParam1f("radius",0.01f);
     materialID        = getParam1i("materialID",0);
-    bytesPerCylinder  = getParam1i("bytes_per_cylinder",9*sizeof(float));
+    bytesPerCylinder  = getParam1i("bytes_per_extended_cylinder",9*sizeof(float));
     offset_v0         = getParam1i("offset_v0",0);
     offset_v1         = getParam1i("offset_v1",3*sizeof(float));
     offset_radius     = getParam1i("offset_radius",6*sizeof(float));
     offset_timestamp  = getParam1i("offset_timestamp",7*sizeof(float));
     offset_value      = getParam1i("offset_value",8*sizeof(float));
     offset_materialID = getParam1i("offset_materialID",-1);
+    packed            = bool(getParam1i("packed",0)) &&
+                        bytesPerCylinder == 9*sizeof(float);
     data              = getParamData("extendedcylinders",nullptr);
 
     if (data.ptr == nullptr || bytesPerCylinder == 0)
@@ -62,7 +64,8 @@ void ExtendedCylinders::finalize(ospray::Model *model)
                 offset_radius,
                 offset_timestamp,
                 offset_value,
-                offset_materialID);
+                offset_materialID,
+                packed);
 }
 
 OSP_REGISTER_GEOMETRY( ExtendedCylinders, extendedcylinders );
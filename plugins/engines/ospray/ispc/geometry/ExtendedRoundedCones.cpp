@@ -0,0 +1,59 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// ospray
+#include "ExtendedRoundedCones.h"
+#include "ospray/SDK/common/Data.h"
+#include "ospray/SDK/common/Model.h"
+// ispc-generated files
+#include "ExtendedRoundedCones_ispc.h"
+
+namespace ospray
+{
+
+ExtendedRoundedCones::ExtendedRoundedCones()
+{
+    this->ispcEquivalent = ispc::ExtendedRoundedCones_create(this);
+}
+
+void ExtendedRoundedCones::finalize( ospray::Model *model )
+{
+    materialID          = getParam1i("materialID",0);
+    bytesPerRoundedCone = getParam1i("bytes_per_extended_rounded_cone",
+                                     10*sizeof(float));
+    data                = getParamData("extendedroundedcones",nullptr);
+
+    if (data.ptr == nullptr)
+        throw std::runtime_error( "#ospray:geometry/extendedroundedcones: " \
+                                  "no 'extendedroundedcones' data specified");
+    if (bytesPerRoundedCone != 10*sizeof(float))
+        throw std::runtime_error( "#ospray:geometry/extendedroundedcones: " \
+                                  "unsupported rounded cone layout");
+    numExtendedRoundedCones = data->numBytes / bytesPerRoundedCone;
+    ispc::ExtendedRoundedConesGeometry_set(
+                getIE(),
+                model->getIE(),
+                data->data,
+                numExtendedRoundedCones,
+                materialID);
+}
+
+OSP_REGISTER_GEOMETRY( ExtendedRoundedCones, extendedroundedcones );
+
+} // ::brayns
@@ -1,6 +1,5 @@
-/* Copyright (c) 2015-2016, EPFL/Blue Brain Project
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
  * All rights reserved. Do not distribute without permission.
- * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
  *
  * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
  *
@@ -18,40 +17,31 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#ifndef SPHERE_H
-#define SPHERE_H
+#pragma once
 
-#include "Primitive.h"
-
-#include <brayns/api.h>
 #include <brayns/common/types.h>
-#include <map>
+#include "ospray/SDK/geometry/Geometry.h"
 
-namespace brayns
+namespace ospray
 {
 
-class Sphere : public Primitive
+/**
+ * Rounded cones, i.e. convex hulls of two spheres. Records have the memory
+ * layout of brayns::RoundedCone.
+ */
+struct ExtendedRoundedCones : public ospray::Geometry
 {
-public:
-    BRAYNS_API Sphere(
-        size_t materialId,
-        const Vector3f& center,
-        float radius,
-        float timestamp,
-        float value);
-
-    BRAYNS_API const Vector3f& getCenter() const { return _center; }
-    BRAYNS_API float getRadius() const { return _radius; }
-    BRAYNS_API float getValue() const { return _value; }
-
-    BRAYNS_API virtual size_t serializeData(floats& serializedData);
-    BRAYNS_API static size_t getSerializationSize();
-
-private:
-    Vector3f _center;
-    float _radius;
-    float _value;
+    std::string toString() const final { return "ospray::RoundedCones"; }
+    void finalize(ospray::Model *model) final;
+
+    int32 materialID;
+
+    size_t numExtendedRoundedCones;
+    size_t bytesPerRoundedCone;
+
+    ospray::Ref< ospray::Data > data;
+
+    ExtendedRoundedCones();
 };
 
-}
-#endif // SPHERE_H
+} // ::brayns
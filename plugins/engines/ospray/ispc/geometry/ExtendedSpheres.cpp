@@ -45,6 +45,8 @@ void ExtendedSpheres::finalize(ospray::Model *model)
     offset_timestamp  = getParam1i("offset_timestamp",-1);
     offset_value      = getParam1i("offset_value",-1);
     offset_materialID = getParam1i("offset_materialID",-1);
+    packed            = bool(getParam1i("packed",0)) &&
+                        bytesPerExtendedSphere == 6*sizeof(float);
     data              = getParamData("extendedspheres",nullptr);
     materialList      = getParamData("materialList",nullptr);
 
@@ -53,16 +55,13 @@ void ExtendedSpheres::finalize(ospray::Model *model)
                                  "no 'extendedspheres' data specified");
     numExtendedSpheres = data->numBytes / bytesPerExtendedSphere;
 
-    if (numExtendedSpheres >= (1ULL << 30))
+    // Offsets of the spheres are computed with 32 bit varying integers
+    if (numExtendedSpheres * bytesPerExtendedSphere >= (1ULL << 31))
     {
         throw std::runtime_error("#brayns::ExtendedSpheres: too many extended "\
-                                 "spheres in this sphere geometry. Consider "\
-                                 "splitting this geometry in multiple "\
-                                 "geometries with fewer extended spheres (you "\
-                                 "can still put all those geometries into a "\
-                                 "single model, but you can't put that many "\
-                                 "extended spheres into a single geometry "\
-                                 "without causing address overflows)");
+                                 "spheres in this sphere geometry. Split "\
+                                 "them in several geometries of the same "\
+                                 "model instead.");
     }
 
     void *ispcMaterialList = nullptr;
@@ -84,7 +83,8 @@ void ExtendedSpheres::finalize(ospray::Model *model)
                                       radius, materialID,
                                       offset_center,offset_radius,
                                       offset_timestamp, offset_value,
-                                      offset_materialID);
+                                      offset_materialID,
+                                      packed);
 }
 
 OSP_REGISTER_GEOMETRY( ExtendedSpheres, extendedspheres );
@@ -39,9 +39,15 @@ void SimulationRenderer::commit()
 
     _volumeData = getParamData( "volumeData" );
     _volumeDimensions = getParam3i( "volumeDimensions", ospray::vec3i( 0 ));
+    _volumeBrickSize = getParam1i( "volumeBrickSize", 0 );
+    _volumeMacroCells = getParamData( "volumeMacroCells" );
+    _volumeMacroCellSize = getParam1i( "volumeMacroCellSize", 0 );
+    _volumeNbMacroCells = getParam3i( "volumeNbMacroCells", ospray::vec3i( 0 ));
     _volumeElementSpacing = getParam3f( "volumeElementSpacing", ospray::vec3f( 1.f ));
     _volumeOffset = getParam3f( "volumeOffset", ospray::vec3f( 0.f ));
     _volumeEpsilon = getParam1f( "volumeEpsilon", 1.f );
+    _volumeOpacityTable = getParamData( "volumeOpacityTable" );
+    _volumeGradientShading = bool( getParam1i( "volumeGradientShading", 0 ));
     _simulationData = getParamData( "simulationData" );
     _transferFunctionDiffuseData = getParamData( "transferFunctionDiffuseData" );
     _transferFunctionEmissionData = getParamData( "transferFunctionEmissionData" );
@@ -65,9 +71,15 @@ void SimulationRenderer::commit()
                 _materialPtr, _materialArray.size(),
                 _volumeData ? ( uint8* )_volumeData->data : NULL,
                 ( ispc::vec3i& )_volumeDimensions,
+                _volumeBrickSize,
+                _volumeMacroCells ? ( uint8* )_volumeMacroCells->data : NULL,
+                _volumeMacroCells ? _volumeMacroCellSize : 0,
+                ( ispc::vec3i& )_volumeNbMacroCells,
                 ( ispc::vec3f& )_volumeElementSpacing,
                 ( ispc::vec3f& )_volumeOffset,
                 _volumeEpsilon,
+                _volumeOpacityTable ? ( float* )_volumeOpacityTable->data : NULL,
+                _volumeGradientShading,
                 _simulationData ? ( float* )_simulationData->data : NULL,
                 _transferFunctionDiffuseData ?
                     ( ispc::vec4f* )_transferFunctionDiffuseData->data : NULL,
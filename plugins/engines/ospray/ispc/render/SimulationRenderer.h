@@ -48,6 +48,8 @@ public:
 private:
 
     ospray::Ref< ospray::Data > _volumeData;
+    ospray::Ref< ospray::Data > _volumeMacroCells;
+    ospray::Ref< ospray::Data > _volumeOpacityTable;
     ospray::Ref< ospray::Data > _simulationData;
     ospray::Ref< ospray::Data > _transferFunctionDiffuseData;
     ospray::Ref< ospray::Data > _transferFunctionEmissionData;
@@ -56,9 +58,13 @@ private:
     float _transferFunctionRange;
     float _threshold;
     ospray::vec3i _volumeDimensions;
+    ospray::int32 _volumeBrickSize;
+    ospray::int32 _volumeMacroCellSize;
+    ospray::vec3i _volumeNbMacroCells;
     ospray::vec3f _volumeElementSpacing;
     ospray::vec3f _volumeOffset;
     float _volumeEpsilon;
+    bool _volumeGradientShading;
 };
 
 } // ::brayns
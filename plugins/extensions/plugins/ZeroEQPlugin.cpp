@@ -38,6 +38,21 @@
 namespace brayns
 {
 
+namespace
+{
+/** @return the parts of the scene affected by a data source parameter */
+uint32_t getSceneChange( const std::string& parameter )
+{
+    if( parameter == "radius-multiplier" || parameter == "radius-correction" )
+        return SC_RADIUS;
+    if( parameter == "color-scheme" )
+        return SC_COLOR_SCHEME;
+    if( parameter == "transfer-function-file" )
+        return SC_TRANSFER_FUNCTION;
+    return SC_DATA_SOURCES;
+}
+}
+
 ZeroEQPlugin::ZeroEQPlugin(
     Engine& engine,
     ParametersManager& parametersManager )
@@ -45,6 +60,8 @@ ZeroEQPlugin::ZeroEQPlugin(
     , _parametersManager( parametersManager )
     , _compressor( tjInitCompress() )
     , _processingImageJpeg( false )
+    , _dataSourceUpdatePending( false )
+    , _spikesReceived( false )
 {
     _setupHTTPServer();
     _setupRequests();
@@ -75,7 +92,22 @@ void ZeroEQPlugin::run()
     if( _requestFrame( ))
         _publisher.publish( _remoteFrame );
 
+    if( _requestProgress( ))
+        _publisher.publish( _remoteProgress );
+
+    if( _dataSourceUpdatePending && !_engine.getScene().isLoading( ))
+    {
+        _dataSourceUpdatePending = false;
+        _dataSourceUpdated();
+    }
+
     while( _subscriber.receive( 1 )) {}
+
+    if( _spikesReceived )
+    {
+        _spikesReceived = false;
+        _engine.getFrameBuffer().clear();
+    }
 }
 
 bool ZeroEQPlugin::operator ! () const
@@ -203,6 +235,10 @@ void ZeroEQPlugin::_setupHTTPServer()
     _httpServer->handleGET( "brayns/v1/volume-histogram", _remoteVolumeHistogram );
     _remoteVolumeHistogram.registerSerializeCallback(
         std::bind( &ZeroEQPlugin::_requestVolumeHistogram, this ));
+
+    _httpServer->handleGET( _remoteProgress );
+    _remoteProgress.registerSerializeCallback(
+        std::bind( &ZeroEQPlugin::_requestProgress, this ));
 }
 
 void ZeroEQPlugin::_setupRequests()
@@ -235,6 +271,7 @@ void ZeroEQPlugin::_setupSubscriber()
     _subscriber.subscribe( _remoteLookupTable1D );
     _subscriber.subscribe( _clipPlanes );
     _subscriber.subscribe( _remoteFrame );
+    _subscriber.subscribe( _remoteSpikes );
 
     _remoteLookupTable1D.registerDeserializedCallback(
         std::bind( &ZeroEQPlugin::_LookupTable1DUpdated, this ));
@@ -328,27 +365,18 @@ void ZeroEQPlugin::_sceneUpdated( )
 
 void ZeroEQPlugin::_spikesUpdated( )
 {
-#if 0
-    AbstractSimulationHandlerPtr simulationHandler =
-        _engine.getScene().getSimulationHandler();
-
-    SpikeSimulationHandler* spikeSimulationHandler =
-        dynamic_cast< SpikeSimulationHandler * >(simulationHandler.get());
-
-    if( spikeSimulationHandler )
-    {
-        uint64_t ts = _remoteSpikes.getTimestamp();
-        float* data = (float*)spikeSimulationHandler->getFrameData( ts );
-        for( const auto& gid: _remoteSpikes.getGidsVector() )
-            data[gid] = ts;
+    SpikeSimulationHandlerPtr simulationHandler =
+        std::dynamic_pointer_cast< SpikeSimulationHandler >(
+            _engine.getScene().getSimulationHandler( ));
+    if( !simulationHandler || !simulationHandler->isLive( ))
+        return;
 
-        _engine.getFrameBuffer().clear();
-        _engine.getScene().commitSimulationData();
-    }
-#endif
+    // Spikes are written to the simulation frame when the engine commits the simulation data,
+    // once per rendered frame whatever the number of messages received in between
+    simulationHandler->addSpikes( _remoteSpikes.getTimestamp(), _remoteSpikes.getGidsVector( ));
+    _spikesReceived = true;
 }
 
-
 bool ZeroEQPlugin::_requestTransferFunction1D()
 {
     auto& scene = _engine.getScene();
@@ -608,25 +636,7 @@ bool ZeroEQPlugin::_requestFrameBuffers()
 
 bool ZeroEQPlugin::_requestSpikes()
 {
-#if 0
-    AbstractSimulationHandlerPtr simulationHandler = _engine.getScene().getSimulationHandler();
-
-    SpikeSimulationHandler* spikeSimulationHandler =
-        dynamic_cast< SpikeSimulationHandler * >( simulationHandler.get() );
-
-    std::vector< uint64_t > spikeGids;
-    uint64_t ts = 0.f;
-
-    _remoteSpikes.setTimestamp( ts );
-    if( spikeSimulationHandler )
-    {
-        uint64_t frameSize = spikeSimulationHandler->getFrameSize();
-        uint64_t* gids = (uint64_t*)spikeSimulationHandler->getFrameData( ts );
-        spikeGids.reserve( frameSize );
-        spikeGids.assign( gids, gids + frameSize );
-    }
-    _remoteSpikes.setGids( spikeGids );
-#endif
+    // Spikes are only received, the last message received is returned as it is
     return true;
 }
 
@@ -692,66 +702,71 @@ void ZeroEQPlugin::_initializeDataSource()
     _remoteDataSource.setVolumeOffset( Vector3f(volumeParameters.getOffset( )));
     _remoteDataSource.setEnvironmentMap( sceneParameters.getEnvironmentMap( ));
     _remoteDataSource.setMolecularSystemConfig( geometryParameters.getMolecularSystemConfig( ));
+
+    _dataSourceParameters = _getDataSourceParameters();
+    _dataSourceParameters["splash-scene-folder"] =
+        geometryParameters.getSplashSceneFolder();
 }
 
-void ZeroEQPlugin::_dataSourceUpdated()
+ZeroEQPlugin::DataSourceParameters ZeroEQPlugin::_getDataSourceParameters()
 {
     auto& geometryParameters = _parametersManager.getGeometryParameters();
+    DataSourceParameters parameters;
 
-    _parametersManager.set(
-        "splash-scene-folder", ""); // Make sure the splash scene is removed
-    _parametersManager.set(
+    parameters.emplace(
+        "splash-scene-folder", "" ); // Make sure the splash scene is removed
+    parameters.emplace(
         "transfer-function-file", _remoteDataSource.getTransferFunctionFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "morphology-folder", _remoteDataSource.getMorphologyFolderString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "nest-circuit", _remoteDataSource.getNestCircuitString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "nest-report", _remoteDataSource.getNestReportString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "pdb-file", _remoteDataSource.getPdbFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "pdb-folder", _remoteDataSource.getPdbFolderString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "xyzb-file", _remoteDataSource.getXyzbFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "mesh-folder", _remoteDataSource.getMeshFolderString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "circuit-config", _remoteDataSource.getCircuitConfigString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "load-cache-file", _remoteDataSource.getLoadCacheFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "save-cache-file", _remoteDataSource.getSaveCacheFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "radius-multiplier", std::to_string(_remoteDataSource.getRadiusMultiplier( )));
-    _parametersManager.set(
+    parameters.emplace(
         "radius-correction", std::to_string(_remoteDataSource.getRadiusCorrection( )));
-    _parametersManager.set(
+    parameters.emplace(
         "color-scheme", geometryParameters.getColorSchemeAsString(
         static_cast< ColorScheme >( _remoteDataSource.getColorScheme( ))));
-    _parametersManager.set(
+    parameters.emplace(
         "scene-environment", geometryParameters.getSceneEnvironmentAsString(
         static_cast< SceneEnvironment >( _remoteDataSource.getSceneEnvironment( ))));
-    _parametersManager.set(
+    parameters.emplace(
         "geometry-quality", geometryParameters.getGeometryQualityAsString(
         static_cast< GeometryQuality >( _remoteDataSource.getGeometryQuality( ))));
-    _parametersManager.set(
+    parameters.emplace(
         "target", _remoteDataSource.getTargetString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "report", _remoteDataSource.getReportString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "non-simulated-cells", std::to_string(_remoteDataSource.getNonSimulatedCells( )));
-    _parametersManager.set(
+    parameters.emplace(
         "start-simulation-time", std::to_string(_remoteDataSource.getStartSimulationTime( )));
-    _parametersManager.set(
+    parameters.emplace(
         "end-simulation-time", std::to_string(_remoteDataSource.getEndSimulationTime( )));
-    _parametersManager.set(
+    parameters.emplace(
         "simulation-values-range",
         std::to_string(_remoteDataSource.getSimulationValuesRange()[0]) + " " +
         std::to_string(_remoteDataSource.getSimulationValuesRange()[1]) );
-    _parametersManager.set(
+    parameters.emplace(
         "simulation-cache-file", _remoteDataSource.getSimulationCacheFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "nest-cache-file", _remoteDataSource.getNestCacheFileString( ));
 
     uint morphologySectionTypes = MST_UNDEFINED;
@@ -772,45 +787,72 @@ void ZeroEQPlugin::_dataSourceUpdated()
             morphologySectionTypes |= MST_ALL;
         }
     }
-    _parametersManager.set( "morphology-section-types", std::to_string( morphologySectionTypes ));
+    parameters.emplace( "morphology-section-types", std::to_string( morphologySectionTypes ));
 
     const auto remoteMorphologyLayout = _remoteDataSource.getMorphologyLayout();
     std::string layoutAsString;
     layoutAsString += std::to_string( remoteMorphologyLayout.getNbColumns( ));
     layoutAsString += " " + std::to_string( remoteMorphologyLayout.getVerticalSpacing( ));
     layoutAsString += " " + std::to_string( remoteMorphologyLayout.getHorizontalSpacing( ));
-    BRAYNS_ERROR << "morphology-layout: " << layoutAsString << std::endl;
-    _parametersManager.set( "morphology-layout", layoutAsString );
+    parameters.emplace( "morphology-layout", layoutAsString );
 
-    _parametersManager.set(
+    parameters.emplace(
         "generate-multiple-models", (_remoteDataSource.getGenerateMultipleModels( ) ? "1" : "0"));
-    _parametersManager.set(
+    parameters.emplace(
         "volume-folder", _remoteDataSource.getVolumeFolderString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "volume-file", _remoteDataSource.getVolumeFileString( ));
-    _parametersManager.set(
+    parameters.emplace(
         "volume-dimensions",
         std::to_string(_remoteDataSource.getVolumeDimensions()[0]) + " " +
         std::to_string(_remoteDataSource.getVolumeDimensions()[1]) + " " +
         std::to_string(_remoteDataSource.getVolumeDimensions()[2]) );
-    _parametersManager.set(
+    parameters.emplace(
         "volume-element-spacing",
         std::to_string(_remoteDataSource.getVolumeElementSpacing()[0]) + " " +
         std::to_string(_remoteDataSource.getVolumeElementSpacing()[1]) + " " +
         std::to_string(_remoteDataSource.getVolumeElementSpacing()[2]) );
-    _parametersManager.set(
+    parameters.emplace(
         "volume-offset",
         std::to_string(_remoteDataSource.getVolumeOffset()[0]) + " " +
         std::to_string(_remoteDataSource.getVolumeOffset()[1]) + " " +
         std::to_string(_remoteDataSource.getVolumeOffset()[2]) );
-    _parametersManager.set(
+    parameters.emplace(
         "environment-map", _remoteDataSource.getEnvironmentMapString( ));
 
-    _parametersManager.set(
+    parameters.emplace(
         "molecular-system-config", _remoteDataSource.getMolecularSystemConfigString( ));
 
-    _resetSceneUpdated();
-    _resetCameraUpdated();
+    return parameters;
+}
+
+void ZeroEQPlugin::_dataSourceUpdated()
+{
+    // Data sources are read by the loaders, they are applied once the
+    // background loading is done
+    if( _engine.getScene().isLoading( ))
+    {
+        _dataSourceUpdatePending = true;
+        return;
+    }
+
+    // Only parameters that were actually modified are applied, and the engine
+    // is told which parts of the scene they affect
+    uint32_t changes = SC_NONE;
+    for( const auto& parameter: _getDataSourceParameters( ))
+    {
+        std::string& value = _dataSourceParameters[parameter.first];
+        if( value == parameter.second )
+            continue;
+        value = parameter.second;
+        _parametersManager.set( parameter.first, parameter.second );
+        changes |= getSceneChange( parameter.first );
+    }
+
+    if( changes != SC_NONE )
+        _engine.makeDirty( changes );
+    if( changes & SC_DATA_SOURCES )
+        _resetCameraUpdated();
 
     _engine.getFrameBuffer().clear();
     _engine.getScene().commitSimulationData();
@@ -1006,6 +1048,21 @@ bool ZeroEQPlugin::_requestVolumeHistogram()
     return true;
 }
 
+bool ZeroEQPlugin::_requestProgress()
+{
+    std::string operation;
+    float amount;
+    _engine.getScene().getProgress( operation, amount );
+    if( operation == _remoteProgress.getOperationString() &&
+        amount == _remoteProgress.getAmount( ))
+    {
+        return false;
+    }
+    _remoteProgress.setOperation( operation );
+    _remoteProgress.setAmount( amount );
+    return true;
+}
+
 void ZeroEQPlugin::_clipPlanesUpdated()
 {
     const auto& bounds = _engine.getScene().getWorldBounds();
@@ -39,6 +39,7 @@
 #include <zerobuf/render/colormap.h>
 #include <zerobuf/render/frameBuffers.h>
 #include <zerobuf/render/parameters.h>
+#include <zerobuf/render/progress.h>
 #include <zerobuf/render/reset.h>
 #include <zerobuf/render/scene.h>
 #include <zerobuf/render/spikes.h>
@@ -114,7 +115,8 @@ private:
     void _sceneUpdated();
 
     /**
-     * @brief This method is called when spikes are updated by a ZeroEQ event
+     * @brief This method is called when spikes are updated by a ZeroEQ event. Spikes are
+     *        queued in the simulation handler if it waits for spikes from a running simulation.
      */
     void _spikesUpdated();
 
@@ -176,10 +178,20 @@ private:
     void _initializeDataSource();
 
     /**
-     * @brief This method is called when data sources are updated by a ZeroEQ event
+     * @brief This method is called when data sources are updated by a ZeroEQ event.
+     *        Only modified parameters are applied, and the engine is made dirty
+     *        for the parts of the scene that they affect.
      */
     void _dataSourceUpdated();
 
+    typedef std::map< std::string, std::string > DataSourceParameters;
+
+    /**
+     * @brief Converts the data sources to application parameters
+     * @return Values of the parameters, indexed by name
+     */
+    DataSourceParameters _getDataSourceParameters();
+
     /**
      * @brief This method initializes data sources according to default application parameters
      */
@@ -226,6 +238,13 @@ private:
      */
     bool _requestVolumeHistogram();
 
+    /**
+     * @brief This method is called when the progress of the background loading is
+     *        requested by a ZeroEQ event
+     * @return True if the progress changed since the last request, false otherwise
+     */
+    bool _requestProgress();
+
     /**
      * @brief This method is called when the clip planes are updated by a ZeroEQ event
      */
@@ -284,11 +303,15 @@ private:
     ::lexis::render::Histogram _remoteVolumeHistogram;
 
     ::brayns::v1::DataSource _remoteDataSource;
+    DataSourceParameters _dataSourceParameters;
+    bool _dataSourceUpdatePending;
     ::brayns::v1::Settings _remoteSettings;
     ::brayns::v1::Spikes _remoteSpikes;
+    bool _spikesReceived;
     ::brayns::v1::Attribute _remoteAttribute;
     ::brayns::v1::Colormap _remoteColormap;
     ::brayns::v1::FrameBuffers _remoteFrameBuffers;
+    ::brayns::v1::Progress _remoteProgress;
     ::brayns::v1::Material _remoteMaterial;
     ::brayns::v1::ResetCamera _remoteResetCamera;
     ::brayns::v1::ResetScene _remoteResetScene;
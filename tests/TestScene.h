@@ -0,0 +1,79 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TESTSCENE_H
+#define TESTSCENE_H
+
+#include <brayns/common/scene/Scene.h>
+#include <brayns/parameters/ParametersManager.h>
+
+#include <boost/filesystem.hpp>
+
+namespace brayns
+{
+
+/**
+ * Scene without rendering engine, for the tests of the loaders and of the
+ * scene itself
+ */
+class TestScene : public Scene
+{
+public:
+    explicit TestScene( ParametersManager& parametersManager )
+        : Scene( Renderers(), parametersManager )
+    {
+    }
+
+    void commit() final {}
+    void commitMaterials( const bool ) final {}
+    void commitLights() final {}
+    void buildGeometry() final {}
+    void resetGeometry() final {}
+    void commitSimulationData() final {}
+    void commitVolumeData() final {}
+    void commitTransferFunctionData() final {}
+    void saveSceneToCacheFile() final {}
+};
+
+/** Unique file name in the temporary folder, removed on destruction */
+class TemporaryFile
+{
+public:
+    TemporaryFile()
+        : _path( boost::filesystem::temp_directory_path() /
+                 boost::filesystem::unique_path( ))
+    {
+    }
+
+    ~TemporaryFile()
+    {
+        boost::system::error_code error;
+        boost::filesystem::remove_all( _path, error );
+    }
+
+    std::string string() const { return _path.string(); }
+
+private:
+    const boost::filesystem::path _path;
+};
+
+}
+
+#endif // TESTSCENE_H
@@ -28,11 +28,11 @@
 #define BOOST_TEST_MODULE braynsTestData
 #include <boost/test/unit_test.hpp>
 
+#include <boost/filesystem.hpp>
 #include <lunchbox/memoryMap.h>
 
 //#define GENERATE_TESTDATA
 
-#ifdef GENERATE_TESTDATA
 void writeTestData( const std::string& filename, brayns::FrameBuffer& fb )
 {
     fb.map();
@@ -42,10 +42,17 @@ void writeTestData( const std::string& filename, brayns::FrameBuffer& fb )
     memcpy( file.getAddress(), fb.getColorBuffer(), bytes );
     fb.unmap();
 }
-#endif
 
 void compareTestData( const std::string& filename, brayns::FrameBuffer& fb )
 {
+    // A missing reference is generated from the current rendering and fails
+    // the test, until it is checked and committed
+    if( !boost::filesystem::exists( BRAYNS_TESTDATA + filename ))
+    {
+        writeTestData( filename, fb );
+        BOOST_ERROR( "Generated missing reference " + filename );
+        return;
+    }
 
     const lunchbox::MemoryMap file( BRAYNS_TESTDATA + filename);
     const auto& size = fb.getSize();
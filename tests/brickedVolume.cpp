@@ -0,0 +1,157 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <brayns/common/volume/BrickedVolume.h>
+
+#define BOOST_TEST_MODULE brickedVolume
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+namespace
+{
+const brayns::Vector3ui DIMENSIONS( 5, 3, 2 );
+const size_t BRICK_SIZE = 2;
+
+/** Voxel of a volume stored linearly, clamped to the volume */
+uint8_t getVoxel( const std::vector< uint8_t >& voxels,
+                  const brayns::Vector3ui& dimensions,
+                  size_t x, size_t y, size_t z )
+{
+    x = std::min( x, size_t( dimensions.x() - 1 ));
+    y = std::min( y, size_t( dimensions.y() - 1 ));
+    z = std::min( z, size_t( dimensions.z() - 1 ));
+    return voxels[( z * dimensions.y() + y ) * dimensions.x() + x ];
+}
+
+/** Voxel of a bricked volume: bricks along x, y then z, and so are their voxels */
+uint8_t getBrickedVoxel( const uint8_t* bricks,
+                         const brayns::Vector3ui& dimensions,
+                         const size_t x, const size_t y, const size_t z )
+{
+    const size_t nbBricksX = ( dimensions.x() + BRICK_SIZE - 1 ) / BRICK_SIZE;
+    const size_t nbBricksY = ( dimensions.y() + BRICK_SIZE - 1 ) / BRICK_SIZE;
+    const size_t brick = ( z / BRICK_SIZE * nbBricksY + y / BRICK_SIZE ) *
+                         nbBricksX + x / BRICK_SIZE;
+    const size_t voxel = (( z % BRICK_SIZE ) * BRICK_SIZE + y % BRICK_SIZE ) *
+                         BRICK_SIZE + x % BRICK_SIZE;
+    return bricks[brick * BRICK_SIZE * BRICK_SIZE * BRICK_SIZE + voxel];
+}
+
+void writeVolume( const std::string& filename, std::vector< uint8_t >& voxels )
+{
+    voxels.resize( DIMENSIONS.x() * DIMENSIONS.y() * DIMENSIONS.z( ));
+    for( size_t i = 0; i < voxels.size(); ++i )
+        voxels[i] = uint8_t( 7 * i );
+    std::ofstream file( filename, std::ios::out | std::ios::binary );
+    file.write( reinterpret_cast< const char* >( voxels.data( )), voxels.size( ));
+}
+
+/** Checks every level against the volume, downsampled by averaging 2x2x2 voxels */
+void checkLevels( const brayns::BrickedVolume& volume, std::vector< uint8_t > voxels )
+{
+    // Levels are halved until the volume fits in a single brick
+    BOOST_REQUIRE_EQUAL( volume.getNbLevels(), 3 );
+    BOOST_CHECK_EQUAL( volume.getBrickSize(), BRICK_SIZE );
+    BOOST_CHECK_EQUAL( volume.getDimensions( 0 ), DIMENSIONS );
+    BOOST_CHECK_EQUAL( volume.getDimensions( 1 ), brayns::Vector3ui( 3, 2, 1 ));
+    BOOST_CHECK_EQUAL( volume.getDimensions( 2 ), brayns::Vector3ui( 2, 1, 1 ));
+    BOOST_CHECK_EQUAL( volume.getSize( 0 ), 3 * 2 * 1 * 8 );
+    BOOST_CHECK_EQUAL( volume.getSize( 1 ), 2 * 1 * 1 * 8 );
+    BOOST_CHECK_EQUAL( volume.getSize( 2 ), 1 * 1 * 1 * 8 );
+
+    for( size_t level = 0; level < volume.getNbLevels(); ++level )
+    {
+        const brayns::Vector3ui dimensions = volume.getDimensions( level );
+        if( level > 0 )
+        {
+            const brayns::Vector3ui previous = volume.getDimensions( level - 1 );
+            std::vector< uint8_t > half( dimensions.x() * dimensions.y() * dimensions.z( ));
+            for( size_t z = 0; z < dimensions.z(); ++z )
+                for( size_t y = 0; y < dimensions.y(); ++y )
+                    for( size_t x = 0; x < dimensions.x(); ++x )
+                    {
+                        size_t sum = 0;
+                        for( size_t i = 0; i < 8; ++i )
+                            sum += getVoxel( voxels, previous, 2 * x + ( i & 1 ),
+                                2 * y + (( i >> 1 ) & 1 ), 2 * z + (( i >> 2 ) & 1 ));
+                        half[( z * dimensions.y() + y ) * dimensions.x() + x ] =
+                            ( sum + 4 ) / 8;
+                    }
+            voxels.swap( half );
+        }
+
+        // Voxels of the bricks that exceed the volume repeat its border
+        const uint8_t* bricks = volume.getData( level );
+        BOOST_REQUIRE( bricks );
+        const size_t paddedX = ( dimensions.x() + BRICK_SIZE - 1 ) / BRICK_SIZE * BRICK_SIZE;
+        const size_t paddedY = ( dimensions.y() + BRICK_SIZE - 1 ) / BRICK_SIZE * BRICK_SIZE;
+        const size_t paddedZ = ( dimensions.z() + BRICK_SIZE - 1 ) / BRICK_SIZE * BRICK_SIZE;
+        for( size_t z = 0; z < paddedZ; ++z )
+            for( size_t y = 0; y < paddedY; ++y )
+                for( size_t x = 0; x < paddedX; ++x )
+                    BOOST_CHECK_EQUAL( int( getBrickedVoxel( bricks, dimensions, x, y, z )),
+                                       int( getVoxel( voxels, dimensions, x, y, z )));
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( brick_volume )
+{
+    const brayns::TemporaryFile filename;
+    std::vector< uint8_t > voxels;
+    writeVolume( filename.string(), voxels );
+
+    const brayns::BrickedVolume volume( filename.string(), DIMENSIONS, BRICK_SIZE, "" );
+    BOOST_REQUIRE( volume.isValid( ));
+    checkLevels( volume, voxels );
+}
+
+BOOST_AUTO_TEST_CASE( map_bricked_volume_from_cache )
+{
+    const brayns::TemporaryFile filename;
+    const brayns::TemporaryFile cacheFolder;
+    std::vector< uint8_t > voxels;
+    writeVolume( filename.string(), voxels );
+
+    // The first volume is converted and written to the cache, the second one
+    // is mapped from it
+    for( size_t i = 0; i < 2; ++i )
+    {
+        const brayns::BrickedVolume volume( filename.string(), DIMENSIONS, BRICK_SIZE,
+                                            cacheFolder.string( ));
+        BOOST_REQUIRE( volume.isValid( ));
+        checkLevels( volume, voxels );
+    }
+    BOOST_CHECK( !boost::filesystem::is_empty( cacheFolder.string( )));
+}
+
+BOOST_AUTO_TEST_CASE( reject_truncated_volume )
+{
+    const brayns::TemporaryFile filename;
+    std::vector< uint8_t > voxels;
+    writeVolume( filename.string(), voxels );
+
+    const brayns::BrickedVolume volume( filename.string(), brayns::Vector3ui( 10, 6, 4 ),
+                                        BRICK_SIZE, "" );
+    BOOST_CHECK( !volume.isValid( ));
+}
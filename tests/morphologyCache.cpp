@@ -0,0 +1,141 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <brayns/io/MorphologyCache.h>
+
+#define BOOST_TEST_MODULE morphologyCache
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+const std::string MORPHOLOGY = "/path/to/morphology.h5";
+
+brayns::CachedMorphologyPtr createMorphology()
+{
+    std::shared_ptr< brayns::CachedMorphology > morphology(
+        new brayns::CachedMorphology );
+    morphology->somaCentroid = brayns::Vector3f( 1.f, 2.f, 3.f );
+    morphology->somaMeanRadius = 4.5f;
+    morphology->somaPoints = { brayns::Vector3f( 0.f, 1.f, 2.f ),
+                               brayns::Vector3f( 3.f, 4.f, 5.f ) };
+
+    brayns::MorphologySection axon;
+    axon.type = 2;
+    axon.distanceToSoma = 6.f;
+    axon.samples = { brayns::Vector4f( 1.f, 2.f, 3.f, 0.5f ),
+                     brayns::Vector4f( 4.f, 5.f, 6.f, 0.25f ) };
+    axon.sampleDistancesToSoma = { 6.f, 11.f };
+
+    brayns::MorphologySection dendrite;
+    dendrite.type = 3;
+    dendrite.distanceToSoma = 0.f;
+    morphology->sections = { axon, dendrite };
+    return morphology;
+}
+
+void checkEqual( const brayns::CachedMorphology& a, const brayns::CachedMorphology& b )
+{
+    BOOST_CHECK_EQUAL( a.somaCentroid, b.somaCentroid );
+    BOOST_CHECK_EQUAL( a.somaMeanRadius, b.somaMeanRadius );
+    BOOST_CHECK_EQUAL_COLLECTIONS( a.somaPoints.begin(), a.somaPoints.end(),
+                                   b.somaPoints.begin(), b.somaPoints.end( ));
+    BOOST_REQUIRE_EQUAL( a.sections.size(), b.sections.size( ));
+    for( size_t i = 0; i < a.sections.size(); ++i )
+    {
+        const brayns::MorphologySection& sa = a.sections[i];
+        const brayns::MorphologySection& sb = b.sections[i];
+        BOOST_CHECK_EQUAL( sa.type, sb.type );
+        BOOST_CHECK_EQUAL( sa.distanceToSoma, sb.distanceToSoma );
+        BOOST_CHECK_EQUAL_COLLECTIONS( sa.samples.begin(), sa.samples.end(),
+                                       sb.samples.begin(), sb.samples.end( ));
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            sa.sampleDistancesToSoma.begin(), sa.sampleDistancesToSoma.end(),
+            sb.sampleDistancesToSoma.begin(), sb.sampleDistancesToSoma.end( ));
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( load_morphology_once )
+{
+    brayns::MorphologyCache cache( "" );
+    std::atomic< size_t > nbLoads( 0 );
+    const brayns::MorphologyCache::LoadFunc load = [&nbLoads]()
+    {
+        ++nbLoads;
+        return createMorphology();
+    };
+
+    // Threads requesting the same morphology wait for the first one to load it
+    std::vector< brayns::CachedMorphologyPtr > morphologies( 8 );
+    std::vector< std::thread > threads;
+    for( size_t i = 0; i < morphologies.size(); ++i )
+        threads.push_back( std::thread( [&cache, &load, &morphologies, i]()
+            { morphologies[i] = cache.get( MORPHOLOGY, load ); }));
+    for( auto& thread: threads )
+        thread.join();
+
+    BOOST_CHECK_EQUAL( nbLoads.load(), 1 );
+    for( const auto& morphology: morphologies )
+        BOOST_CHECK_EQUAL( morphology, morphologies[0] );
+
+    cache.get( MORPHOLOGY + ".other", load );
+    BOOST_CHECK_EQUAL( nbLoads.load(), 2 );
+}
+
+BOOST_AUTO_TEST_CASE( persist_morphology )
+{
+    const brayns::TemporaryFile folder;
+    const brayns::CachedMorphologyPtr reference = createMorphology();
+    {
+        brayns::MorphologyCache cache( folder.string( ));
+        cache.get( MORPHOLOGY, [&reference]() { return reference; } );
+    }
+    BOOST_CHECK( !boost::filesystem::is_empty( folder.string( )));
+
+    // The next runs read the morphology from the cache folder
+    brayns::MorphologyCache cache( folder.string( ));
+    const brayns::CachedMorphologyPtr morphology = cache.get( MORPHOLOGY, []()
+    {
+        BOOST_ERROR( "Persisted morphology loaded again" );
+        return createMorphology();
+    });
+    BOOST_REQUIRE( morphology );
+    BOOST_CHECK_NE( morphology, reference );
+    checkEqual( *morphology, *reference );
+}
+
+BOOST_AUTO_TEST_CASE( report_load_failure )
+{
+    brayns::MorphologyCache cache( "" );
+    const brayns::MorphologyCache::LoadFunc load = []() -> brayns::CachedMorphologyPtr
+    {
+        throw std::runtime_error( "Failed to load morphology" );
+    };
+    BOOST_CHECK_THROW( cache.get( MORPHOLOGY, load ), std::runtime_error );
+
+    // The failure is kept, later requests get the same error
+    BOOST_CHECK_THROW( cache.get( MORPHOLOGY, load ), std::runtime_error );
+}
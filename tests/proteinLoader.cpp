@@ -0,0 +1,151 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <tests/paths.h>
+#include <brayns/io/ProteinLoader.h>
+
+#define BOOST_TEST_MODULE proteinLoader
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+namespace
+{
+const size_t NB_MATERIALS = 10;
+
+// Carbon atoms only, so that all of them share the same material
+const char* const PDB_CONTENT =
+"HEADER    TEST\n"
+"ATOM      1  C5'  DC A   1      18.935  34.195  25.617  1.00 64.35           C  \n"
+"HETATM    2  O   HOH A   2       1.000   2.000   3.000  1.00 10.00           O  \n"
+"ATOM      3  C4'  DC A   1     -10.000   0.500 100.000  1.00 44.69           C  \n"
+"END\n";
+
+size_t countSpheres( const brayns::PrimitivesMap& primitives )
+{
+    size_t nbSpheres = 0;
+    for( const auto& material: primitives )
+        nbSpheres += material.second.getSpheres().size();
+    return nbSpheres;
+}
+}
+
+BOOST_AUTO_TEST_CASE( parse_pdb_file )
+{
+    const brayns::TemporaryFile filename;
+    {
+        std::ofstream file( filename.string( ));
+        file << PDB_CONTENT;
+    }
+
+    brayns::GeometryParameters geometryParameters;
+    brayns::ProteinLoader loader( geometryParameters );
+    brayns::PrimitivesMap atoms;
+    brayns::Boxf bounds;
+    BOOST_REQUIRE( loader.importPDBFile( filename.string(), 0, NB_MATERIALS,
+                                         atoms, bounds ));
+
+    // HETATM records are ignored
+    BOOST_REQUIRE_EQUAL( atoms.size(), 1 );
+    const brayns::Spheres& spheres = atoms.begin()->second.getSpheres();
+    BOOST_REQUIRE_EQUAL( spheres.size(), 2 );
+
+    // Positions are converted from angstroms, radii are the carbon radius
+    const brayns::Vector3f first( 0.18935f, 0.34195f, 0.25617f );
+    const brayns::Vector3f second( -0.1f, 0.005f, 1.f );
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        BOOST_CHECK_CLOSE( spheres[0].center[axis], first[axis], 1e-4f );
+        BOOST_CHECK_CLOSE( spheres[1].center[axis], second[axis], 1e-4f );
+    }
+    BOOST_CHECK_EQUAL( spheres[0].radius, spheres[1].radius );
+    BOOST_CHECK_CLOSE( spheres[0].radius, 0.0001f * 67.f *
+                       geometryParameters.getRadiusMultiplier(), 1e-4f );
+
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        BOOST_CHECK_CLOSE( bounds.getMin()[axis],
+                           std::min( first[axis], second[axis] ), 1e-4f );
+        BOOST_CHECK_CLOSE( bounds.getMax()[axis],
+                           std::max( first[axis], second[axis] ), 1e-4f );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( parse_test_data )
+{
+    brayns::GeometryParameters geometryParameters;
+    brayns::ProteinLoader loader( geometryParameters );
+    brayns::PrimitivesMap atoms;
+    brayns::Boxf bounds;
+    BOOST_REQUIRE( loader.importPDBFile( BRAYNS_TESTDATA + std::string( "1bna.pdb" ),
+                                         0, NB_MATERIALS, atoms, bounds ));
+    BOOST_CHECK_EQUAL( countSpheres( atoms ), 486 );
+    BOOST_CHECK( !bounds.isEmpty( ));
+}
+
+BOOST_AUTO_TEST_CASE( instance_pdb_file )
+{
+    const std::string filename = BRAYNS_TESTDATA + std::string( "1bna.pdb" );
+
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+    scene.setMaterials( brayns::MT_DEFAULT, NB_MATERIALS );
+
+    brayns::ProteinLoader loader( parametersManager.getGeometryParameters( ));
+    brayns::PrimitivesMap atoms;
+    brayns::Boxf bounds;
+    BOOST_REQUIRE( loader.importPDBFile( filename, 0, NB_MATERIALS, atoms, bounds ));
+
+    // Every instance is the parsed protein, moved to its position
+    const brayns::Vector3f positions[] = { brayns::Vector3f( 0.f, 0.f, 0.f ),
+                                           brayns::Vector3f( 10.f, -5.f, 2.f ) };
+    for( const auto& position: positions )
+        BOOST_REQUIRE( loader.importPDBFile( filename, position, 0, scene ));
+
+    BOOST_CHECK_EQUAL( countSpheres( scene.getPrimitives( )), 2 * countSpheres( atoms ));
+    for( const auto& material: atoms )
+    {
+        const brayns::Spheres& protein = material.second.getSpheres();
+        const brayns::Spheres& instances =
+            scene.getPrimitives()[material.first].getSpheres();
+        BOOST_REQUIRE_EQUAL( instances.size(), 2 * protein.size( ));
+        for( size_t i = 0; i < protein.size(); ++i )
+        {
+            const brayns::Sphere& second = instances[protein.size() + i];
+            BOOST_CHECK_EQUAL( instances[i].center, protein[i].center );
+            for( size_t axis = 0; axis < 3; ++axis )
+                BOOST_CHECK_CLOSE( second.center[axis],
+                                   protein[i].center[axis] + positions[1][axis], 1e-3f );
+            BOOST_CHECK_EQUAL( second.radius, protein[i].radius );
+        }
+    }
+
+    const brayns::Boxf& sceneBounds = scene.getWorldBounds();
+    for( size_t axis = 0; axis < 3; ++axis )
+    {
+        const float offset = positions[1][axis];
+        BOOST_CHECK_CLOSE( sceneBounds.getMin()[axis],
+                           bounds.getMin()[axis] + std::min( offset, 0.f ), 1e-3f );
+        BOOST_CHECK_CLOSE( sceneBounds.getMax()[axis],
+                           bounds.getMax()[axis] + std::max( offset, 0.f ), 1e-3f );
+    }
+}
@@ -0,0 +1,183 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#define BOOST_TEST_MODULE scene
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+/** Primitives are identified by their value */
+brayns::floats getValues( const brayns::Spheres& spheres )
+{
+    brayns::floats values;
+    for( const brayns::Sphere& sphere: spheres )
+        values.push_back( sphere.value );
+    return values;
+}
+
+brayns::floats getValues( const brayns::Cones& cones )
+{
+    brayns::floats values;
+    for( const brayns::Cone& cone: cones )
+        values.push_back( cone.value );
+    return values;
+}
+
+brayns::PrimitivesGroup createGroup( const size_t morphologyIndex,
+                                     const size_t material,
+                                     const size_t firstSphere,
+                                     const size_t nbSpheres,
+                                     const size_t firstCone,
+                                     const size_t nbCones )
+{
+    brayns::PrimitivesGroup group = brayns::PrimitivesGroup();
+    group.morphologyIndex = morphologyIndex;
+    group.material = material;
+    group.firstSphere = firstSphere;
+    group.nbSpheres = nbSpheres;
+    group.firstCone = firstCone;
+    group.nbCones = nbCones;
+    return group;
+}
+}
+
+BOOST_AUTO_TEST_CASE( reassign_materials )
+{
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+
+    // Material 1: sphere 0 belongs to no group, spheres 1 and 2 to the first
+    // morphology, sphere 3 to no group and sphere 4 to the second morphology.
+    // Material 2: sphere 5 belongs to the third morphology, sphere 6 to no group
+    brayns::Primitives& first = scene.getPrimitives()[1];
+    brayns::Primitives& second = scene.getPrimitives()[2];
+    for( size_t i = 0; i < 5; ++i )
+        first.addSphere( brayns::Vector3f( i, 0.f, 0.f ), 1.f, 0.f, i );
+    for( size_t i = 5; i < 7; ++i )
+        second.addSphere( brayns::Vector3f( i, 0.f, 0.f ), 1.f, 0.f, i );
+    first.addCone( brayns::Vector3f(), brayns::Vector3f(), 1.f, 1.f, 0.f, 10.f );
+    second.addCone( brayns::Vector3f(), brayns::Vector3f(), 1.f, 1.f, 0.f, 11.f );
+
+    brayns::PrimitivesGroups& groups = scene.getPrimitivesGroups();
+    groups.push_back( createGroup( 0, 1, 1, 2, 0, 1 ));
+    groups.push_back( createGroup( 1, 1, 4, 1, 1, 0 ));
+    groups.push_back( createGroup( 2, 2, 0, 1, 0, 1 ));
+
+    // The first and third morphologies swap their materials
+    const size_t materials[] = { 2, 1, 1 };
+    scene.reassignMaterials( [&materials]( const brayns::PrimitivesGroup& group )
+        { return materials[group.morphologyIndex]; } );
+
+    // Primitives of no group stay in their material, primitives of groups are
+    // appended to their new material
+    const brayns::floats expectedFirst = { 0.f, 3.f, 4.f, 5.f };
+    const brayns::floats expectedSecond = { 1.f, 2.f, 6.f };
+    const brayns::floats firstValues = getValues( scene.getPrimitives()[1].getSpheres( ));
+    const brayns::floats secondValues = getValues( scene.getPrimitives()[2].getSpheres( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( firstValues.begin(), firstValues.end(),
+                                   expectedFirst.begin(), expectedFirst.end( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( secondValues.begin(), secondValues.end(),
+                                   expectedSecond.begin(), expectedSecond.end( ));
+
+    // Groups cover their primitives in their new material
+    BOOST_CHECK_EQUAL( groups[0].material, 2 );
+    BOOST_CHECK_EQUAL( groups[0].firstSphere, 0 );
+    BOOST_CHECK_EQUAL( groups[0].nbSpheres, 2 );
+    BOOST_CHECK_EQUAL( groups[1].material, 1 );
+    BOOST_CHECK_EQUAL( groups[1].firstSphere, 2 );
+    BOOST_CHECK_EQUAL( groups[1].nbSpheres, 1 );
+    BOOST_CHECK_EQUAL( groups[2].material, 1 );
+    BOOST_CHECK_EQUAL( groups[2].firstSphere, 3 );
+    BOOST_CHECK_EQUAL( groups[2].nbSpheres, 1 );
+
+    // Cones follow their groups the same way
+    const brayns::Cones& firstCones = scene.getPrimitives()[1].getCones();
+    const brayns::Cones& secondCones = scene.getPrimitives()[2].getCones();
+    BOOST_REQUIRE_EQUAL( firstCones.size(), 1 );
+    BOOST_REQUIRE_EQUAL( secondCones.size(), 1 );
+    BOOST_CHECK_EQUAL( firstCones[0].value, 11.f );
+    BOOST_CHECK_EQUAL( secondCones[0].value, 10.f );
+    BOOST_CHECK_EQUAL( groups[0].firstCone, 0 );
+    BOOST_CHECK_EQUAL( groups[2].firstCone, 0 );
+
+    // Reassigning the same materials again keeps every primitive in place
+    scene.reassignMaterials( [&materials]( const brayns::PrimitivesGroup& group )
+        { return materials[group.morphologyIndex]; } );
+    const brayns::floats sameFirst = getValues( scene.getPrimitives()[1].getSpheres( ));
+    const brayns::floats sameSecond = getValues( scene.getPrimitives()[2].getSpheres( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( sameFirst.begin(), sameFirst.end(),
+                                   expectedFirst.begin(), expectedFirst.end( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( sameSecond.begin(), sameSecond.end(),
+                                   expectedSecond.begin(), expectedSecond.end( ));
+    BOOST_CHECK_EQUAL( groups[0].firstSphere, 0 );
+    BOOST_CHECK_EQUAL( groups[1].firstSphere, 2 );
+    BOOST_CHECK_EQUAL( groups[2].firstSphere, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( reassign_materials_of_sorted_groups )
+{
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+
+    // Arrays are sorted independently: the first morphology comes before the
+    // second one in the spheres, and after it in the cones. The third
+    // morphology has no primitives, and offsets that are out of the arrays
+    brayns::Primitives& primitives = scene.getPrimitives()[1];
+    for( size_t i = 0; i < 5; ++i )
+        primitives.addSphere( brayns::Vector3f( i, 0.f, 0.f ), 1.f, 0.f, i );
+    for( size_t i = 10; i < 14; ++i )
+        primitives.addCone( brayns::Vector3f(), brayns::Vector3f(), 1.f, 1.f, 0.f, i );
+
+    brayns::PrimitivesGroups& groups = scene.getPrimitivesGroups();
+    groups.push_back( createGroup( 0, 1, 1, 2, 2, 2 ));
+    groups.push_back( createGroup( 1, 1, 3, 2, 0, 2 ));
+    groups.push_back( createGroup( 2, 1, 100, 0, 100, 0 ));
+
+    const size_t materials[] = { 2, 1, 2 };
+    scene.reassignMaterials( [&materials]( const brayns::PrimitivesGroup& group )
+        { return materials[group.morphologyIndex]; } );
+
+    const brayns::floats expectedFirstSpheres = { 0.f, 3.f, 4.f };
+    const brayns::floats expectedSecondSpheres = { 1.f, 2.f };
+    const brayns::floats expectedFirstCones = { 10.f, 11.f };
+    const brayns::floats expectedSecondCones = { 12.f, 13.f };
+    const brayns::floats firstSpheres = getValues( scene.getPrimitives()[1].getSpheres( ));
+    const brayns::floats secondSpheres = getValues( scene.getPrimitives()[2].getSpheres( ));
+    const brayns::floats firstCones = getValues( scene.getPrimitives()[1].getCones( ));
+    const brayns::floats secondCones = getValues( scene.getPrimitives()[2].getCones( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( firstSpheres.begin(), firstSpheres.end(),
+        expectedFirstSpheres.begin(), expectedFirstSpheres.end( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( secondSpheres.begin(), secondSpheres.end(),
+        expectedSecondSpheres.begin(), expectedSecondSpheres.end( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( firstCones.begin(), firstCones.end(),
+        expectedFirstCones.begin(), expectedFirstCones.end( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( secondCones.begin(), secondCones.end(),
+        expectedSecondCones.begin(), expectedSecondCones.end( ));
+
+    BOOST_CHECK_EQUAL( groups[0].material, 2 );
+    BOOST_CHECK_EQUAL( groups[0].firstSphere, 0 );
+    BOOST_CHECK_EQUAL( groups[0].firstCone, 0 );
+    BOOST_CHECK_EQUAL( groups[1].material, 1 );
+    BOOST_CHECK_EQUAL( groups[1].firstSphere, 1 );
+    BOOST_CHECK_EQUAL( groups[1].firstCone, 0 );
+    BOOST_CHECK_EQUAL( groups[2].material, 2 );
+}
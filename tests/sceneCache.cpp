@@ -0,0 +1,170 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <brayns/Brayns.h>
+
+#include <brayns/common/engine/Engine.h>
+#include <brayns/common/material/Material.h>
+#include <brayns/common/renderer/FrameBuffer.h>
+#include <brayns/common/scene/Scene.h>
+#include <plugins/engines/ospray/OSPRaySceneCache.h>
+#include <tests/paths.h>
+
+#define BOOST_TEST_MODULE sceneCache
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+/** Everything the scene loaded from a cache file can be compared on */
+struct SceneState
+{
+    brayns::Boxf bounds;
+    std::vector< brayns::Vector3f > colors;
+    std::vector< uint8_t > image;
+};
+
+SceneState getState( brayns::Brayns& brayns )
+{
+    SceneState state;
+    brayns::Scene& scene = brayns.getEngine().getScene();
+    state.bounds = scene.getWorldBounds();
+    for( brayns::MaterialPtr material: scene.getMaterials( ))
+        state.colors.push_back( material->getColor( ));
+
+    brayns::FrameBuffer& fb = brayns.getEngine().getFrameBuffer();
+    const brayns::Vector2i size( 80, 60 );
+    fb.setAccumulation( false );
+    fb.resize( size );
+    fb.clear();
+    brayns.render();
+    fb.map();
+    state.image.resize( size.x() * size.y() * fb.getColorDepth( ));
+    memcpy( state.image.data(), fb.getColorBuffer(), state.image.size( ));
+    fb.unmap();
+    return state;
+}
+
+/** Saves the PDB test file to a cache file, then loads the scene from it */
+void checkRoundTrip( const bool compress )
+{
+    auto& testSuite = boost::unit_test::framework::master_test_suite();
+    const char* app = testSuite.argv[0];
+    const std::string pdbFile( BRAYNS_TESTDATA + std::string( "1bna.pdb" ));
+    const brayns::TemporaryFile cacheFile;
+    const std::string cacheFilename = cacheFile.string();
+
+    SceneState saved;
+    {
+        const char* argv[] = { app, "--pdb-file", pdbFile.c_str(),
+                               "--save-cache-file", cacheFilename.c_str(),
+                               "--compress-cache-file", compress ? "true" : "false" };
+        brayns::Brayns brayns( sizeof( argv ) / sizeof( argv[0] ), argv );
+        saved = getState( brayns );
+    }
+    BOOST_REQUIRE( boost::filesystem::exists( cacheFilename ));
+
+    const char* argv[] = { app, "--load-cache-file", cacheFilename.c_str(),
+                           "--verify-cache-file", "true" };
+    brayns::Brayns brayns( sizeof( argv ) / sizeof( argv[0] ), argv );
+    const SceneState loaded = getState( brayns );
+
+    BOOST_CHECK_EQUAL( loaded.bounds.getMin(), saved.bounds.getMin( ));
+    BOOST_CHECK_EQUAL( loaded.bounds.getMax(), saved.bounds.getMax( ));
+    BOOST_CHECK_EQUAL_COLLECTIONS( loaded.colors.begin(), loaded.colors.end(),
+                                   saved.colors.begin(), saved.colors.end( ));
+    BOOST_CHECK( loaded.image == saved.image );
+}
+}
+
+BOOST_AUTO_TEST_CASE( compute_checksum )
+{
+    // Standard CRC32 check value
+    const char data[] = "123456789";
+    BOOST_CHECK_EQUAL( brayns::computeCacheChecksum( data, 9 ), 0xCBF43926 );
+    BOOST_CHECK_EQUAL( brayns::computeCacheChecksum( data, 0 ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( split_chunks_in_blocks )
+{
+    const uint64_t blockSize = brayns::CACHE_BLOCK_SIZE;
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockCount( 0 ), 0 );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockCount( 1 ), 1 );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockCount( blockSize ), 1 );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockCount( blockSize + 1 ), 2 );
+
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockSize( 1, 0 ), 1 );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockSize( blockSize, 0 ), blockSize );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockSize( blockSize + 1, 0 ), blockSize );
+    BOOST_CHECK_EQUAL( brayns::getCacheBlockSize( blockSize + 1, 1 ), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( compress_blocks )
+{
+    // Compressed blocks decompress to their original bytes. Without codec, or
+    // when compression does not help, blocks are stored as they are
+    std::vector< char > repeated( 100000 );
+    for( size_t i = 0; i < repeated.size(); ++i )
+        repeated[i] = char( i % 16 );
+    std::vector< char > compressed;
+    const brayns::CacheCompression compression = brayns::compressCacheBlock(
+        { repeated.data(), repeated.size() }, compressed );
+    if( compression == brayns::CC_LZ4 )
+    {
+        BOOST_CHECK_LT( compressed.size(), repeated.size( ));
+        brayns::CacheBlock block = brayns::CacheBlock();
+        block.storedSize = compressed.size();
+        block.compression = compression;
+        block.checksum = brayns::computeCacheChecksum( compressed.data(),
+                                                       compressed.size( ));
+        std::vector< char > decompressed( repeated.size( ));
+        BOOST_REQUIRE( brayns::decompressCacheBlock( block, compressed.data(),
+            decompressed.data(), decompressed.size( )));
+        BOOST_CHECK( decompressed == repeated );
+    }
+    else
+    {
+        BOOST_CHECK_EQUAL( compression, brayns::CC_NONE );
+        BOOST_CHECK( compressed.empty( ));
+    }
+
+    std::mt19937 generator( 42 );
+    std::vector< char > random( 100000 );
+    for( char& value: random )
+        value = char( generator( ));
+    const brayns::GeometryBuffer randomBuffer = { random.data(), random.size() };
+    BOOST_CHECK_EQUAL( brayns::compressCacheBlock( randomBuffer, compressed ),
+                       brayns::CC_NONE );
+    BOOST_CHECK( compressed.empty( ));
+}
+
+BOOST_AUTO_TEST_CASE( save_and_load_cache_file )
+{
+    checkRoundTrip( false );
+}
+
+BOOST_AUTO_TEST_CASE( save_and_load_compressed_cache_file )
+{
+    checkRoundTrip( true );
+}
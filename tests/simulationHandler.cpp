@@ -0,0 +1,264 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <brayns/common/simulation/CircuitSimulationHandler.h>
+#include <brayns/common/simulation/SpikeSimulationHandler.h>
+#include <brayns/parameters/GeometryParameters.h>
+
+#define BOOST_TEST_MODULE simulationHandler
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+namespace
+{
+const size_t HISTOGRAM_SIZE = 4;
+
+/** Geometry parameters reading frames from the memory mapped cache file */
+void parseParameters( brayns::GeometryParameters& parameters,
+                      const std::string& encoding )
+{
+    const std::string histogramSize = std::to_string( HISTOGRAM_SIZE );
+    const char* argv[] = { "simulationHandler",
+                           "--simulation-cache-encoding", encoding.c_str(),
+                           "--simulation-prefetch-frames", "0",
+                           "--simulation-histogram-size", histogramSize.c_str() };
+    BOOST_REQUIRE( parameters.parse( sizeof( argv ) / sizeof( argv[0] ), argv ));
+}
+
+void writeCacheFile( const std::string& filename,
+                     const brayns::GeometryParameters& parameters,
+                     const std::vector< brayns::floats >& frames )
+{
+    brayns::CircuitSimulationHandler handler( parameters );
+    handler.setNbFrames( frames.size( ));
+    handler.setFrameSize( frames[0].size( ));
+
+    std::ofstream file( filename, std::ios::out | std::ios::binary );
+    handler.writeHeader( file );
+    for( const auto& frame: frames )
+        handler.writeFrame( file, frame );
+    handler.writeIndex( file );
+}
+
+const float* getFrame( brayns::AbstractSimulationHandler& handler,
+                       const float timestamp )
+{
+    handler.setTimestamp( timestamp );
+    const float* values = static_cast< const float* >( handler.getFrameData( ));
+    BOOST_REQUIRE( values );
+    return values;
+}
+}
+
+BOOST_AUTO_TEST_CASE( read_float32_frames )
+{
+    const std::vector< brayns::floats > frames =
+        { { 0.1f, -2.f, 3.5f }, { 1e10f, -1e-10f, 0.f } };
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float32" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, frames );
+
+    brayns::CircuitSimulationHandler handler( parameters );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( filename.string( )));
+    BOOST_CHECK_EQUAL( handler.getNbFrames(), frames.size( ));
+    BOOST_CHECK_EQUAL( handler.getFrameSize(), frames[0].size( ));
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        const float* values = getFrame( handler, i );
+        BOOST_CHECK_EQUAL_COLLECTIONS( values, values + frames[i].size(),
+                                       frames[i].begin(), frames[i].end( ));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( quantize_float16_frames )
+{
+    // Halves of integers below 2048 are exact, other values keep 11 significant bits
+    const std::vector< brayns::floats > frames =
+        { { 0.f, -0.5f, 499.5f, -1024.f }, { 0.1f, -65504.f, 3.14159f, 1e-3f }};
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float16" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, frames );
+
+    brayns::CircuitSimulationHandler handler( parameters );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( filename.string( )));
+    BOOST_CHECK_EQUAL( handler.getNbFrames(), frames.size( ));
+
+    const float* values = getFrame( handler, 0 );
+    BOOST_CHECK_EQUAL_COLLECTIONS( values, values + frames[0].size(),
+                                   frames[0].begin(), frames[0].end( ));
+    values = getFrame( handler, 1 );
+    for( size_t i = 0; i < frames[1].size(); ++i )
+        BOOST_CHECK_CLOSE_FRACTION( values[i], frames[1][i], 1.f / 2048.f );
+}
+
+BOOST_AUTO_TEST_CASE( quantize_uint8_frames )
+{
+    // Values span 256 steps between the minimum and the maximum of every frame
+    brayns::floats first( 256 );
+    brayns::floats second( 256 );
+    for( size_t i = 0; i < first.size(); ++i )
+    {
+        first[i] = -10.f + 0.5f * i;
+        second[i] = 100.f - 3.f * (( i * 7 ) % 256 );
+    }
+    const std::vector< brayns::floats > frames = { first, second };
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "uint8" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, frames );
+
+    brayns::CircuitSimulationHandler handler( parameters );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( filename.string( )));
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        const float* values = getFrame( handler, i );
+        for( size_t j = 0; j < frames[i].size(); ++j )
+            BOOST_CHECK_SMALL( values[j] - frames[i][j], 1e-3f );
+    }
+
+    // Frames that are not a multiple of the steps are rounded to the closest one.
+    // Attaching another file replaces the previous one
+    const brayns::floats values = { 0.f, 0.31f, 1.f };
+    const brayns::TemporaryFile roundedFilename;
+    writeCacheFile( roundedFilename.string(), parameters, { values } );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( roundedFilename.string( )));
+    const float* decoded = getFrame( handler, 0 );
+    BOOST_CHECK_EQUAL( decoded[0], 0.f );
+    BOOST_CHECK_SMALL( decoded[1] - 0.31f, 0.5f / 255.f );
+    BOOST_CHECK_SMALL( decoded[2] - 1.f, 1e-6f );
+}
+
+BOOST_AUTO_TEST_CASE( reject_truncated_cache_file )
+{
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float16" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, { { 1.f, 2.f } } );
+
+    // The header announces a frame index that is not in the file
+    boost::filesystem::resize_file( filename.string(),
+                                    sizeof( brayns::SimulationCacheHeader ) + 8 );
+
+    brayns::CircuitSimulationHandler handler( parameters );
+    BOOST_CHECK( !handler.attachSimulationToCacheFile( filename.string( )));
+    BOOST_CHECK_EQUAL( handler.getNbFrames(), 0 );
+    BOOST_CHECK( !handler.getFrameData( ));
+}
+
+BOOST_AUTO_TEST_CASE( merge_histograms )
+{
+    // Large enough for the values to be counted by several threads
+    const size_t frameSize = 100000;
+    brayns::floats first( frameSize );
+    brayns::floats second( frameSize );
+    for( size_t i = 0; i < frameSize; ++i )
+    {
+        first[i] = i;
+        second[i] = 2.f * i;
+    }
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float32" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, { first, second } );
+
+    brayns::CircuitSimulationHandler handler( parameters );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( filename.string( )));
+
+    // Bins are a quarter of the range wide, the maximum value falls in the last one
+    handler.setTimestamp( 0.f );
+    const brayns::Histogram& histogram = handler.getHistogram();
+    const brayns::uint64_ts expected = { 25000, 25000, 25000, 25000 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( histogram.values.begin(), histogram.values.end(),
+                                   expected.begin(), expected.end( ));
+    BOOST_CHECK_EQUAL( histogram.range, brayns::Vector2f( 0.f, frameSize - 1 ));
+
+    // Histograms of frames are kept
+    handler.setTimestamp( 1.f );
+    BOOST_CHECK_EQUAL( handler.getHistogram().range,
+                       brayns::Vector2f( 0.f, 2.f * ( frameSize - 1 )));
+    handler.setTimestamp( 0.f );
+    BOOST_CHECK_EQUAL( &handler.getHistogram(), &histogram );
+
+    // Histograms of blended frames have their own range
+    handler.setTimestamp( 0.5f );
+    const brayns::Histogram& blended = handler.getHistogram();
+    BOOST_CHECK_EQUAL( blended.range, brayns::Vector2f( 0.f, 1.5f * ( frameSize - 1 )));
+    BOOST_CHECK_EQUAL_COLLECTIONS( blended.values.begin(), blended.values.end(),
+                                   expected.begin(), expected.end( ));
+}
+
+BOOST_AUTO_TEST_CASE( queue_live_spikes )
+{
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float32" );
+    brayns::SpikeSimulationHandler handler( parameters );
+    handler.setLive( 3 );
+
+    // Only the last spike of every cell is queued until the frame is built, and
+    // spikes of unknown cells are ignored
+    for( size_t i = 0; i < 1000; ++i )
+        handler.addSpikes( float( i ), { 0, 2, 5 } );
+    handler.addSpikes( 10.f, { 1 } );
+    BOOST_CHECK( !handler.isReady( ));
+    const float* values = getFrame( handler, 0 );
+    BOOST_CHECK( handler.isReady( ));
+    const brayns::floats expected = { 999.f, 10.f, 999.f };
+    BOOST_CHECK_EQUAL_COLLECTIONS( values, values + expected.size(),
+                                   expected.begin(), expected.end( ));
+
+    // Cells keep their last spike time until they spike again
+    handler.addSpikes( 1000.f, { 1 } );
+    values = getFrame( handler, 0 );
+    const brayns::floats updated = { 999.f, 1000.f, 999.f };
+    BOOST_CHECK_EQUAL_COLLECTIONS( values, values + updated.size(),
+                                   updated.begin(), updated.end( ));
+}
+
+BOOST_AUTO_TEST_CASE( read_dense_spike_frames )
+{
+    // More frames than cells, the last frames are beyond the frame size
+    const std::vector< brayns::floats > frames =
+        { { 0.f, 1.f }, { 2.f, 3.f }, { 4.f, 5.f }, { 6.f, 7.f }, { 8.f, 9.f } };
+    brayns::GeometryParameters parameters;
+    parseParameters( parameters, "float32" );
+
+    const brayns::TemporaryFile filename;
+    writeCacheFile( filename.string(), parameters, frames );
+
+    brayns::SpikeSimulationHandler handler( parameters );
+    BOOST_REQUIRE( handler.attachSimulationToCacheFile( filename.string( )));
+    BOOST_CHECK_EQUAL( handler.getNbFrames(), frames.size( ));
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        const float* values = getFrame( handler, i );
+        BOOST_CHECK_EQUAL_COLLECTIONS( values, values + frames[i].size(),
+                                       frames[i].begin(), frames[i].end( ));
+    }
+}
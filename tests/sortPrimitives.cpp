@@ -0,0 +1,111 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <brayns/Brayns.h>
+
+#include <brayns/common/engine/Engine.h>
+#include <brayns/common/scene/Scene.h>
+
+#define BOOST_TEST_MODULE sortPrimitives
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+const size_t MATERIAL = 1;
+
+/** Empty scene with default materials, primitives are sorted when built */
+brayns::Scene& createScene( brayns::Brayns& brayns )
+{
+    brayns::Scene& scene = brayns.getEngine().getScene();
+    scene.reset();
+    brayns.getEngine().initializeMaterials();
+    return scene;
+}
+}
+
+BOOST_AUTO_TEST_CASE( sort_primitives_and_groups )
+{
+    auto& testSuite = boost::unit_test::framework::master_test_suite();
+    const char* argv[] = { testSuite.argv[0], "--sort-primitives", "true" };
+    brayns::Brayns brayns( sizeof( argv ) / sizeof( argv[0] ), argv );
+    brayns::Scene& scene = createScene( brayns );
+
+    // Spheres are identified by their value. Spheres 4 to 6 belong to a group
+    // whose centroid is between the others
+    const float positions[] = { 3.f, 0.f, 3.f, 0.f, 1.f, 2.f, 1.f };
+    brayns::Primitives& primitives = scene.getPrimitives()[MATERIAL];
+    for( size_t i = 0; i < sizeof( positions ) / sizeof( positions[0] ); ++i )
+        primitives.addSphere( brayns::Vector3f( positions[i], 0.f, 0.f ), 0.1f, 0.f, i );
+
+    brayns::PrimitivesGroup group = brayns::PrimitivesGroup();
+    group.material = MATERIAL;
+    group.firstSphere = 4;
+    group.nbSpheres = 3;
+    scene.getPrimitivesGroups().push_back( group );
+
+    scene.buildGeometry();
+
+    // Spheres sharing a position keep their order, and so do the spheres of
+    // the group, that stay together
+    const brayns::Spheres& spheres = scene.getPrimitives()[MATERIAL].getSpheres();
+    const float expected[] = { 1.f, 3.f, 4.f, 6.f, 5.f, 0.f, 2.f };
+    BOOST_REQUIRE_EQUAL( spheres.size(), sizeof( expected ) / sizeof( expected[0] ));
+    for( size_t i = 0; i < spheres.size(); ++i )
+        BOOST_CHECK_EQUAL( spheres[i].value, expected[i] );
+
+    const brayns::PrimitivesGroup& sortedGroup = scene.getPrimitivesGroups()[0];
+    BOOST_CHECK_EQUAL( sortedGroup.firstSphere, 2 );
+    BOOST_CHECK_EQUAL( sortedGroup.nbSpheres, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( sort_primitives_in_parallel )
+{
+    auto& testSuite = boost::unit_test::framework::master_test_suite();
+    const char* argv[] = { testSuite.argv[0], "--sort-primitives", "true" };
+    brayns::Brayns brayns( sizeof( argv ) / sizeof( argv[0] ), argv );
+    brayns::Scene& scene = createScene( brayns );
+
+    // Enough cylinders for the keys to be sorted by several blocks
+    const size_t nbPositions = 4;
+    const size_t nbCylinders = 500000;
+    brayns::Primitives& primitives = scene.getPrimitives()[MATERIAL];
+    for( size_t i = 0; i < nbCylinders; ++i )
+    {
+        const brayns::Vector3f center( ( i * 3 ) % nbPositions, i % 2, 0.f );
+        primitives.addCylinder( center, center, 0.1f, 0.f, i );
+    }
+
+    scene.buildGeometry();
+
+    // Cylinders are sorted by position, and keep their order for a given position
+    const brayns::Cylinders& cylinders = scene.getPrimitives()[MATERIAL].getCylinders();
+    BOOST_REQUIRE_EQUAL( cylinders.size(), nbCylinders );
+    size_t nbOrdered = 0;
+    for( size_t i = 1; i < cylinders.size(); ++i )
+    {
+        const brayns::Cylinder& previous = cylinders[i - 1];
+        const brayns::Cylinder& current = cylinders[i];
+        if( previous.center == current.center )
+            nbOrdered += ( previous.value < current.value ) ? 1 : 0;
+        else
+            nbOrdered += ( i % ( nbCylinders / nbPositions ) == 0 ) ? 1 : 0;
+    }
+    BOOST_CHECK_EQUAL( nbOrdered, nbCylinders - 1 );
+}
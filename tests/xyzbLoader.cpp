@@ -0,0 +1,105 @@
+/* Copyright (c) 2015-2017, EPFL/Blue Brain Project
+ * All rights reserved. Do not distribute without permission.
+ * Responsible Author: Cyrille Favreau <cyrille.favreau@epfl.ch>
+ *
+ * This file is part of Brayns <https://github.com/BlueBrain/Brayns>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "TestScene.h"
+
+#include <brayns/io/XYZBLoader.h>
+
+#define BOOST_TEST_MODULE xyzbLoader
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+BOOST_AUTO_TEST_CASE( import_text_file )
+{
+    const brayns::TemporaryFile filename;
+    {
+        std::ofstream file( filename.string( ));
+        file << "1 2 3\n"
+             << "\n"
+             << "  -1.5\t0.25   1e2\r\n"
+             << "4.0 -5e-1 +6\n"
+             << "7 8 9";
+    }
+
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+    brayns::XYZBLoader loader( parametersManager.getGeometryParameters( ));
+    BOOST_REQUIRE( loader.importFromFile( filename.string(), scene ));
+
+    const float radius =
+        parametersManager.getGeometryParameters().getRadiusMultiplier();
+    const brayns::Spheres& spheres = scene.getPrimitives()[0].getSpheres();
+    BOOST_REQUIRE_EQUAL( spheres.size(), 4 );
+    BOOST_CHECK_EQUAL( spheres[0].center, brayns::Vector3f( 1.f, 2.f, 3.f ));
+    BOOST_CHECK_EQUAL( spheres[1].center, brayns::Vector3f( -1.5f, 0.25f, 100.f ));
+    BOOST_CHECK_EQUAL( spheres[2].center, brayns::Vector3f( 4.f, -0.5f, 6.f ));
+    BOOST_CHECK_EQUAL( spheres[3].center, brayns::Vector3f( 7.f, 8.f, 9.f ));
+    for( const brayns::Sphere& sphere: spheres )
+        BOOST_CHECK_EQUAL( sphere.radius, radius );
+
+    const brayns::Boxf& bounds = scene.getWorldBounds();
+    BOOST_CHECK_EQUAL( bounds.getMin(), brayns::Vector3f( -1.5f, -0.5f, 3.f ));
+    BOOST_CHECK_EQUAL( bounds.getMax(), brayns::Vector3f( 7.f, 8.f, 100.f ));
+}
+
+BOOST_AUTO_TEST_CASE( import_invalid_text_file )
+{
+    const brayns::TemporaryFile filename;
+    {
+        std::ofstream file( filename.string( ));
+        file << "1 2 3\n"
+             << "4 5\n";
+    }
+
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+    brayns::XYZBLoader loader( parametersManager.getGeometryParameters( ));
+    BOOST_CHECK( !loader.importFromFile( filename.string(), scene ));
+    BOOST_CHECK( scene.getPrimitives()[0].getSpheres().empty( ));
+}
+
+BOOST_AUTO_TEST_CASE( import_binary_file )
+{
+    const double records[] = { 1.0, 2.0, 3.0,
+                               -4.0, 0.5, 6.0 };
+    const brayns::TemporaryFile filename;
+    {
+        std::ofstream file( filename.string(), std::ios::out | std::ios::binary );
+        file.write( reinterpret_cast< const char* >( records ), sizeof( records ));
+
+        // Trailing bytes that do not make a whole record are ignored
+        file.write( reinterpret_cast< const char* >( records ), sizeof( double ));
+    }
+
+    brayns::ParametersManager parametersManager;
+    brayns::TestScene scene( parametersManager );
+    brayns::XYZBLoader loader( parametersManager.getGeometryParameters( ));
+    BOOST_REQUIRE( loader.importFromBinaryFile( filename.string(), scene ));
+
+    const brayns::Spheres& spheres = scene.getPrimitives()[0].getSpheres();
+    BOOST_REQUIRE_EQUAL( spheres.size(), 2 );
+    BOOST_CHECK_EQUAL( spheres[0].center, brayns::Vector3f( 1.f, 2.f, 3.f ));
+    BOOST_CHECK_EQUAL( spheres[1].center, brayns::Vector3f( -4.f, 0.5f, 6.f ));
+
+    const brayns::Boxf& bounds = scene.getWorldBounds();
+    BOOST_CHECK_EQUAL( bounds.getMin(), brayns::Vector3f( -4.f, 0.5f, 3.f ));
+    BOOST_CHECK_EQUAL( bounds.getMax(), brayns::Vector3f( 1.f, 2.f, 6.f ));
+}